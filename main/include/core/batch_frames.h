@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace Core
+{
+
+/// @brief Framed transfer of a batch of records larger than a single attribute value.
+///
+/// The Scanner serializes a batch and splits it into chunks; each GATT Read of 'Devices'
+/// returns the next chunk in a frame, wrapping around to the first one. The batch is kept
+/// until the Master acknowledges it, so chunks dropped by the Master are read again.
+///
+/// Frame (little endian) - batch id 1B, chunk index 1B, batch length 2B, chunk data.
+/// Every chunk except the last one has @ref Frames::ChunkSize bytes.
+namespace Frames
+{
+/// @brief Frame header size
+constexpr std::size_t HeaderSize = 4;
+
+/// @brief Maximum frame size (maximum attribute length)
+constexpr std::size_t MaxFrameSize = 512;
+
+/// @brief Data in a single chunk
+constexpr std::size_t ChunkSize = MaxFrameSize - HeaderSize;
+
+/// @brief Maximum chunks of a batch
+constexpr std::size_t MaxChunks = 32;
+
+/// @brief Maximum batch size
+constexpr std::size_t MaxBatchSize = MaxChunks * ChunkSize;
+}  // namespace Frames
+
+/// @brief Batch split into frames (Scanner side)
+class BatchFramer
+{
+public:
+	/// @brief Buffer for serializing a new batch; replaces the current one
+	/// @param size buffer size; at most @ref Frames::MaxBatchSize
+	/// @return buffer
+	std::span<std::uint8_t> Prepare(std::size_t size);
+
+	/// @brief Start sending a new batch prepared by @ref Prepare
+	/// @param size serialized bytes; 0 if there's nothing to send
+	void Commit(std::size_t size);
+
+	/// @brief Whether a batch is waiting for an acknowledgement
+	bool Pending() const { return _pending; }
+
+	/// @brief Next frame of the pending batch; wraps around after the last one
+	/// @param[out] out frame; empty if nothing is pending
+	void NextFrame(std::vector<std::uint8_t> & out);
+
+	/// @brief Acknowledge the pending batch
+	/// @param id batch id
+	/// @return false if it isn't the pending batch
+	bool Ack(std::uint8_t id);
+
+	/// @brief Drop the pending batch
+	void Clear();
+
+private:
+	/// @brief Chunks of the pending batch
+	std::size_t _ChunkCount() const;
+
+	std::vector<std::uint8_t> _data;  ///< Serialized batch
+	std::uint8_t _id{0};              ///< Id of the pending batch
+	std::uint8_t _next{0};            ///< Next chunk to send
+	bool _pending{false};
+};
+
+/// @brief Reassembles batches from frames (Master side)
+class BatchAssembler
+{
+public:
+	/// @brief Result of a received frame
+	enum class Result
+	{
+		Incomplete,  ///< More chunks needed
+		Complete,    ///< Batch complete; acknowledge it
+		Duplicate,   ///< Already completed batch; acknowledge it again
+		Invalid      ///< Malformed frame; ignored
+	};
+
+	/// @brief Add a received frame
+	/// @param frame frame
+	/// @return result
+	Result Add(std::span<const std::uint8_t> frame);
+
+	/// @brief Id of the last received batch
+	std::uint8_t Id() const { return _id; }
+
+	/// @brief Completed batch; valid after @ref Result::Complete until the next frame
+	std::span<std::uint8_t> Data() { return _data; }
+
+private:
+	std::vector<std::uint8_t> _data;  ///< Batch being reassembled
+	std::uint32_t _received{0};       ///< Received chunks bitmask (@ref Frames::MaxChunks)
+	std::uint8_t _id{0};              ///< Id of the batch
+	bool _active{false};              ///< Whether a batch is being reassembled
+	bool _completed{false};           ///< Whether `_id` was completed
+};
+
+}  // namespace Core
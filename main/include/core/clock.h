@@ -21,4 +21,9 @@ std::int64_t DeltaMs(const TimePoint & before, const TimePoint & after = Clock::
 /// @return unix timestamp
 std::uint32_t ToUnix(const TimePoint & timepoint);
 
+/// @brief Cast unix timestamp (seconds) to timepoint
+/// @param timestamp unix timestamp
+/// @return timepoint
+TimePoint FromUnix(std::uint32_t timestamp);
+
 }  // namespace Core
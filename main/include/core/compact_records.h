@@ -0,0 +1,188 @@
+#pragma once
+
+#include "core/device_data.h"
+#include "core/rssi_stats.h"
+#include "core/utility/caps_allocator.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace Core
+{
+
+/// @brief Compact record format of the data sent from a Scanner to the Master.
+///
+/// Devices get a short id when they are first sent (a definition record with all
+/// the data); afterwards, only the id with the RSSI and the age is sent (an update record).
+/// Devices are defined again when anything but their RSSI/timestamp changes.
+/// The ids form a dictionary shared by both sides. The dictionary has an epoch, which changes
+/// whenever it's reset - the Master requests a reset (resync) whenever it can't decode
+/// a payload (a lost payload or an unknown id), the first payload of a new epoch
+/// acknowledges it.
+///
+/// Payload (little endian):
+/// - Header - version 1B, epoch 1B, sequence number 1B (incremented by one with every
+///   payload), base UNIX timestamp 4B
+/// - Update record - id 1B (highest bit cleared), RSSI 1B, age (seconds before the base
+///   timestamp) 1B
+/// - Definition record - id 1B (highest bit set), RSSI 1B, age 1B, flags 1B, event type 1B,
+///   advertising data size 1B, MAC 6B, sent advertising data length N 1B, advertising
+///   data N B (trailing zeros aren't sent)
+/// - @ref StatsVersion only - every record is followed by the @ref RssiStats of the device
+namespace Compact
+{
+/// @brief Record format versions
+/// @{
+constexpr std::uint8_t LegacyVersion = 0;  ///< Array of @ref DeviceDataView
+constexpr std::uint8_t Version = 1;        ///< Compact records
+constexpr std::uint8_t StatsVersion = 2;   ///< Compact records with RSSI statistics
+/// @}
+
+/// @brief Whether a version uses compact records
+constexpr bool IsCompact(std::uint8_t version)
+{
+	return version == Version || version == StatsVersion;
+}
+
+/// @brief Maximum amount of ids (devices in the dictionary)
+constexpr std::size_t MaxIds = 64;
+
+/// @brief Sizes; records of @ref StatsVersion are @ref RssiStats::Size longer
+/// @{
+constexpr std::size_t HeaderSize = 7;
+constexpr std::size_t UpdateSize = 3;
+constexpr std::size_t DefinitionHeaderSize = 13;
+constexpr std::size_t MaxRecordSize = DefinitionHeaderSize + 62 + RssiStats::Size;
+/// @}
+
+/// @brief Size of the RSSI statistics in the records of a version
+constexpr std::size_t StatsSize(std::uint8_t version)
+{
+	return version == StatsVersion ? RssiStats::Size : 0;
+}
+
+/// @brief Smallest payload, which always fits at least a single record of any version
+constexpr std::size_t MinPayloadSize = std::max(HeaderSize + MaxRecordSize, DeviceDataView::Size);
+
+/// @brief Definition record flag of the id byte
+constexpr std::uint8_t DefinitionBit = 0x80;
+}  // namespace Compact
+
+/// @brief Encodes device records into compact payloads (Scanner side)
+class CompactEncoder
+{
+public:
+	/// @brief Constructor
+	CompactEncoder();
+
+	/// @brief Forget all ids and start a new epoch; all devices will be defined again
+	void Reset();
+
+	/// @brief Set the payload version and start a new epoch
+	/// @param version @ref Compact::Version or @ref Compact::StatsVersion
+	void SetVersion(std::uint8_t version);
+
+	/// @brief Current dictionary epoch
+	std::uint8_t Epoch() const { return _epoch; }
+
+	/// @brief Start a new payload - write its header
+	/// @param[out] out destination; at least @ref Compact::HeaderSize
+	/// @param timestamp UNIX timestamp the record ages are relative to
+	/// @return written bytes
+	std::size_t Begin(std::span<std::uint8_t> out, std::uint32_t timestamp);
+
+	/// @brief Encode a record
+	/// @param record device record
+	/// @param stats RSSI statistics of the device; only sent by @ref Compact::StatsVersion
+	/// @param[out] out destination (the rest of the payload)
+	/// @return written bytes; 0 if it doesn't fit (nothing is changed then)
+	std::size_t Add(const DeviceDataView & record,
+	                const RssiStats & stats,
+	                std::span<std::uint8_t> out);
+
+private:
+	/// @brief Dictionary entry
+	struct Entry
+	{
+		std::array<std::uint8_t, DeviceDataView::Size> Record;  ///< Last defined record
+		std::uint32_t LastUse{0};                               ///< `_uses` of the last use
+		bool Used{false};                                       ///< Whether the id is used
+	};
+
+	/// @brief Find the id of a device
+	/// @param mac device address
+	/// @return id or nullopt
+	std::optional<std::uint8_t> _Find(std::span<const std::uint8_t, 6> mac) const;
+
+	/// @brief A free or the least recently used id
+	std::uint8_t _Replaceable() const;
+
+	/// @brief Write the RSSI statistics of a record
+	/// @param stats statistics
+	/// @param[out] out destination; empty if the version doesn't send them
+	static void _WriteStats(const RssiStats & stats, std::span<std::uint8_t> out);
+
+	std::array<Entry, Compact::MaxIds> _entries;
+	std::uint32_t _uses{0};       ///< Use counter for LRU replacement
+	std::uint32_t _timestamp{0};  ///< Base timestamp of the current payload
+	std::uint8_t _version{Compact::Version};
+	std::uint8_t _epoch{0};
+	std::uint8_t _seq{0};  ///< Sequence number of the next payload
+};
+
+/// @brief Decodes compact payloads back into device records (Master side)
+class CompactDecoder
+{
+public:
+	/// @brief Decoding result
+	enum class Result
+	{
+		Ok,         ///< Decoded
+		Duplicate,  ///< Already decoded payload; ignored
+		Invalid,    ///< Not a compact payload; ignored
+		Resync      ///< Dictionary out of sync; request a resync of `ResyncEpoch`
+	};
+
+	/// @brief Constructor
+	/// @param region where to allocate the dictionary
+	CompactDecoder(MemoryRegion region);
+
+	/// @brief Decode a payload
+	/// @param payload payload
+	/// @param[out] out decoded records (@ref DeviceDataView::Array); cleared first. May contain
+	/// records decoded before the dictionary got out of sync.
+	/// @param[out] stats RSSI statistics of the records; cleared first, empty unless
+	/// the payload is @ref Compact::StatsVersion
+	/// @return result
+	Result Decode(std::span<const std::uint8_t> payload,
+	              std::vector<std::uint8_t> & out,
+	              std::vector<RssiStats> & stats);
+
+	/// @brief Epoch, which should be reset by the Scanner (after @ref Result::Resync)
+	std::uint8_t ResyncEpoch() const { return _epoch; }
+
+private:
+	/// @brief Forget everything until the epoch changes
+	/// @param epoch epoch to be reset
+	/// @return @ref Result::Resync
+	Result _Desync(std::uint8_t epoch);
+
+	/// @brief Record of an id
+	std::span<std::uint8_t, DeviceDataView::Size> _Record(std::uint8_t id);
+
+	/// @brief Last records of all ids of the current epoch (@ref DeviceDataView::Array)
+	std::vector<std::uint8_t, CapsAllocator<std::uint8_t>> _records;
+	std::array<bool, Compact::MaxIds> _defined{};
+
+	std::uint8_t _epoch{0};
+	std::uint8_t _seq{0};        ///< Sequence number of the last payload
+	bool _synced{false};         ///< Whether the epoch and sequence number are valid
+	bool _resyncPending{false};  ///< Whether `_epoch` was requested to be reset
+};
+
+}  // namespace Core
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "core/wrapper/scan_result_view.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace Core
+{
+
+/// @brief Scan result filter of a Scanner - the value of the 'filter' characteristic.
+///
+/// A list of rules; a result is kept if any of them matches (or if there are none).
+/// Rule - kind 1B, data length N 1B, data N B:
+/// - @ref Kind::MacPrefix - 1-6B address prefix (most significant byte first)
+/// - @ref Kind::ServiceUuid - 2B, 4B or 16B UUID (little endian, as advertised); matches
+///   service UUID lists and service data
+/// - @ref Kind::ManufacturerId - 2B company id (little endian); matches manufacturer data
+/// - @ref Kind::ByteMask - AD type 1B, offset 1B, M value bytes, M mask bytes; matches
+///   a record of the type, whose data at the offset masked equals the value masked
+class FilterRules
+{
+public:
+	/// @brief Maximum serialized size
+	static constexpr std::size_t MaxSize = 128;
+
+	/// @brief Rule kinds
+	enum class Kind : std::uint8_t
+	{
+		MacPrefix = 1,
+		ServiceUuid = 2,
+		ManufacturerId = 3,
+		ByteMask = 4
+	};
+
+	/// @brief Validity check
+	/// @param data serialized rules
+	/// @return whether all the rules are valid and fit @ref MaxSize
+	static bool IsValid(std::span<const std::uint8_t> data);
+
+	/// @brief Replace the rules
+	/// @param data serialized rules
+	/// @return false if they're invalid (nothing is changed then)
+	bool Set(std::span<const std::uint8_t> data);
+
+	/// @brief Remove all rules; everything passes
+	void Clear() { _size = 0; }
+
+	/// @brief Whether there are no rules
+	bool Empty() const { return _size == 0; }
+
+	/// @brief Serialized rules
+	std::span<const std::uint8_t> Data() const { return std::span(_data).first(_size); }
+
+	/// @brief Rule count
+	std::size_t Count() const;
+
+	/// @brief Check a scan result; doesn't allocate
+	/// @param view scan result
+	/// @return whether it passes
+	bool Matches(const Bt::ScanResultView & view) const;
+
+private:
+	/// @brief Check a single rule
+	/// @param kind rule kind
+	/// @param rule rule data
+	/// @param view scan result
+	/// @param eir EIR data of the result
+	/// @return whether it matches
+	static bool _Matches(Kind kind,
+	                     std::span<const std::uint8_t> rule,
+	                     const Bt::ScanResultView & view,
+	                     const Bt::EirView & eir);
+
+	std::array<std::uint8_t, MaxSize> _data{};
+	std::size_t _size{0};
+};
+
+}  // namespace Core
@@ -1,10 +1,12 @@
 #pragma once
 
+#include "core/compact_records.h"
 #include "core/utility/uuid.h"
 
 #include <esp_gatt_defs.h>
 #include <esp_gatts_api.h>
 
+#include <cstddef>
 #include <string>
 
 namespace Gatt
@@ -15,8 +17,22 @@ static constexpr std::uint16_t PrimaryService = ESP_GATT_UUID_PRI_SERVICE;
 /// @brief Characteristic declaration UUID
 static constexpr std::uint16_t CharacteristicDeclaration = ESP_GATT_UUID_CHAR_DECLARE;
 
-/// @brief Scanner service characteristic count
+/// @brief Client characteristic configuration descriptor UUID
+static constexpr std::uint16_t ClientCharConfig = ESP_GATT_UUID_CHAR_CLIENT_CONFIG;
+
+/// @brief Client characteristic configuration descriptor bits
+enum ClientConfigBits : std::uint16_t
+{
+	Notify = 0x0001,
+	Indicate = 0x0002
+};
+
+/// @brief Scanner service characteristic count - required ones ('state', 'devices',
+/// 'timestamp'), and all of them with the optional ones older Scanners don't have
+/// @{
 constexpr std::uint16_t ScannerServiceCharCount = 3;
+constexpr std::uint16_t ScannerServiceMaxCharCount = 5;
+/// @}
 
 /// @brief UUID of the scanner service
 constexpr std::string_view ScannerService = "7e6bf038-0f00-47ab-a215-cf841f4289f0";
@@ -33,11 +49,42 @@ constexpr std::string_view DevicesCharacteristic = "7e6bf038-0f00-47ab-a215-cf84
 constexpr std::array DevicesCharacteristicArray = Util::UuidToArray(DevicesCharacteristic);
 constexpr esp_bt_uuid_t DevicesCharacteristicStruct = Util::UuidToStruct(DevicesCharacteristic);
 
+/// @brief Header of each 'devices' notification/indication: little endian sequence number
+/// (incremented by one with every sent payload), followed by the device records.
+constexpr std::size_t DevicesStreamHeaderSize = 2;
+
+/// @brief Smallest ATT MTU, whose notifications/indications fit the header and a record of any
+/// format (ATT_MTU - 3 of payload). Scanners don't stream with a smaller one.
+constexpr std::size_t DevicesStreamMinMtu =
+    3 + DevicesStreamHeaderSize + Core::Compact::MinPayloadSize;
+
+/// @brief Commands written by the Master to the 'devices' characteristic: the command byte,
+/// followed by its argument byte. Reads of a Scanner, which accepted `SetFormat`, return
+/// framed batches (`Core::Frames`).
+enum DevicesControl : std::uint8_t
+{
+	SetFormat = 1,  ///< Record format version (`Core::Compact`); starts a new epoch
+	Resync = 2,     ///< Reset the compact record dictionary of the given epoch
+	Ack = 3         ///< Read batch with the given id was received
+};
+
 /// @brief UUID of the 'timestamp' characteristic (scanner service)
 constexpr std::string_view TimestampCharacteristic = "7e6bf038-0f00-47ab-a215-cf841f4289f3";
 constexpr std::array TimestampCharacteristicArray = Util::UuidToArray(TimestampCharacteristic);
 constexpr esp_bt_uuid_t TimestampCharacteristicStruct = Util::UuidToStruct(TimestampCharacteristic);
 
+/// @brief UUID of the 'scan' characteristic (scanner service, optional). The value is
+/// a `Core::ScanSchedule`.
+constexpr std::string_view ScanCharacteristic = "7e6bf038-0f00-47ab-a215-cf841f4289f4";
+constexpr std::array ScanCharacteristicArray = Util::UuidToArray(ScanCharacteristic);
+constexpr esp_bt_uuid_t ScanCharacteristicStruct = Util::UuidToStruct(ScanCharacteristic);
+
+/// @brief UUID of the 'filter' characteristic (scanner service, optional). The value is
+/// a `Core::FilterRules`.
+constexpr std::string_view FilterCharacteristic = "7e6bf038-0f00-47ab-a215-cf841f4289f5";
+constexpr std::array FilterCharacteristicArray = Util::UuidToArray(FilterCharacteristic);
+constexpr esp_bt_uuid_t FilterCharacteristicStruct = Util::UuidToStruct(FilterCharacteristic);
+
 /// @brief State characteristic values
 enum StateChar : std::uint8_t
 {
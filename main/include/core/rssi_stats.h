@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace Core
+{
+
+/// @brief RSSI statistics of a device since it was last sent to the Master
+///
+/// Serialized (4B) - sample count 1B, sample variance 1B (1/4 dBm^2), minimum 1B, maximum 1B.
+/// Count and variance saturate.
+struct RssiStats
+{
+	/// @brief Serialized size
+	static constexpr std::size_t Size = 4;
+
+	std::uint8_t Count{0};     ///< Samples
+	std::uint8_t Variance{0};  ///< Sample variance [1/4 dBm^2]
+	std::int8_t Min{0};        ///< Minimum RSSI
+	std::int8_t Max{0};        ///< Maximum RSSI
+
+	/// @brief Sample variance [dBm^2]
+	float VarianceDbm() const { return Variance / 4.0f; }
+
+	/// @brief Serialize
+	/// @param[out] out destination
+	void Serialize(std::span<std::uint8_t, Size> out) const;
+
+	/// @brief Parse serialized statistics
+	/// @param data serialized statistics
+	/// @return statistics
+	static RssiStats Parse(std::span<const std::uint8_t, Size> data);
+};
+
+/// @brief Streaming RSSI mean and variance (Welford's algorithm in fixed point)
+class RssiAccumulator
+{
+public:
+	/// @brief Constructor
+	/// @param rssi first sample
+	RssiAccumulator(std::int8_t rssi);
+
+	/// @brief Add a sample
+	/// @param rssi RSSI
+	void Add(std::int8_t rssi);
+
+	/// @brief Rounded mean
+	std::int8_t Mean() const;
+
+	/// @brief Statistics of all samples
+	RssiStats Stats() const;
+
+private:
+	std::uint64_t _m2{0};    ///< Sum of squared differences from the mean (Q8)
+	std::int32_t _mean{0};   ///< Mean (Q8)
+	std::uint16_t _count{0};
+	std::int8_t _min;
+	std::int8_t _max;
+};
+
+}  // namespace Core
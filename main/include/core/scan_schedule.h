@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+
+namespace Core
+{
+
+/// @brief Scan schedule of a Scanner - the value of the 'scan' characteristic.
+///
+/// Serialized (little endian) - mode 1B, BLE scan window 2B [ms], BLE scan interval 2B [ms],
+/// BLE share of the scanning time 1B [%] (when scanning both BLE and Classic).
+/// The Master writes @ref Mode::Fixed to override the adaptive schedule, or just
+/// @ref Mode::Adaptive (1B) to return to it. Reads return the schedule in use.
+struct ScanSchedule
+{
+	/// @brief Serialized size
+	static constexpr std::size_t Size = 6;
+
+	/// @brief BLE scan window/interval limits [ms]
+	/// @{
+	static constexpr std::uint16_t MinInterval = 3;
+	static constexpr std::uint16_t MaxInterval = 10'240;
+	/// @}
+
+	/// @brief Who chooses the schedule
+	enum class Mode : std::uint8_t
+	{
+		Adaptive = 0,  ///< Tuned by the Scanner
+		Fixed = 1      ///< Set by the Master
+	};
+
+	Mode Source{Mode::Adaptive};    ///< Who chose the schedule
+	std::uint16_t Window{600};      ///< BLE scan window [ms]
+	std::uint16_t Interval{1'000};  ///< BLE scan interval [ms]
+	std::uint8_t BleShare{75};      ///< Share of BLE in the scanning time [%]
+
+	/// @brief Serialize
+	/// @param[out] out destination
+	void Serialize(std::span<std::uint8_t, Size> out) const;
+
+	/// @brief Parse a written value
+	/// @param data written value
+	/// @return schedule; nullopt if it's invalid
+	static std::optional<ScanSchedule> Parse(std::span<const std::uint8_t> data);
+
+	bool operator==(const ScanSchedule &) const = default;
+};
+
+}  // namespace Core
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace Core
+{
+
+/// @brief Task placement
+struct TaskConfig
+{
+	std::uint32_t StackSize{4096};  ///< Stack size [B]
+	std::uint8_t Priority{1};       ///< FreeRTOS priority
+	std::int8_t Core{-1};           ///< Core to pin the task to (-1 for no affinity)
+};
+
+/// @brief Create a task according to the configuration. Cores that don't exist on this chip
+/// are treated as no affinity.
+/// @param fn task function
+/// @param name task name
+/// @param cfg placement
+/// @param arg task function argument
+/// @param[out] handle created task (optional)
+/// @return true if created
+bool CreateTask(TaskFunction_t fn,
+                const char * name,
+                const TaskConfig & cfg,
+                void * arg,
+                TaskHandle_t * handle);
+
+/// @brief Per-task CPU usage reporting. Requires run time stats and the trace facility
+/// (CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS, CONFIG_FREERTOS_USE_TRACE_FACILITY);
+/// otherwise it only logs a warning.
+class TaskStats
+{
+public:
+	/// @brief Log CPU usage of each task since the previous call (or since boot)
+	void Report();
+
+private:
+	/// @brief Run time counter type (depends on the FreeRTOS configuration)
+	using RunTime = decltype(TaskStatus_t::ulRunTimeCounter);
+
+	/// @brief Run time of a task during the previous report
+	struct Previous
+	{
+		TaskHandle_t Handle;
+		RunTime Time;
+	};
+
+	std::vector<TaskStatus_t> _status;
+	std::vector<Previous> _previous;
+	RunTime _previousTotal{0};
+};
+
+}  // namespace Core
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+
+namespace Core
+{
+
+/// @brief Where to allocate memory
+enum class MemoryRegion : std::uint8_t
+{
+	Internal,  ///< Internal RAM
+	External   ///< External RAM (PSRAM); falls back to internal RAM if not available
+};
+
+/// @brief Allocate memory in a region
+/// @param size size in bytes
+/// @param region region
+/// @return memory or nullptr
+void * AllocateIn(std::size_t size, MemoryRegion region);
+
+/// @brief Free memory allocated by @ref AllocateIn
+/// @param ptr memory
+void FreeIn(void * ptr);
+
+/// @brief Standard allocator for a memory region. Used for large tables, which
+/// can be placed in PSRAM.
+template <typename T>
+class CapsAllocator
+{
+public:
+	using value_type = T;
+	using propagate_on_container_copy_assignment = std::true_type;
+	using propagate_on_container_move_assignment = std::true_type;
+	using propagate_on_container_swap = std::true_type;
+
+	/// @brief Constructor
+	/// @param region memory region
+	CapsAllocator(MemoryRegion region = MemoryRegion::Internal) noexcept
+	    : _region(region)
+	{
+	}
+
+	template <typename U>
+	CapsAllocator(const CapsAllocator<U> & other) noexcept
+	    : _region(other.Region())
+	{
+	}
+
+	T * allocate(std::size_t n)
+	{
+		void * ptr = AllocateIn(n * sizeof(T), _region);
+		if (ptr == nullptr) {
+			throw std::bad_alloc();
+		}
+		return static_cast<T *>(ptr);
+	}
+
+	void deallocate(T * ptr, std::size_t n) noexcept { FreeIn(ptr); }
+
+	/// @brief Memory region
+	MemoryRegion Region() const noexcept { return _region; }
+
+	template <typename U>
+	bool operator==(const CapsAllocator<U> & other) const noexcept
+	{
+		return _region == other.Region();
+	}
+
+private:
+	MemoryRegion _region;
+};
+
+}  // namespace Core
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "core/utility/caps_allocator.h"
+#include "core/utility/lru_index.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace Core
+{
+
+/// @brief FNV-1a hash
+/// @{
+constexpr std::uint32_t FnvOffset = 2'166'136'261u;
+constexpr std::uint32_t FnvPrime = 16'777'619u;
+
+constexpr std::uint32_t Fnv1a(std::span<const std::uint8_t> data, std::uint32_t hash = FnvOffset)
+{
+	for (const std::uint8_t b : data) {
+		hash = (hash ^ b) * FnvPrime;
+	}
+	return hash;
+}
+/// @}
+
+/// @brief Fixed-capacity hash index from a key hash to slot indices (of ex. @ref LruIndex).
+///
+/// Open addressing with linear probing; the table has at least twice as many buckets as
+/// the maximum entries, so probe sequences stay short. Only hashes are stored - lookups
+/// confirm the candidates with a predicate, so colliding keys are allowed. All operations
+/// are O(1) on average. The table is always kept in internal RAM.
+class HashIndex
+{
+public:
+	using Index = LruIndex::Index;
+
+	/// @brief Invalid index
+	static constexpr Index Npos = LruIndex::Npos;
+
+	/// @brief Constructor
+	/// @param capacity maximum number of entries
+	HashIndex(std::size_t capacity);
+
+	/// @brief Add an entry
+	/// @param hash key hash
+	/// @param idx slot index
+	void Insert(std::uint32_t hash, Index idx);
+
+	/// @brief Remove an entry; does nothing if it isn't stored
+	/// @param hash key hash (the same as when inserted)
+	/// @param idx slot index
+	void Erase(std::uint32_t hash, Index idx);
+
+	/// @brief Find a slot
+	/// @param hash key hash
+	/// @param matches predicate `bool(Index)`, which compares the slot's key with the searched one
+	/// @return first matching slot or Npos
+	template <typename Pred>
+	Index Find(std::uint32_t hash, Pred && matches) const
+	{
+		for (std::size_t b = hash & _mask; _buckets[b].Idx != Npos; b = (b + 1) & _mask) {
+			if (_buckets[b].Hash == hash && matches(_buckets[b].Idx)) {
+				return _buckets[b].Idx;
+			}
+		}
+		return Npos;
+	}
+
+	/// @brief Remove all entries
+	void Clear();
+
+private:
+	struct Bucket
+	{
+		std::uint32_t Hash{0};  ///< Key hash
+		Index Idx{Npos};        ///< Slot index; Npos if the bucket is empty
+	};
+
+	std::vector<Bucket, CapsAllocator<Bucket>> _buckets;
+	std::size_t _mask;  ///< Bucket count - 1 (power of 2)
+};
+
+}  // namespace Core
@@ -0,0 +1,132 @@
+#pragma once
+
+#include "core/utility/caps_allocator.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <vector>
+
+namespace Core
+{
+
+/// @brief Intrusive LRU list over a fixed number of slots.
+///
+/// Only keeps track of slot indices; the slot storage itself is owned by the user.
+/// Used slots are linked from the most recently touched (newest) to the least recently
+/// touched (oldest) one, free slots are kept in a separate free list. All operations
+/// are O(1). The links are always kept in internal RAM, even if the slots are not.
+class LruIndex
+{
+public:
+	using Index = std::uint16_t;
+
+	/// @brief Invalid index
+	static constexpr Index Npos = std::numeric_limits<Index>::max();
+
+	/// @brief Constructor
+	/// @param capacity number of slots
+	LruIndex(std::size_t capacity);
+
+	/// @brief Take a free slot and mark it as the newest one.
+	/// @return slot index or Npos, if there are no free slots
+	Index Acquire();
+
+	/// @brief Return slot into the free list
+	/// @param idx used slot
+	void Release(Index idx);
+
+	/// @brief Mark a used slot as the newest one
+	/// @param idx used slot
+	void Touch(Index idx);
+
+	/// @brief Release all slots
+	void Clear();
+
+	/// @brief Newest/oldest used slot
+	/// @return slot index or Npos, if empty
+	/// @{
+	Index Newest() const { return _head; }
+	Index Oldest() const { return _tail; }
+	/// @}
+
+	/// @brief Next (older) used slot
+	/// @param idx used slot
+	/// @return slot index or Npos
+	Index Next(Index idx) const { return _nodes[idx].Next; }
+
+	/// @brief Whether the slot is currently used
+	/// @param idx slot
+	bool IsUsed(Index idx) const { return _nodes[idx].Used; }
+
+	/// @brief Sizes
+	/// @{
+	std::size_t Size() const { return _size; }
+	std::size_t Capacity() const { return _nodes.size(); }
+	bool Empty() const { return _size == 0; }
+	bool Full() const { return _size == _nodes.size(); }
+	/// @}
+
+	/// @brief Iterates over used slots from the newest to the oldest
+	class Iterator
+	{
+	public:
+		using iterator_category = std::forward_iterator_tag;
+		using value_type = Index;
+		using difference_type = std::ptrdiff_t;
+		using pointer = const Index *;
+		using reference = Index;
+
+		Iterator(const LruIndex * lru, Index idx)
+		    : _lru(lru)
+		    , _idx(idx)
+		{
+		}
+
+		Index operator*() const { return _idx; }
+		Iterator & operator++()
+		{
+			_idx = _lru->Next(_idx);
+			return *this;
+		}
+		Iterator operator++(int)
+		{
+			Iterator tmp = *this;
+			++(*this);
+			return tmp;
+		}
+		bool operator==(const Iterator & other) const { return _idx == other._idx; }
+
+	private:
+		const LruIndex * _lru;
+		Index _idx;
+	};
+
+	Iterator begin() const { return Iterator(this, _head); }
+	Iterator end() const { return Iterator(this, Npos); }
+
+private:
+	/// @brief Slot links
+	struct Node
+	{
+		Index Prev{Npos};  ///< Newer slot
+		Index Next{Npos};  ///< Older slot (or next free slot)
+		bool Used{false};  ///< Linked in the used list
+	};
+
+	std::vector<Node, CapsAllocator<Node>> _nodes;
+	Index _head{Npos};  ///< Newest used slot
+	Index _tail{Npos};  ///< Oldest used slot
+	Index _free{Npos};  ///< First free slot
+	std::size_t _size{0};
+
+	/// @brief Unlink/link a used slot
+	/// @param idx slot
+	/// @{
+	void _Unlink(Index idx);
+	void _PushFront(Index idx);
+	/// @}
+};
+
+}  // namespace Core
@@ -3,8 +3,10 @@
 #include <array>
 #include <cstddef>
 #include <cstdint>
+#include <optional>
 #include <span>
 #include <string>
+#include <string_view>
 
 /// @brief MAC wrapper
 struct Mac
@@ -37,3 +39,9 @@ struct Mac
 
 std::string ToString(const Mac & addr);
 std::string ToString(std::span<const std::uint8_t, Mac::Size> addr);
+
+/// @brief Parse MAC from a string: 12 hexadecimal digits, optionally separated by ':' or '-'
+/// (ex. "01:34:67:9A:CD:F0")
+/// @param str string
+/// @return MAC or nullopt, if the string isn't a valid MAC
+std::optional<Mac> ParseMac(std::string_view str);
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace Core
+{
+
+/// @brief Bounded lock-free queue of byte payloads for a single producer and a single consumer.
+///
+/// Payloads are copied into preallocated slots, so pushing never allocates or blocks. If the
+/// queue is full, the new payload is rejected and counted as an overflow.
+class PayloadQueue
+{
+public:
+	/// @brief Maximum size of a single payload (maximum attribute length)
+	static constexpr std::size_t MaxPayloadSize = 512;
+
+	/// @brief Queued payload
+	struct Payload
+	{
+		std::uint16_t Id;                               ///< User defined identifier
+		std::uint16_t Size;                             ///< Valid bytes in `Data`
+		std::uint8_t Kind;                              ///< User defined payload kind
+		std::array<std::uint8_t, MaxPayloadSize> Data;  ///< Payload
+
+		/// @brief Valid part of the payload
+		/// @{
+		std::span<std::uint8_t> View() { return std::span(Data.data(), Size); }
+		std::span<const std::uint8_t> View() const { return std::span(Data.data(), Size); }
+		/// @}
+	};
+
+	/// @brief Constructor
+	/// @param capacity maximum amount of queued payloads
+	PayloadQueue(std::size_t capacity);
+
+	/// @brief Copy a payload into the queue. Only called by the producer.
+	/// @param id user defined identifier
+	/// @param data payload; at most `MaxPayloadSize` bytes
+	/// @param kind user defined payload kind
+	/// @return false if the queue is full or the payload is too big
+	bool Push(std::uint16_t id, std::span<const std::uint8_t> data, std::uint8_t kind = 0);
+
+	/// @brief Oldest queued payload. Only called by the consumer.
+	/// @return payload (owned by the consumer until `Pop` is called) or nullptr, if the queue
+	/// is empty
+	Payload * Front();
+
+	/// @brief Remove the oldest payload. Only called by the consumer.
+	void Pop();
+
+	/// @brief Current amount of queued payloads
+	std::size_t Size() const;
+
+	/// @brief Maximum amount of queued payloads
+	std::size_t Capacity() const { return _slots.size(); }
+
+	/// @brief Highest amount of payloads queued at the same time
+	std::size_t HighWatermark() const { return _highWatermark.load(std::memory_order_relaxed); }
+
+	/// @brief Amount of payloads rejected because the queue was full
+	std::uint32_t Overflows() const { return _overflows.load(std::memory_order_relaxed); }
+
+private:
+	std::vector<Payload> _slots;
+
+	std::atomic<std::size_t> _head{0};  ///< Consumer; total popped payloads
+	std::atomic<std::size_t> _tail{0};  ///< Producer; total pushed payloads
+
+	std::atomic<std::size_t> _highWatermark{0};
+	std::atomic<std::uint32_t> _overflows{0};
+};
+
+}  // namespace Core
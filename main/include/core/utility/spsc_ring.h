@@ -0,0 +1,102 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+namespace Core
+{
+
+/// @brief Bounded lock-free ring of fixed-size records for a single producer and a single
+/// consumer.
+///
+/// Records are copied into preallocated slots, so pushing never allocates or blocks. If the
+/// ring is full, the new record is rejected and counted as an overflow.
+/// @tparam T record type; trivially copyable
+template <typename T>
+class SpscRing
+{
+	static_assert(std::is_trivially_copyable_v<T>, "Records are copied into the slots");
+
+public:
+	/// @brief Constructor
+	/// @param capacity maximum amount of queued records
+	SpscRing(std::size_t capacity)
+	    : _slots(std::max<std::size_t>(capacity, 1))
+	{
+	}
+
+	/// @brief Copy a record into the ring. Only called by the producer.
+	/// @param record record
+	/// @return false if the ring is full
+	bool Push(const T & record)
+	{
+		const std::size_t tail = _tail.load(std::memory_order_relaxed);
+		const std::size_t size = tail - _head.load(std::memory_order_acquire);
+		if (size >= _slots.size()) {
+			_overflows.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		}
+
+		_slots[tail % _slots.size()] = record;
+		_tail.store(tail + 1, std::memory_order_release);
+
+		if (size + 1 > _highWatermark.load(std::memory_order_relaxed)) {
+			_highWatermark.store(size + 1, std::memory_order_relaxed);
+		}
+		return true;
+	}
+
+	/// @brief Oldest queued record. Only called by the consumer.
+	/// @return record (owned by the consumer until `Pop` is called) or nullptr, if the ring
+	/// is empty
+	T * Front()
+	{
+		const std::size_t head = _head.load(std::memory_order_relaxed);
+		if (head == _tail.load(std::memory_order_acquire)) {
+			return nullptr;
+		}
+		return &_slots[head % _slots.size()];
+	}
+
+	/// @brief Remove the oldest record. Only called by the consumer.
+	void Pop()
+	{
+		const std::size_t head = _head.load(std::memory_order_relaxed);
+		if (head == _tail.load(std::memory_order_acquire)) {
+			return;
+		}
+		_head.store(head + 1, std::memory_order_release);
+	}
+
+	/// @brief Current amount of queued records
+	std::size_t Size() const
+	{
+		// Head first; the tail can only move forward in the meantime
+		const std::size_t head = _head.load(std::memory_order_acquire);
+		return _tail.load(std::memory_order_acquire) - head;
+	}
+
+	/// @brief Maximum amount of queued records
+	std::size_t Capacity() const { return _slots.size(); }
+
+	/// @brief Highest amount of records queued at the same time
+	std::size_t HighWatermark() const { return _highWatermark.load(std::memory_order_relaxed); }
+
+	/// @brief Amount of records rejected because the ring was full
+	std::uint32_t Overflows() const { return _overflows.load(std::memory_order_relaxed); }
+
+private:
+	std::vector<T> _slots;
+
+	std::atomic<std::size_t> _head{0};  ///< Consumer; total popped records
+	std::atomic<std::size_t> _tail{0};  ///< Producer; total pushed records
+
+	std::atomic<std::size_t> _highWatermark{0};
+	std::atomic<std::uint32_t> _overflows{0};
+};
+
+}  // namespace Core
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+namespace Core
+{
+
+/// @brief Lock-free triple buffer for a single producer and a single consumer.
+///
+/// The producer fills the write buffer and publishes it, which swaps it with the middle
+/// buffer. The reader swaps the middle buffer with its own buffer, if a newer one was
+/// published. Nothing gets copied and neither side ever waits; the reader always sees
+/// a complete buffer.
+class TripleBuffer
+{
+public:
+	using Buffer = std::vector<std::uint8_t>;
+
+	/// @brief Buffer for the producer. Not visible to the reader until `Publish` is called.
+	/// @return buffer; contents are undefined (older data)
+	Buffer & WriteBuffer() { return _buffers[_back]; }
+
+	/// @brief Publish the write buffer. Only called by the producer.
+	void Publish();
+
+	/// @brief Get the newest published buffer. Only called by the reader.
+	/// @return buffer; valid until the next call of this method
+	const Buffer & Read();
+
+private:
+	/// @brief Marks the middle buffer as not read yet
+	static constexpr std::uint8_t NewDataFlag = 0x80;
+	static constexpr std::uint8_t IndexMask = 0x03;
+
+	std::array<Buffer, 3> _buffers;
+
+	std::atomic<std::uint8_t> _middle{1};  ///< Shared; index of the last published buffer
+	std::uint8_t _back{0};                 ///< Producer only
+	std::uint8_t _front{2};                ///< Reader only
+};
+
+}  // namespace Core
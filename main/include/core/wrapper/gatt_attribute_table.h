@@ -49,6 +49,9 @@ public:
 	           esp_gatt_perm_t permissions,
 	           std::uint8_t attControl = ESP_GATT_AUTO_RSP);
 
+	/// @brief Add a client characteristic configuration descriptor (for the preceding value)
+	void ClientConfig();
+
 	/// @brief Stored attributes
 	std::vector<Item> Attributes;
 
@@ -97,6 +100,11 @@ public:
 	                              esp_gatt_perm_t permissions,
 	                              std::uint8_t attControl = ESP_GATT_AUTO_RSP);
 
+	/// @brief Add new Client Characteristic Configuration Descriptor (for the preceding value).
+	/// Required for notifications/indications.
+	/// @return this
+	AttributeTableBuilder & ClientConfig();
+
 	/// @brief Finish building and return table.
 	/// @return table
 	AttributeTable && Finish();
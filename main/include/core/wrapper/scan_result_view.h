@@ -0,0 +1,137 @@
+#pragma once
+
+#include "core/utility/mac.h"
+#include "core/wrapper/device.h"
+#include "core/wrapper/interface/gap_ble_if.h"
+#include "core/wrapper/interface/gap_bt_if.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <optional>
+#include <span>
+
+namespace Bt
+{
+
+/// @brief Non-owning view of EIR/advertising data. Records are parsed lazily while iterating,
+/// so nothing is copied or allocated.
+class EirView
+{
+public:
+	using Record = BleSpecific::Eir::Record;
+
+	/// @brief Forward iterator over the records; stops at the first empty or truncated record
+	class Iterator
+	{
+	public:
+		using iterator_category = std::forward_iterator_tag;
+		using value_type = Record;
+		using difference_type = std::ptrdiff_t;
+		using pointer = const Record *;
+		using reference = const Record &;
+
+		/// @brief End iterator
+		Iterator() = default;
+
+		/// @brief Constructor
+		/// @param data remaining EIR data
+		Iterator(std::span<const std::uint8_t> data);
+
+		reference operator*() const { return _record; }
+		pointer operator->() const { return &_record; }
+		Iterator & operator++();
+		Iterator operator++(int);
+		bool operator==(const Iterator & other) const { return _rest.data() == other._rest.data(); }
+
+	private:
+		/// @brief Parse the record at the start of `_rest`; becomes the end iterator if there
+		/// isn't a valid one
+		void _Parse();
+
+		std::span<const std::uint8_t> _rest;  ///< Data from the current record on
+		Record _record{};                     ///< Current record
+	};
+
+	/// @brief Constructor
+	/// @param data EIR data; it needs to outlive the view
+	EirView(std::span<const std::uint8_t> data)
+	    : _data(data)
+	{
+	}
+
+	Iterator begin() const { return Iterator(_data); }
+	Iterator end() const { return Iterator(); }
+
+	/// @brief Underlying data
+	std::span<const std::uint8_t> Data() const { return _data; }
+
+	/// @brief Whether the data consists of exactly one record
+	bool IsSingleRecord() const;
+
+	/// @brief Find the first record of a type
+	/// @param type record type
+	/// @return record or nullopt
+	std::optional<Record> Find(esp_ble_adv_data_type type) const;
+
+private:
+	std::span<const std::uint8_t> _data;
+};
+
+/// @brief Non-owning view of a BLE scan result or a BR/EDR discovery result.
+///
+/// Cheap to construct in the GAP callbacks, so results can be filtered before anything is
+/// copied. Use @ref ToDevice to materialise an owning @ref Device when it's needed.
+/// The viewed result has to outlive the view.
+class ScanResultView
+{
+public:
+	/// @brief Constructor
+	/// @param sr BLE scan result
+	ScanResultView(const Gap::Ble::ScanResult & sr)
+	    : _ble(&sr)
+	{
+	}
+
+	/// @brief Constructor
+	/// @param dr BR/EDR discovery result
+	ScanResultView(const Gap::Bt::DiscRes & dr)
+	    : _brEdr(&dr)
+	{
+	}
+
+	bool IsBle() const { return _ble != nullptr; }
+	bool IsBrEdr() const { return _brEdr != nullptr; }
+
+	/// @brief Device address
+	std::span<const std::uint8_t, Mac::Size> Bda() const;
+
+	/// @brief RSSI; BR/EDR results don't have to contain it
+	std::optional<std::int8_t> Rssi() const;
+
+	/// @brief Whether it's a BLE device with a public address
+	bool IsBlePublic() const;
+
+	/// @brief EIR data; advertising data + scan response for BLE
+	EirView Eir() const;
+
+	/// @brief BLE scan result; only valid if @ref IsBle
+	const Gap::Ble::ScanResult & Ble() const { return *_ble; }
+
+	/// @brief BR/EDR discovery result; only valid if @ref IsBrEdr
+	const Gap::Bt::DiscRes & BrEdr() const { return *_brEdr; }
+
+	/// @brief Create an owning copy
+	Device ToDevice() const;
+
+private:
+	/// @brief Find a BR/EDR property
+	/// @param type property type
+	/// @return property or nullptr
+	const esp_bt_gap_dev_prop_t * _FindProp(esp_bt_gap_dev_prop_type_t type) const;
+
+	const Gap::Ble::ScanResult * _ble = nullptr;
+	const Gap::Bt::DiscRes * _brEdr = nullptr;
+};
+
+}  // namespace Bt
@@ -13,6 +13,11 @@ namespace Master::HttpApi
 /// - Set reference RSSI
 /// - Set environment factor
 /// - Map name to a device
+/// - Force a scanner to advertise
+/// - Add/remove a zone
+/// - Add/remove an identity resolving key
+/// - Override the scan schedule of a scanner
+/// - Set/remove the scanner filter rules
 namespace Type
 {
 
@@ -23,7 +28,11 @@ enum class ValueType : std::uint8_t
 	RefPathLoss = 1,
 	EnvFactor = 2,
 	MacName = 3,
-	ForceAdvertise = 4
+	ForceAdvertise = 4,
+	Zone = 5,
+	Irk = 6,
+	ScanSchedule = 7,
+	FilterRules = 8
 };
 
 struct SystemMsg
@@ -142,6 +151,103 @@ struct ForceAdvertise
 	constexpr static std::size_t Size = 6;  // 6B MAC
 	std::span<const std::uint8_t, Size> Data;
 };
+
+/// @brief Add/replace or remove a zone
+struct Zone
+{
+	Zone(std::span<const std::uint8_t> data);
+
+	/// @brief Data getters
+	/// @return data
+	/// @{
+	std::uint8_t Id() const;
+	/// @brief Zone definition (@ref Master::Zone); empty if the zone should be removed
+	std::span<const std::uint8_t> Definition() const;
+	/// @}
+
+	/// @brief Validity check; expects data without first type byte
+	/// @param data data
+	/// @return is valid
+	static bool IsValid(std::span<const std::uint8_t> data);
+
+	/// @brief Size of the data (without the type byte)
+	/// @param data valid data
+	/// @return size
+	static std::size_t Size(std::span<const std::uint8_t> data);
+
+	std::span<const std::uint8_t> Data;
+
+	static constexpr std::size_t MinSize = 2;  // 1B id + 1B vertex count (0 - remove)
+};
+
+/// @brief Add/replace or remove an identity resolving key
+struct Irk
+{
+	Irk(std::span<const std::uint8_t> data);
+
+	/// @brief Data getters
+	/// @return data
+	/// @{
+	std::uint8_t Id() const;
+	/// @brief Key definition (@ref Master::Irk)
+	std::span<const std::uint8_t, 22> Definition() const;
+	/// @brief Whether the key should be removed (all-zero key)
+	bool IsRemove() const;
+	/// @}
+
+	/// @brief Validity check; expects data without first type byte
+	/// @param data data
+	/// @return is valid
+	static bool IsValid(std::span<const std::uint8_t> data);
+
+	constexpr static std::size_t Size = 23;  // 1B id + 6B identity MAC + 16B IRK
+	std::span<const std::uint8_t, Size> Data;
+};
+
+/// @brief Override the scan schedule of a scanner, or return it to the adaptive one
+struct ScanSchedule
+{
+	ScanSchedule(std::span<const std::uint8_t> data);
+
+	/// @brief Data getters
+	/// @return data
+	/// @{
+	std::span<const std::uint8_t, 6> Mac() const;
+	/// @brief Schedule (@ref Core::ScanSchedule)
+	std::span<const std::uint8_t, 6> Schedule() const;
+	/// @}
+
+	/// @brief Validity check; expects data without first type byte
+	/// @param data data
+	/// @return is valid
+	static bool IsValid(std::span<const std::uint8_t> data);
+
+	constexpr static std::size_t Size = 12;  // 6B MAC + 6B schedule
+	std::span<const std::uint8_t, Size> Data;
+};
+
+/// @brief Set or remove the filter rules of all scanners
+struct FilterRules
+{
+	FilterRules(std::span<const std::uint8_t> data);
+
+	/// @brief Rules (@ref Core::FilterRules); empty if they should be removed
+	std::span<const std::uint8_t> Rules() const;
+
+	/// @brief Validity check; expects data without first type byte
+	/// @param data data
+	/// @return is valid
+	static bool IsValid(std::span<const std::uint8_t> data);
+
+	/// @brief Size of the data (without the type byte)
+	/// @param data valid data
+	/// @return size
+	static std::size_t Size(std::span<const std::uint8_t> data);
+
+	std::span<const std::uint8_t> Data;
+
+	static constexpr std::size_t MinSize = 1;  // 1B rules length (0 - remove)
+};
 }  // namespace Type
 
 /// @brief POST data underlying types
@@ -150,7 +256,11 @@ using PostDataEntry = std::variant<std::monostate,
                                    Type::RefPathLoss,
                                    Type::EnvFactor,
                                    Type::MacName,
-                                   Type::ForceAdvertise>;
+                                   Type::ForceAdvertise,
+                                   Type::Zone,
+                                   Type::Irk,
+                                   Type::ScanSchedule,
+                                   Type::FilterRules>;
 
 /// @brief View for accessing devices API POST data:
 /// [Type][Data][Type]...
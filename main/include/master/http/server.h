@@ -1,9 +1,12 @@
 #pragma once
 
+#include "core/utility/mac.h"
 #include "master/http/server_cfg.h"
 
+#include <cstdint>
 #include <functional>
 #include <span>
+#include <vector>
 
 namespace Master::Impl
 {
@@ -13,7 +16,8 @@ class HttpServer;
 namespace Master
 {
 
-/// @brief Basic HTTP server for Master device with 3 endpoints (IndexUri, DevicesUri, ConfigUri).
+/// @brief Basic HTTP server for Master device with 5 endpoints (IndexUri, DevicesUri, ConfigUri,
+/// HistoryUri, ZoneEventsUri).
 class HttpServer
 {
 public:
@@ -24,14 +28,32 @@ public:
 	/// @brief Initialize with configuration
 	void Init();
 
-	/// @brief Set the data returned from DevicesUri endpoint (GET)
-	/// @param data raw data
-	void SetDevicesGetData(std::span<const char> data);
+	/// @brief Buffer for the next data returned from DevicesUri endpoint (GET).
+	/// Only a single producer is allowed.
+	/// @return buffer; contents are undefined (older data)
+	std::vector<std::uint8_t> & DevicesGetDataBuffer();
+
+	/// @brief Publish the buffer returned by `DevicesGetDataBuffer`.
+	/// Requests received after this call will receive its data.
+	void PublishDevicesGetData();
+
+	/// @brief Buffer for the next data returned from ZoneEventsUri endpoint (GET).
+	/// Only a single producer is allowed.
+	/// @return buffer; contents are undefined (older data)
+	std::vector<std::uint8_t> & ZoneEventsGetDataBuffer();
+
+	/// @brief Publish the buffer returned by `ZoneEventsGetDataBuffer`.
+	void PublishZoneEventsGetData();
 
 	/// @brief Listener for ConfigUri POST request
 	/// @param fn function
 	void SetConfigPostListener(std::function<void(std::span<const char>)> fn);
 
+	/// @brief Listener for HistoryUri GET request. Called from the HTTPd task.
+	/// @param fn function; fills the response data for a device, returns false if there's
+	/// no history for it
+	void SetHistoryGetListener(std::function<bool(const Mac &, std::vector<std::uint8_t> &)> fn);
+
 	/// @brief Switch to another WiFi mode.
 	/// @param mode WiFi mode
 	void SwitchMode(WifiOpMode mode);
@@ -6,6 +6,7 @@
 #include <string>
 #include <variant>
 
+#include "core/task.h"
 #include "esp_eap_client.h"
 
 namespace Master
@@ -69,6 +70,9 @@ struct WifiConfig
 	WifiOpMode Mode;  ///< Currently selected mode
 	ApConfig Ap;      ///< AP configuration
 	StaConfig Sta;    ///< STA configuration
+
+	/// @brief HTTP server task
+	Core::TaskConfig ServerTask{.StackSize = 4096, .Priority = 5, .Core = -1};
 };
 
 }  // namespace Master
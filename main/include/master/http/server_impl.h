@@ -9,6 +9,8 @@
 #include <esp_http_server.h>
 #include <esp_netif.h>
 
+#include "core/utility/mac.h"
+#include "core/utility/triple_buffer.h"
 #include "master/http/server_cfg.h"
 
 namespace
@@ -22,8 +24,17 @@ constexpr std::string_view DevicesUri = "/api/devices";
 /// @brief Config API URI
 constexpr std::string_view ConfigUri = "/api/config";
 
+/// @brief Device position history API URI (`?mac=01:34:67:9A:CD:F0`)
+constexpr std::string_view HistoryUri = "/api/history";
+
+/// @brief Maximum length of the query string
+constexpr std::size_t QueryLengthLimit = 64;
+
+/// @brief Zone events API URI (`?since=<sequence number>`)
+constexpr std::string_view ZoneEventsUri = "/api/zones/events";
+
 /// @brief Maximum length for API POST data
-constexpr std::size_t PostDevicesLengthLimit = 64;
+constexpr std::size_t PostDevicesLengthLimit = 256;
 }  // namespace
 
 namespace Master::Impl
@@ -48,6 +59,8 @@ public:
 	esp_err_t GetIndexHandler(httpd_req_t * r);
 	esp_err_t GetDevicesHandler(httpd_req_t * r);
 	esp_err_t PostConfigHandler(httpd_req_t * r);
+	esp_err_t GetHistoryHandler(httpd_req_t * r);
+	esp_err_t GetZoneEventsHandler(httpd_req_t * r);
 	/// @}
 
 	/// @brief Wifi handler callback. Not meant to be called directly.
@@ -56,14 +69,28 @@ public:
 	/// @param eventData data
 	void WifiHandler(esp_event_base_t eventBase, std::int32_t eventId, void * eventData);
 
-	/// @brief Set the data for GET DevicesUri
-	/// @param data raw data
-	void SetDevicesGetData(std::span<const char> data);
+	/// @brief Buffer for the next GET DevicesUri data; single producer only
+	/// @return buffer
+	std::vector<std::uint8_t> & DevicesGetDataBuffer();
+
+	/// @brief Publish the buffer for GET DevicesUri
+	void PublishDevicesGetData();
+
+	/// @brief Buffer for the next GET ZoneEventsUri data; single producer only
+	/// @return buffer
+	std::vector<std::uint8_t> & ZoneEventsGetDataBuffer();
+
+	/// @brief Publish the buffer for GET ZoneEventsUri
+	void PublishZoneEventsGetData();
 
 	/// @brief Listener for POST ConfigUri
 	/// @param fn function
 	void SetConfigPostListener(std::function<void(std::span<const char>)> fn);
 
+	/// @brief Listener for GET HistoryUri
+	/// @param fn function
+	void SetHistoryGetListener(std::function<bool(const Mac &, std::vector<std::uint8_t> &)> fn);
+
 	/// @brief Switch to another WiFi mode.
 	/// @param mode Wifi mode
 	void SwitchMode(WifiOpMode mode);
@@ -76,10 +103,16 @@ private:
 	WifiConfig _cfg;
 	/// HTTPd server handle
 	httpd_handle_t _handle{nullptr};
-	/// Data for API endpoint
-	std::vector<char> _rawData;
+	/// Data for API endpoint; written by the Master, read by the HTTPd task
+	Core::TripleBuffer _devicesData;
+	/// Data for zone events endpoint; written by the Master, read by the HTTPd task
+	Core::TripleBuffer _zoneEventsData;
 	/// Function called for API endpoint POST request
 	std::function<void(std::span<const char>)> _postConfigListener;
+	/// Function called for GET HistoryUri request; fills the response data
+	std::function<bool(const Mac &, std::vector<std::uint8_t> &)> _getHistoryListener;
+	/// Response data for GET HistoryUri; only used by the HTTPd task
+	std::vector<std::uint8_t> _historyData;
 
 	/// Network interface
 	esp_netif_t * _netIf{nullptr};
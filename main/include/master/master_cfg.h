@@ -1,21 +1,53 @@
 #pragma once
 
+#include "core/task.h"
+#include "core/utility/caps_allocator.h"
 #include "master/http/server_cfg.h"
 
 #include <cstddef>
+#include <cstdint>
 
 namespace Master
 {
 
+/// @brief How Scanners send their data
+enum class ScannerTransfer
+{
+	Read,      ///< Periodic GATT Reads
+	Notify,    ///< Notifications
+	Indicate,  ///< Indications (confirmed notifications)
+};
+
 /// @brief Master application configuration
 struct AppConfig
 {
+	/// @brief How Scanners send their data. Scanners without notification support are
+	/// always read.
+	ScannerTransfer Transfer{ScannerTransfer::Notify};
+
+	/// @brief Ask Scanners for compact records with RSSI statistics (@ref Core::Compact) - known
+	/// devices are sent as short RSSI updates. Scanners without the support keep sending full
+	/// records.
+	bool CompactRecords{true};
+
 	/// @brief Time to wait before sending GATT Reads to each Scanner
 	std::size_t GattReadInterval{1000};
 
 	/// @brief Time to wait between each GATT Read
 	std::size_t DelayBetweenGattReads{500};
 
+	/// @brief Maximum amount of received GATT Read payloads waiting to be processed
+	std::size_t GattReadQueueDepth{8};
+
+	/// @brief Maximum amount of messages waiting for the memory owner task
+	std::size_t MemoryQueueDepth{16};
+
+	/// @brief Task owning the device memory (processes received data, calculates positions)
+	Core::TaskConfig MemoryTaskCfg{.StackSize = 24'576, .Priority = 5, .Core = 1};
+
+	/// @brief How often to log CPU usage of each task [ms]; 0 to disable
+	std::size_t TaskStatsInterval{0};
+
 	/// @brief DeviceMemory configuration
 	struct DeviceMemoryConfig
 	{
@@ -28,9 +60,41 @@ struct AppConfig
 		/// @brief Maximum connected Scanners.
 		std::uint8_t MaxScanners{8};
 
+		/// @brief Maximum stored devices. When full, the least recently updated device
+		/// gets replaced.
+		std::size_t MaxDevices{80};
+
+		/// @brief Where to allocate device tables. Their lookup index is always kept
+		/// in internal RAM.
+		Core::MemoryRegion DeviceTableRegion{Core::MemoryRegion::Internal};
+
 		/// @brief How long before a device gets removed if it doesn't receive a measurement. [ms]
 		std::size_t DeviceStoreTime{60'000};
 
+		/// @brief How long a single Scanner measurement is used to calculate a position. [ms]
+		std::size_t MeasurementFreshness{10'000};
+
+		/// @brief Maximum time difference between the newest and the oldest measurement
+		/// used together to calculate a position. [ms]
+		std::size_t FusionWindow{2'000};
+
+		/// @brief Link BLE devices with rotating random addresses, which send the same
+		/// advertising data (@ref AdvFingerprint), to a single device. A new address replaces
+		/// the old one; measurements and history are kept. Risks merging 2 different devices
+		/// with the same advertising data.
+		bool AssociateRandomAddresses{true};
+
+		/// @brief How long the old address has to be silent on every Scanner before a new
+		/// address is linked to it. [ms]
+		std::size_t AssociationGap{2'000};
+
+		/// @brief Resolved positions stored for each device (0 - no history).
+		/// At most `Trajectory::MaxLength`.
+		std::size_t HistoryLength{32};
+
+		/// @brief Zone enter/exit events kept for the HTTP API (the oldest get replaced).
+		std::size_t ZoneEventCapacity{64};
+
 		/// @brief Default path loss at 1m distance used for all devices.
 		std::int8_t DefaultPathLoss{45};
 
@@ -41,6 +105,43 @@ struct AppConfig
 		/// Instead, it's expected that the data is pulled from the HTTP API Measurements endpoint
 		/// and positions calculated somewhere else.
 		bool NoPositionCalculation{false};
+
+		/// @brief RSSI filter applied to each Scanner measurement
+		struct RssiFilterConfig
+		{
+			/// @brief Available filters
+			enum class Type : std::uint8_t
+			{
+				Ema,     ///< Exponential moving average
+				Median,  ///< Sliding median
+				Kalman   ///< 1D Kalman filter
+			};
+
+			/// @brief Used filter
+			Type FilterType{Type::Ema};
+
+			/// @brief EMA weight of a new sample in 1/256 (256 - only the new sample is used).
+			std::uint16_t EmaAlpha{64};
+
+			/// @brief Kalman process noise (RSSI variance added between samples). [dBm^2]
+			float KalmanProcessNoise{0.5};
+
+			/// @brief Kalman measurement noise (RSSI variance of a single sample). [dBm^2]
+			float KalmanMeasurementNoise{4.0};
+		} RssiFilterCfg;
+
+		/// @brief Scheduling of Scanner to Scanner measurements (which Scanner should advertise)
+		struct ScannerLinkConfig
+		{
+			/// @brief Links older than this get measured again, even if they converged. [ms]
+			std::size_t MaxAge{300'000};
+
+			/// @brief Links with a lower RSSI variance are considered converged. [dBm^2]
+			float ConvergedVariance{4.0};
+
+			/// @brief Minimum samples before a link can converge.
+			std::uint16_t MinSamples{5};
+		} ScannerLinkCfg;
 	} DeviceMemoryCfg;
 
 	/// @brief WiFi configuration
@@ -1,21 +1,30 @@
 #pragma once
 
+#include "core/batch_frames.h"
+#include "core/compact_records.h"
+#include "core/filter_rules.h"
+#include "core/task.h"
 #include "core/utility/mac.h"
+#include "core/utility/payload_queue.h"
 #include "core/wrapper/device.h"
 #include "core/wrapper/gap_ble_wrapper.h"
 #include "core/wrapper/gattc_wrapper.h"
 #include "core/wrapper/interface/gap_ble_if.h"
 #include "core/wrapper/interface/gattc_if.h"
+#include "core/wrapper/scan_result_view.h"
 #include "master/http/api/post_data.h"
 #include "master/http/server.h"
 #include "master/master_cfg.h"
 #include "master/memory/idevice_memory.h"
+#include "master/memory/memory_msg.h"
 
+#include <atomic>
 #include <optional>
 #include <span>
 #include <vector>
 
-#include <freertos/semphr.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
 
 namespace Master::Impl
 {
@@ -38,6 +47,13 @@ public:
 	/// @param data data sent in POST request
 	void OnHttpServerUpdate(std::span<const char> data);
 
+	/// @brief HTTP server API history GET callback. Asks the memory task and waits for
+	/// the reply.
+	/// @param mac device address
+	/// @param[out] output serialized history
+	/// @return false if there's no history for the device
+	bool OnHttpHistoryRequest(const Mac & mac, std::vector<std::uint8_t> & output);
+
 	/// @brief BLE GAP related callbacks
 	/// @{
 	void GapBleScanResult(const Gap::Ble::Type::ScanResult & p) override;
@@ -52,16 +68,21 @@ public:
 	void GattcClose(const Gattc::Type::Close & p) override;
 	void GattcDisconnect(const Gattc::Type::Disconnect & p) override;
 	void GattcCancelOpen() override;
+	void GattcCfgMtu(const Gattc::Type::CfgMtu & p) override;
 	void GattcReadChar(const Gattc::Type::ReadChar & p) override;
+	void GattcNotify(const Gattc::Type::Notify & p) override;
+	void GattcWriteChar(const Gattc::Type::WriteChar & p) override;
+	void GattcWriteDescr(const Gattc::Type::WriteDescr & p) override;
 	void GattcSearchCmpl(const Gattc::Type::SearchCmpl & p) override;
 	void GattcSearchRes(const Gattc::Type::SearchRes & p) override;
 	/// @}
 
-	/// @brief Update loop. Uses a dedicated task.
-	void UpdateScannersLoop();
-
-	/// @brief Update loop. Uses a dedicated task.
-	void UpdateDeviceDataLoop();
+	/// @brief Memory owner loop. Uses a dedicated task.
+	///
+	/// The only place where the device memory gets accessed. Processes messages from other
+	/// tasks/callbacks and periodically reads data from scanners, publishes new positions
+	/// and checks whether some scanner should advertise.
+	void MemoryLoop();
 
 private:
 	/// @brief Configuration
@@ -81,24 +102,167 @@ private:
 	std::vector<std::uint8_t> _tmpSerializedData;
 	/// @}
 
-	/// @brief Stored scanners and devices' data
+	/// @brief Stored scanners and devices' data. Owned by the memory task.
 	IDeviceMemory * _memory;
-	SemaphoreHandle_t _memMutex;
+
+	/// @brief Messages for the memory task
+	QueueHandle_t _memQueue;
+
+	/// @brief Disconnected scanners, whose `Msg::RemoveScanner` didn't fit the full message
+	/// queue (bit per connection id); drained by the memory task
+	std::atomic<std::uint32_t> _pendingRemovals{0};
+
+	/// @brief Replies to `Msg::GetHistory` (depth 1; the newest reply overwrites the older one)
+	QueueHandle_t _historyQueue;
+
+	/// @brief History requests state
+	/// @{
+	std::uint32_t _historySeq{0};         ///< Last request sequence number (HTTPd task)
+	Msg::HistoryReply _httpHistoryReply;  ///< Received reply (HTTPd task)
+	Msg::HistoryReply _historyReply;      ///< Reply being sent (memory task)
+	/// @}
+
+	/// @brief GATT Read payloads waiting to be written into the memory.
+	/// Filled by the GATTc callback (which never blocks), drained by the memory task.
+	Core::PayloadQueue _readQueue;
+
+	/// @brief Connected scanners. Only used from BT callbacks, so we don't have to ask
+	/// the memory task.
+	std::vector<ScannerInfo> _scanners;
 
 	/// @brief BDA of a scanner that we want to connect to.
 	/// Since we have to wait for BLE scan to stop before connecting,
 	/// we have to save it and connect later.
 	std::optional<Mac> _scannerToConnect = std::nullopt;
 
-	/// @brief Task handles
+	/// @brief Memory task handle
+	TaskHandle_t _memTask;
+
+	/// @brief CPU usage reporting (memory task)
+	Core::TaskStats _taskStats;
+
+	/// @brief Received data state of a scanner
+	struct ScannerReceiver
+	{
+		std::uint16_t ConnId;                         ///< Connection id
+		Core::BatchAssembler Batches;                 ///< Framed reads
+		std::optional<Core::CompactDecoder> Decoder;  ///< Compact record dictionary
+	};
+
+	/// @brief Memory task state
 	/// @{
-	TaskHandle_t _updateScannersTask;
-	TaskHandle_t _readDevTask;
+	std::vector<ScannerInfo> _readTargets;       ///< Scanners read in the current round
+	std::size_t _readCursor{0};                  ///< Next scanner to read
+	std::vector<ScannerReceiver> _receivers;     ///< Scanners sending frames/compact records
+	std::vector<std::uint16_t> _streamers;       ///< Scanners streaming; not read
+	std::vector<std::uint8_t> _decodedRecords;   ///< Records decoded from a compact payload
+	std::vector<Core::RssiStats> _decodedStats;  ///< RSSI statistics of `_decodedRecords`
+	Core::FilterRules _filterRules;              ///< Pushed to every scanner
 	/// @}
 
-	bool _IsScanner(const Bt::Device & p);
+	bool _IsScanner(const Bt::ScanResultView & p);
+
+	/// @brief Queue a payload from a scanner for the memory task; never blocks
+	/// @param connId scanner connection id
+	/// @param data device records
+	/// @param format record format (@ref Core::Compact version)
+	void _QueuePayload(std::uint16_t connId,
+	                   std::span<const std::uint8_t> data,
+	                   std::uint8_t format);
+
+	/// @brief Subscribe to 'Devices' notifications/indications (@ref AppConfig::Transfer)
+	/// @param scanner scanner with discovered characteristics; updated on success
+	/// @return false if the scanner doesn't support it and has to be read
+	bool _SubscribeDevices(ScannerInfo & scanner);
+
+	/// @brief Stop reading a subscribed scanner, once its MTU fits the notifications
+	/// @param scanner connected scanner
+	void _StartStreaming(ScannerInfo & scanner);
 	void _ScanForScanners();
 
+	/// @brief Send a message to the memory task
+	/// @param msg message
+	/// @param timeout maximum time to wait, if the queue is full
+	/// @return true if sent
+	bool _Send(const MemoryMsg & msg, TickType_t timeout);
+
+	/// @brief Memory task only
+	/// @{
+
+	/// @brief Process a single message
+	/// @param msg message
+	void _Process(const MemoryMsg & msg);
+
+	/// @brief Remove a disconnected scanner
+	/// @param connId connection id
+	void _RemoveScanner(std::uint16_t connId);
+
+	/// @brief Remove the scanners in `_pendingRemovals`
+	void _ProcessPendingRemovals();
+
+	/// @brief Write all queued GATT Read payloads into the memory
+	void _ProcessReadQueue();
+
+	/// @brief Write a received GATT Read payload into the memory
+	/// @param payload payload from `_readQueue`
+	void _ProcessReadPayload(Core::PayloadQueue::Payload & payload);
+
+	/// @brief Receiver of a scanner; created when needed
+	/// @param connId scanner connection id
+	/// @return receiver
+	ScannerReceiver & _Receiver(std::uint16_t connId);
+
+	/// @brief Add a frame of a batch. Reads the next chunk right away, if the batch isn't
+	/// complete, otherwise acknowledges it.
+	/// @param connId scanner connection id
+	/// @param frame frame
+	/// @return complete batch; empty if it isn't complete (or was already received)
+	std::span<std::uint8_t> _ReassembleBatch(std::uint16_t connId,
+	                                         std::span<const std::uint8_t> frame);
+
+	/// @brief Decode a compact payload. Asks the scanner to start over, if some records
+	/// can't be decoded.
+	/// @param connId scanner connection id
+	/// @param payload payload
+	/// @return decoded records (@ref Core::DeviceDataView::Array); their RSSI statistics are
+	/// in `_decodedStats`
+	std::span<std::uint8_t> _DecodeCompact(std::uint16_t connId,
+	                                       std::span<const std::uint8_t> payload);
+
+	/// @brief Send a GATT Read to the next scanner or publish the new positions, if all
+	/// of them were read in this round
+	/// @return time to wait before the next step
+	TickType_t _ReadStep();
+
+	/// @brief Load a zone definition from NVS into the memory
+	/// @param id zone id
+	void _LoadZone(std::uint8_t id);
+
+	/// @brief Load an identity resolving key from NVS into the memory
+	/// @param id key id
+	void _LoadIrk(std::uint8_t id);
+
+	/// @brief Load the scanner filter rules from NVS
+	void _LoadFilterRules();
+
+	/// @brief Force the scanner, which is missing some measurements, to advertise
+	void _CheckScannerToAdvertise();
+
+	/// @brief Switch a scanner to the advertising state
+	/// @param info scanner
+	void _ForceAdvertise(const ScannerInfo & info);
+
+	/// @brief Write the scan schedule of a scanner
+	/// @param info scanner
+	/// @param value serialized @ref Core::ScanSchedule
+	void _SetScanSchedule(const ScannerInfo & info,
+	                      std::span<const std::uint8_t, Core::ScanSchedule::Size> value);
+
+	/// @brief Write the filter rules to a scanner
+	/// @param info scanner
+	void _PushFilterRules(const ScannerInfo & info);
+	/// @}
+
 	/// @brief Process system message
 	/// @param op operation
 	void _ProcessSystemMessage(HttpApi::Type::SystemMsg::Operation op);
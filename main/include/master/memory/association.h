@@ -0,0 +1,35 @@
+#pragma once
+
+#include "core/utility/mac.h"
+
+#include <esp_gap_ble_api.h>
+
+#include <cstdint>
+#include <span>
+
+namespace Master
+{
+
+/// @brief Fingerprint of a device without any identifying advertising data
+constexpr std::uint32_t NoFingerprint = 0;
+
+/// @brief Whether a device uses an address that rotates (resolvable or non-resolvable private
+/// address). Static random addresses don't rotate.
+/// @param bda device address
+/// @param isBle BLE device?
+/// @param isPublic public address?
+/// @return true if the address may rotate
+bool IsRotatingAddress(const Mac & bda, bool isBle, bool isPublic);
+
+/// @brief Fingerprint of advertising data, which stays the same when a device rotates
+/// its address.
+///
+/// Hashes the event type and the AD structures. Service and manufacturer data often carry
+/// counters or rotating identifiers, so only their UUID/company ID is used. Flags and TX power
+/// alone aren't specific enough.
+/// @param eventType advertising event type
+/// @param advData advertising data (AD structures)
+/// @return fingerprint or NoFingerprint
+std::uint32_t AdvFingerprint(esp_ble_evt_type_t eventType, std::span<const std::uint8_t> advData);
+
+}  // namespace Master
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "core/utility/mac.h"
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace Master
+{
+
+/// @brief RSSI -> distance table; indexed by (RSSI + 128)
+using DistanceLut = std::array<float, 256>;
+
+/// @brief Resolved path loss parameters of a single device/scanner.
+/// Cheap to copy; the table is owned by @ref CalibrationStore.
+struct Calibration
+{
+	std::int8_t RefPathLoss;           ///< Reference path loss at 1m
+	float EnvFactor;                   ///< Environment factor
+	const DistanceLut * Lut{nullptr};  ///< Precomputed distances (or nullptr if not available)
+
+	/// @brief Convert RSSI to distance
+	/// @param rssi RSSI
+	/// @return distance
+	float Distance(std::int8_t rssi) const;
+};
+
+/// @brief Resolves calibration values (NVS or the defaults) and keeps RSSI -> distance
+/// tables for them. Devices/scanners with the same parameters share a single table.
+///
+/// Resolving reads NVS (through Nvs::Cache) - call it only when a device/scanner gets added
+/// or its calibration changes; never in the position calculation loop.
+class CalibrationStore
+{
+public:
+	/// @brief Constructor
+	/// @param defaultRefPathLoss default reference path loss
+	/// @param defaultEnvFactor default environment factor
+	CalibrationStore(std::int8_t defaultRefPathLoss, float defaultEnvFactor);
+
+	/// @brief Resolve calibration for a device/scanner
+	/// @param mac address
+	/// @return calibration
+	Calibration Resolve(const Mac & mac);
+
+	/// @brief Maximum amount of distinct tables. Parameters beyond this limit
+	/// are calculated without a table.
+	static constexpr std::size_t MaxLuts = 8;
+
+private:
+	/// @brief Table with its parameters
+	struct LutEntry
+	{
+		std::int8_t RefPathLoss;
+		float EnvFactor;
+		DistanceLut Distances;
+	};
+
+	std::int8_t _defaultRefPathLoss;
+	float _defaultEnvFactor;
+
+	/// @brief Reserved to `MaxLuts`, so the pointers never get invalidated
+	std::vector<LutEntry> _luts;
+
+	/// @brief Find or create a table for the parameters
+	/// @param refPathLoss reference path loss
+	/// @param envFactor environment factor
+	/// @return table or nullptr, if the limit was reached
+	const DistanceLut * _GetLut(std::int8_t refPathLoss, float envFactor);
+};
+
+}  // namespace Master
@@ -1,12 +1,19 @@
 #pragma once
 
 #include "core/device_data.h"
+#include "core/utility/hash_index.h"
+#include "core/utility/lru_index.h"
 #include "core/utility/mac.h"
 #include "core/utility/uuid.h"
 #include "core/wrapper/device.h"
 #include "master/master_cfg.h"
+#include "master/memory/calibration.h"
 #include "master/memory/device_memory_data.h"
 #include "master/memory/idevice_memory.h"
+#include "master/memory/irk_resolver.h"
+#include "master/memory/rssi_filter.h"
+#include "master/memory/scanner_link.h"
+#include "master/memory/zones.h"
 
 #include "math/matrix.h"
 
@@ -37,17 +44,22 @@ public:
 	/// Also used to add new (non-scanner) devices.
 	/// @param scanner scanner which received this information
 	/// @param device device/scanner data received from Scanner
+	/// @param stats RSSI statistics of each device; empty if the Scanner doesn't send them
 	/// @{
 	void UpdateDistance(const std::uint16_t scannerConnId,
-	                    const Core::DeviceDataView::Array & device) override;
-	void UpdateDistance(const Mac & scanner, const Core::DeviceDataView::Array & device) override;
+	                    const Core::DeviceDataView::Array & device,
+	                    std::span<const Core::RssiStats> stats) override;
+	void UpdateDistance(const Mac & scanner,
+	                    const Core::DeviceDataView::Array & device,
+	                    std::span<const Core::RssiStats> stats) override;
 	/// @}
 
-	/// @brief Tries to find a scanner, which is missing a distance information in another
-	/// scanner and therefore should start advertising. Returns only a single scanner
-	/// (since we can't update more at the same time).
-	/// @return Scanner information or InvalidScannerIdx, if no scanners are required to advertise
-	const ScannerInfo * GetScannerToAdvertise() const override;
+	/// @brief Finds a scanner, which should start advertising, so the other scanners can measure
+	/// the distance to it. Picks the scanner whose links (measured by all the other scanners)
+	/// are missing, the oldest or the most uncertain; converged links are skipped.
+	/// Scanners with the same priority take turns.
+	/// @return Scanner information or nullptr, if no scanners are required to advertise
+	const ScannerInfo * GetScannerToAdvertise() override;
 
 	/// @brief Remove scanner
 	/// @param connId connection id which this scanner uses
@@ -56,11 +68,34 @@ public:
 	/// @brief Checks whether this device is an already connected scanner
 	/// @param bda address
 	/// @return true if device is a currently connected scanner
-	bool IsConnectedScanner(const Bt::Device & dev) const;
+	bool IsConnectedScanner(const Bt::ScanResultView & dev) const;
 
 	/// @brief Serializes the output
-	/// @return span; valid until the next call of this method
-	std::span<std::uint8_t> SerializeOutput();
+	/// @param[out] output destination; resized to the size of the serialized data
+	/// @return false if scanner positions weren't calculated yet
+	bool SerializeOutput(std::vector<std::uint8_t> & output) override;
+
+	/// @brief Copy the position history of a device
+	/// @param mac device address
+	/// @param[out] snapshot destination
+	/// @return false if the device isn't stored
+	bool GetHistory(const Mac & mac, Trajectory::Snapshot & snapshot) override;
+
+	/// @brief Add/replace or remove a zone. Devices in the changed zone leave it.
+	/// @param id zone id
+	/// @param zone zone or nullopt to remove it
+	void SetZone(std::uint8_t id, const std::optional<Zone> & zone) override;
+
+	/// @brief Serializes zone enter/exit events
+	/// @param[out] output destination; resized to the size of the serialized data
+	/// @return false if there aren't any new events (output is left unchanged)
+	bool SerializeZoneEvents(std::vector<std::uint8_t> & output) override;
+
+	/// @brief Add/replace or remove an identity resolving key. Devices already stored under
+	/// their private addresses keep them until they expire.
+	/// @param id key id
+	/// @param irk key or nullopt to remove it
+	void SetIrk(std::uint8_t id, const std::optional<Irk> & irk) override;
 
 	/// @brief Reset Scanner positions
 	void ResetScannerPositions();
@@ -74,8 +109,21 @@ public:
 	/// @param fn function to call on each scanner
 	void VisitScanners(const std::function<void(const ScannerInfo &)> & fn) override;
 
-	/// @brief Device limit.
-	static constexpr std::size_t MaximumDevices = 80;
+	/// @brief Resolve calibration of a device/scanner again
+	/// @param mac device/scanner address
+	void UpdateCalibration(const Mac & mac) override;
+
+	/// @brief Count of measurements removed for being older than `MeasurementFreshness`.
+	/// @return count since start
+	std::size_t ExpiredMeasurements() const { return _expiredMeasurements; }
+
+	/// @brief Count of new addresses linked to an existing device.
+	/// @return count since start
+	std::size_t AssociatedAddresses() const { return _associatedAddresses; }
+
+	/// @brief A scanner clock offset follows a larger delay (clock drift) by at most 1 ms per
+	/// this period [ms] - 200 ppm, above the drift of 2 crystals; independent of the payload rate
+	static constexpr std::int64_t ClockDriftPeriod = 5'000;
 
 private:
 	/// @brief Configuration
@@ -83,25 +131,63 @@ private:
 
 	/// @brief RSSIs before being converted to distances - NxN symmetric matrix.
 	Math::Matrix<std::int8_t> _scannerRssis;
+	/// @brief RSSI filter states for `_scannerRssis` - NxN matrix.
+	Math::Matrix<RssiFilter> _scannerRssiFilters;
+	/// @brief Scanner link statistics (receiving scanner, advertising scanner) - NxN matrix.
+	Math::Matrix<ScannerLink> _scannerLinks;
 	/// @brief Scanner distances - NxN symmetric matrix.
 	Math::Matrix<float> _scannerDistances;
 	/// @brief Resolved scanner positions
 	Math::Matrix<float> _scannerPositions;
 	bool _scannerPositionsSet = false;
 
+	/// @brief First scanner checked by `GetScannerToAdvertise`
+	std::size_t _advertiseCursor{0};
+
 	/// @brief Used as an initial guess for devices
 	std::array<float, 3> _scannerCenter{0.0};
 
+	/// @brief Calibration of scanners and devices
+	CalibrationStore _calibration;
+
 	/// @brief Connected scanners and devices.
+	/// Device slots are reserved at once in `DeviceTableRegion` (possibly PSRAM).
 	/// @{
 	std::vector<ScannerDetail> _scanners;
-	std::vector<DeviceMeasurements> _devices;
-	using ScannerIt = std::vector<ScannerDetail>::iterator;
-	using DeviceIt = std::vector<DeviceMeasurements>::iterator;
+	std::vector<DeviceMeasurements, Core::CapsAllocator<DeviceMeasurements>> _devices;
+	using ScannerIt = decltype(_scanners)::iterator;
+	using DeviceIt = decltype(_devices)::iterator;
+	/// @}
+
+	/// @brief Used device slots in `_devices`, ordered by their last update.
+	/// Slots which aren't in this index are free and their contents are undefined.
+	Core::LruIndex _deviceIndex;
+
+	/// @brief Address of the device in each slot. Always in internal RAM, so the lookup
+	/// doesn't have to touch the device table.
+	std::vector<Mac, Core::CapsAllocator<Mac>> _deviceMacs;
+
+	/// @brief Advertising data fingerprint of the device in each slot (@ref AdvFingerprint);
+	/// only for rotating addresses. Internal RAM.
+	std::vector<std::uint32_t, Core::CapsAllocator<std::uint32_t>> _deviceFingerprints;
+
+	/// @brief Used device slots by address / by fingerprint (only rotating addresses)
+	/// @{
+	Core::HashIndex _macIndex;
+	Core::HashIndex _fingerprintIndex;
 	/// @}
 
-	/// @brief For raw data serialization
-	std::vector<std::uint8_t> _serializedData;
+	/// @brief Zones tested after each position calculation
+	ZoneEngine _zones;
+
+	/// @brief Resolves private addresses of devices with a known IRK to their identity address
+	IrkResolver _irks;
+
+	/// @brief Expired measurements counter
+	std::size_t _expiredMeasurements{0};
+
+	/// @brief Associated addresses counter
+	std::size_t _associatedAddresses{0};
 
 	/// @brief Find a scanner/device
 	/// @param mac BDA
@@ -112,19 +198,53 @@ private:
 	/// @}
 
 	/// @brief Add new device with maximum size checking.
+	/// If the memory is full, the least recently updated device gets replaced.
 	/// @param device new device data
 	void _AddDevice(DeviceMeasurements device);
 
+	/// @brief Link a new rotating address to an existing device with the same advertising data.
+	/// Fails if more than one device matches, or if the matching device was measured by any
+	/// scanner within `AssociationGap` of the new address (2 devices with the same
+	/// advertising data).
+	/// @param view new address data
+	/// @param time time of the measurement (Master clock)
+	/// @return device, which now uses the new address; or end
+	DeviceIt _AssociateDevice(const Core::DeviceDataView & view, const Core::TimePoint & time);
+
+	/// @brief Remove device and free its slot
+	/// @param devIt device
+	void _RemoveDevice(DeviceIt devIt);
+
+	/// @brief MAC hash for `_macIndex`
+	static std::uint32_t _MacHash(const Mac & mac);
+
 	/// @brief Update distance information between a scanner and devices/scanners
 	/// @param sIt scanner
 	/// @param devices devices and/or scanners
-	void _UpdateDistance(ScannerIt sIt, const Core::DeviceDataView::Array & devices);
+	/// @param stats RSSI statistics of each device; may be empty
+	void _UpdateDistance(ScannerIt sIt,
+	                     const Core::DeviceDataView::Array & devices,
+	                     std::span<const Core::RssiStats> stats);
+
+	/// @brief Update clock offset estimate of a scanner from the received records
+	/// @param sIt scanner
+	/// @param devices devices and/or scanners received from this scanner
+	/// @param now time the records were received
+	void _UpdateClockOffset(ScannerIt sIt,
+	                        const Core::DeviceDataView::Array & devices,
+	                        const Core::TimePoint & now);
 
 	/// @brief Update distance information to a device
 	/// @param sIt scanner
 	/// @param devIt device
 	/// @param rssi distance
-	void _UpdateDevice(ScannerIt sIt, DeviceIt devIt, std::int8_t rssi);
+	/// @param time time of the measurement (Master clock)
+	/// @param confidence confidence of the RSSI
+	void _UpdateDevice(ScannerIt sIt,
+	                   DeviceIt devIt,
+	                   std::int8_t rssi,
+	                   const Core::TimePoint & time,
+	                   float confidence);
 
 	/// @brief Update distance information between 2 scanners
 	/// @param sIt1 first scanner
@@ -132,6 +252,10 @@ private:
 	/// @param rssi distance
 	void _UpdateScanner(ScannerIt sIt1, ScannerIt sIt2, std::int8_t rssi);
 
+	/// @brief Recalculate the distances measured by a scanner after its calibration changed
+	/// @param sIdx scanner index
+	void _UpdateScannerDistances(std::size_t sIdx);
+
 	/// @brief Update and get the scanner positions.
 	/// @return scanner positions or nullptr, if positions cannot be calculated
 	/// (not enough data)
@@ -145,7 +269,12 @@ private:
 	/// @brief Remove measurements; called after a scanner disconnects.
 	void _ResetDeviceMeasurements();
 
-	/// @brief Remove old devices.
+	/// @brief Remove measurements older than `MeasurementFreshness`
+	/// @param device device
+	/// @param now current time
+	void _RemoveExpiredMeasurements(DeviceMeasurements & device, const Core::TimePoint & now);
+
+	/// @brief Remove old devices. Only walks the expired devices from the end of the LRU index.
 	void _RemoveStaleDevices();
 
 	/// @brief Update center of the scanners.
@@ -1,15 +1,23 @@
 #pragma once
 
 #include "core/clock.h"
+#include "core/compact_records.h"
 #include "core/device_data.h"
+#include "core/rssi_stats.h"
+#include "core/utility/caps_allocator.h"
 #include "core/utility/mac.h"
 #include "core/wrapper/device.h"
+#include "master/memory/calibration.h"
+#include "master/memory/rssi_filter.h"
+#include "master/memory/trajectory.h"
+#include "master/memory/zones.h"
 
 #include <esp_gatt_defs.h>
 
 #include <array>
 #include <cstdint>
 #include <span>
+#include <vector>
 
 namespace Master
 {
@@ -24,12 +32,33 @@ struct ScannerInfo
 		std::uint16_t EndHandle{ESP_GATT_INVALID_HANDLE};      ///< Service end handle
 		std::uint16_t StateChar{ESP_GATT_INVALID_HANDLE};      ///< 'State' char. handle
 		std::uint16_t DevicesChar{ESP_GATT_INVALID_HANDLE};    ///< 'Devices' char. handle
+		std::uint16_t DevicesCccd{ESP_GATT_INVALID_HANDLE};    ///< 'Devices' CCCD handle
 		std::uint16_t TimestampChar{ESP_GATT_INVALID_HANDLE};  ///< 'Timestamp' char. handle
+		std::uint16_t ScanChar{ESP_GATT_INVALID_HANDLE};       ///< 'Scan' char. handle (optional)
+		std::uint16_t FilterChar{ESP_GATT_INVALID_HANDLE};     ///< 'Filter' char. handle (optional)
 	};
 
 	std::uint16_t ConnId;  ///< Connection id
 	Mac Bda;               ///< Bluetooth device address
 	ServiceInfo Service;   ///< Service info
+
+	/// @brief Negotiated ATT MTU
+	std::uint16_t Mtu{ESP_GATT_DEF_BLE_MTU_SIZE};
+
+	/// @brief Subscribed to 'Devices' notifications/indications with an MTU, which fits
+	/// them; not read periodically anymore (BT callbacks only)
+	bool Streaming{false};
+
+	/// @brief Expected sequence number of the next notification/indication
+	std::uint16_t NextSeq{0};
+
+	/// @brief Format of the 'Devices' payloads (@ref Core::Compact version); switched
+	/// once the Scanner confirms it
+	std::uint8_t Format{Core::Compact::LegacyVersion};
+
+	/// @brief 'Devices' reads return framed batches (@ref Core::Frames); enabled together
+	/// with the format
+	bool Framed{false};
 };
 
 /// @brief Internal scanner info for DeviceMemory
@@ -37,14 +66,22 @@ struct ScannerDetail
 {
 	/// @brief Constructor
 	/// @param info scanner info
-	ScannerDetail(const ScannerInfo & info);
+	/// @param calibration resolved calibration
+	ScannerDetail(const ScannerInfo & info, const Calibration & calibration);
 
 	ScannerInfo Info;            ///< Info
 	Core::TimePoint LastUpdate;  ///< Time of the last update
+	Calibration Calib;           ///< Path loss calibration
 
 	/// @brief How many other scanners' measurements were used to approximate this
 	/// scanner's position
 	std::uint8_t UsedMeasurements{0};
+
+	/// @brief Difference between the Master and this Scanner's clock [ms].
+	/// Estimated from the newest record timestamp of each received payload.
+	std::int64_t ClockOffset{0};
+	bool ClockOffsetSet{false};       ///< Whether `ClockOffset` was estimated yet
+	Core::TimePoint ClockOffsetTime;  ///< Time up to which the drift was followed
 };
 
 /// @brief Measurement data for a device
@@ -53,11 +90,35 @@ struct MeasurementData
 	/// @brief Constructor
 	/// @param scannerIdx index of the scanner which created this measurement
 	/// @param rssi RSSI
-	MeasurementData(std::size_t scannerIdx, std::int8_t rssi);
+	/// @param time time of the measurement (Master clock)
+	/// @param filterCfg RSSI filter configuration
+	/// @param confidence confidence of the RSSI
+	MeasurementData(std::size_t scannerIdx,
+	                std::int8_t rssi,
+	                const Core::TimePoint & time,
+	                const RssiFilterConfig & filterCfg,
+	                float confidence);
+
+	/// @brief Add a new RSSI sample
+	/// @param rssi RSSI
+	/// @param time time of the measurement (Master clock)
+	/// @param filterCfg RSSI filter configuration
+	/// @param confidence confidence of the RSSI
+	void Update(std::int8_t rssi,
+	            const Core::TimePoint & time,
+	            const RssiFilterConfig & filterCfg,
+	            float confidence);
+
+	/// @brief Confidence of an RSSI sent by a Scanner, from the variance of its mean
+	/// @param stats RSSI statistics of the sample; nullptr if the Scanner doesn't send them
+	/// @return confidence (0, 1]
+	static float RssiConfidence(const Core::RssiStats * stats);
 
 	std::size_t ScannerIdx;      ///< Scanner index which owns this measurement
-	std::int8_t Rssi;            ///< RSSI
-	Core::TimePoint LastUpdate;  ///< Last measurement update
+	std::int8_t Rssi;            ///< Filtered RSSI
+	Core::TimePoint LastUpdate;  ///< Time of the last measurement (Master clock)
+	RssiFilter Filter;           ///< RSSI filter state
+	float Confidence;            ///< Confidence of the last RSSI; position solver weight
 };
 
 /// @brief Device info. Similar to `DeviceData`; but without the RSSI
@@ -79,15 +140,37 @@ struct DeviceMeasurements
 	/// @brief Constructor
 	/// @param data view
 	/// @param firstMeasurement first measurement
-	DeviceMeasurements(const Core::DeviceDataView & data, const MeasurementData & firstMeasurement);
+	/// @param calibration resolved calibration
+	/// @param historyLength length of the position history
+	/// @param allocator allocator for the measurements and the history
+	DeviceMeasurements(const Core::DeviceDataView & data,
+	                   const MeasurementData & firstMeasurement,
+	                   const Calibration & calibration,
+	                   std::size_t historyLength,
+	                   const Core::CapsAllocator<MeasurementData> & allocator);
+
+	/// @brief Measurements; allocated in the same region as the device table
+	using MeasurementVector = std::vector<MeasurementData, Core::CapsAllocator<MeasurementData>>;
 
 	DeviceInfo Info;                    ///< Device info
-	std::vector<MeasurementData> Data;  ///< Measurements from scanners
+	MeasurementVector Data;             ///< Measurements from scanners
 	std::array<float, 3> Position;      ///< Resolved position (possibly invalid)
 	Core::TimePoint LastUpdate;         ///< Last time a measurement was received
+	std::uint8_t UsedMeasurements{0};   ///< Measurements used to approximate the position
+	Calibration Calib;                  ///< Path loss calibration
+	Trajectory History;                 ///< Resolved positions over time
+	Zone::Mask Zones{0};                ///< Zones the device is in
 
 	static constexpr float InvalidPos = std::numeric_limits<float>::max();
 	inline bool IsInvalidPos() const { return Position[0] == InvalidPos; }
+
+	/// @brief There's no current position (not enough fresh measurements); it isn't served and
+	/// the zones keep their state until the next one
+	inline void InvalidatePos()
+	{
+		Position.fill(InvalidPos);
+		UsedMeasurements = 0;
+	}
 };
 
 /// @brief Output device data
@@ -1,12 +1,17 @@
 #pragma once
 
+#include "core/wrapper/scan_result_view.h"
 #include "master/master_cfg.h"
 #include "master/memory/device_memory_data.h"
+#include "master/memory/irk_resolver.h"
+#include "master/memory/trajectory.h"
+#include "master/memory/zones.h"
 #include "math/matrix.h"
 
 #include <cstddef>
 #include <cstdint>
 #include <functional>
+#include <optional>
 #include <span>
 #include <vector>
 
@@ -30,7 +35,7 @@ public:
 	virtual void RemoveScanner(std::uint16_t connId) = 0;
 	virtual const ScannerInfo * GetScanner(std::uint16_t connId) const = 0;
 	virtual void VisitScanners(const std::function<void(const ScannerInfo &)> & fn) = 0;
-	virtual bool IsConnectedScanner(const Bt::Device & dev) const = 0;
+	virtual bool IsConnectedScanner(const Bt::ScanResultView & dev) const = 0;
 	virtual void ResetScannerPositions(){};
 	/// @}
 
@@ -38,22 +43,51 @@ public:
 	/// scanner and therefore should start advertising. Returns only a single scanner
 	/// (since we can't update more at the same time).
 	/// @return Scanner information or InvalidScannerIdx, if no scanners are required to advertise
-	virtual const ScannerInfo * GetScannerToAdvertise() const { return nullptr; };
+	virtual const ScannerInfo * GetScannerToAdvertise() { return nullptr; }
 
 	/// @brief Update distance information between a scanner and a device/scanner.
 	/// Also used to add new (non-scanner) devices.
 	/// @param scanner scanner which received this information
 	/// @param device device/scanner data received from Scanner
+	/// @param stats RSSI statistics of each device; empty if the Scanner doesn't send them
 	/// @{
 	virtual void UpdateDistance(const std::uint16_t scannerConnId,
-	                            const Core::DeviceDataView::Array & device) = 0;
+	                            const Core::DeviceDataView::Array & device,
+	                            std::span<const Core::RssiStats> stats) = 0;
 	virtual void UpdateDistance(const Mac & scanner,
-	                            const Core::DeviceDataView::Array & device) = 0;
+	                            const Core::DeviceDataView::Array & device,
+	                            std::span<const Core::RssiStats> stats) = 0;
 	/// @}
 
+	/// @brief Calibration (path loss values) of a device/scanner changed
+	/// @param mac device/scanner address
+	virtual void UpdateCalibration(const Mac & mac) {}
+
 	/// @brief Serializes the output
-	/// @return span; valid until the next call of this method
-	virtual std::span<std::uint8_t> SerializeOutput() = 0;
+	/// @param[out] output destination; resized to the size of the serialized data
+	/// @return false if there's nothing to serialize yet (output is left unchanged)
+	virtual bool SerializeOutput(std::vector<std::uint8_t> & output) = 0;
+
+	/// @brief Copy the position history of a device
+	/// @param mac device address
+	/// @param[out] snapshot destination
+	/// @return false if the device isn't stored or positions aren't calculated
+	virtual bool GetHistory(const Mac & mac, Trajectory::Snapshot & snapshot) { return false; }
+
+	/// @brief Add/replace or remove a zone
+	/// @param id zone id
+	/// @param zone zone or nullopt to remove it
+	virtual void SetZone(std::uint8_t id, const std::optional<Zone> & zone) {}
+
+	/// @brief Serializes zone enter/exit events
+	/// @param[out] output destination; resized to the size of the serialized data
+	/// @return false if there aren't any new events (output is left unchanged)
+	virtual bool SerializeZoneEvents(std::vector<std::uint8_t> & output) { return false; }
+
+	/// @brief Add/replace or remove an identity resolving key
+	/// @param id key id
+	/// @param irk key or nullopt to remove it
+	virtual void SetIrk(std::uint8_t id, const std::optional<Irk> & irk) {}
 
 protected:
 	AppConfig::DeviceMemoryConfig _cfg;
@@ -0,0 +1,115 @@
+#pragma once
+
+#include "core/utility/mac.h"
+
+#include <mbedtls/aes.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+
+namespace Master
+{
+
+/// @brief Identity resolving key of a device together with its identity address.
+struct Irk
+{
+	/// @brief Maximum stored keys
+	static constexpr std::size_t MaxIrks = 16;
+
+	/// @brief Key size [B]
+	static constexpr std::size_t KeySize = 16;
+
+	/// @brief Key (the most significant byte first, as displayed by most tools)
+	using Key = std::array<std::uint8_t, KeySize>;
+
+	/// @brief Definition format: [6B identity address][16B IRK (MSB first)]
+	static constexpr std::size_t Size = 22;
+
+	/// @brief Parse a definition
+	/// @param data definition
+	/// @return key or nullopt, if the definition is invalid (too short or all-zero key)
+	static std::optional<Irk> Parse(std::span<const std::uint8_t> data);
+
+	Mac Identity;  ///< Identity address; resolved devices are stored under this address
+	Key Value;     ///< Identity resolving key
+};
+
+/// @brief Whether an address is a resolvable private address (two most significant bits 0b01)
+/// @param bda device address
+/// @param isBle BLE device?
+/// @param isPublic public address?
+/// @return true if it's a resolvable private address
+bool IsResolvableAddress(const Mac & bda, bool isBle, bool isPublic);
+
+/// @brief Resolves resolvable private addresses (RPA) to identity addresses using stored IRKs.
+///
+/// Resolution needs an AES-128 encryption per stored key, so results (including failed
+/// resolutions) are kept in a small direct-mapped cache. The hash part of an RPA is an AES
+/// output, so its low bits index the cache well.
+class IrkResolver
+{
+public:
+	/// @brief Cache entries
+	static constexpr std::size_t CacheSize = 64;
+
+	IrkResolver();
+	~IrkResolver();
+	IrkResolver(const IrkResolver &) = delete;
+	IrkResolver & operator=(const IrkResolver &) = delete;
+
+	/// @brief Add/replace or remove a key. Clears the cache.
+	/// @param id key id (< MaxIrks)
+	/// @param irk key or nullopt to remove it
+	void SetIrk(std::uint8_t id, const std::optional<Irk> & irk);
+
+	/// @brief Resolve an address
+	/// @param bda device address
+	/// @param isBle BLE device?
+	/// @param isPublic public address?
+	/// @return identity address or nullopt, if the address isn't an RPA of any stored key
+	std::optional<Mac> Resolve(const Mac & bda, bool isBle, bool isPublic);
+
+	/// @brief Whether an address is the identity address of a stored key
+	/// @param bda device address
+	/// @return true if it's an identity address
+	bool IsIdentity(const Mac & bda) const;
+
+	/// @brief Random address hash function ah() (Core spec Vol 3, Part H, 2.2.2)
+	/// @param aes AES context with the IRK set as the encryption key
+	/// @param prand 24-bit prand (MSB first)
+	/// @return 24-bit hash (MSB first)
+	static std::array<std::uint8_t, 3> Ah(mbedtls_aes_context & aes,
+	                                      std::span<const std::uint8_t, 3> prand);
+
+	/// @brief AES computations since start
+	std::size_t Computations() const { return _computations; }
+
+private:
+	/// @brief Cached resolution
+	struct CacheEntry
+	{
+		static constexpr std::uint8_t Empty = 0xFE;    ///< Unused entry
+		static constexpr std::uint8_t NoMatch = 0xFF;  ///< None of the keys matched
+
+		Mac Rpa;                 ///< Resolvable private address
+		std::uint8_t Id{Empty};  ///< Key id or Empty/NoMatch
+	};
+
+	std::array<Mac, Irk::MaxIrks> _identities;          ///< Identity addresses by key id
+	std::array<mbedtls_aes_context, Irk::MaxIrks> _aes;  ///< Expanded keys by key id
+	std::uint16_t _used{0};                              ///< Valid keys (bit N - key id N)
+	static_assert(Irk::MaxIrks <= 16);
+
+	std::array<CacheEntry, CacheSize> _cache;
+	std::size_t _computations{0};  ///< AES computations counter
+
+	/// @brief Try all keys
+	/// @param rpa resolvable private address
+	/// @return key id or NoMatch
+	std::uint8_t _Resolve(const Mac & rpa);
+};
+
+}  // namespace Master
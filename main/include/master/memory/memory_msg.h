@@ -0,0 +1,134 @@
+#pragma once
+
+#include "core/scan_schedule.h"
+#include "core/utility/mac.h"
+#include "master/memory/device_memory_data.h"
+#include "master/memory/trajectory.h"
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <type_traits>
+#include <variant>
+
+/// @brief Messages for the memory owner task. Sent through a FreeRTOS queue, which copies
+/// them byte by byte - they have to stay trivially copyable.
+namespace Master::Msg
+{
+
+/// @brief GATT Read payloads were queued
+struct Payloads
+{
+};
+
+/// @brief Scanner connected and its characteristics were found
+struct AddScanner
+{
+	ScannerInfo Info;  ///< Scanner info
+};
+
+/// @brief Scanner streams its devices; stop reading it
+struct StartStreaming
+{
+	std::uint16_t ConnId;  ///< Connection id
+};
+
+/// @brief Scanner disconnected
+struct RemoveScanner
+{
+	std::uint16_t ConnId;  ///< Connection id
+};
+
+/// @brief Set calibration (path loss values) of a device/scanner; stored in NVS
+struct UpdateCalibration
+{
+	Mac Addr;                                ///< Device/scanner address
+	std::optional<std::int8_t> RefPathLoss;  ///< New reference path loss, if changed
+	std::optional<float> EnvFactor;          ///< New environment factor, if changed
+};
+
+/// @brief Set the name of a device/scanner; stored in NVS
+struct SetMacName
+{
+	static constexpr std::size_t MaxLength = 16;
+
+	Mac Addr;                          ///< Device/scanner address
+	std::array<char, MaxLength> Name;  ///< Name (not terminated)
+	std::uint8_t Length;               ///< Name length
+};
+
+/// @brief Reset calculated scanner positions
+struct ResetScanners
+{
+};
+
+/// @brief Switch a scanner to the advertising state
+struct ForceAdvertise
+{
+	Mac Addr;  ///< Scanner address
+};
+
+/// @brief Zone definition changed (in NVS)
+struct UpdateZone
+{
+	std::uint8_t Id;  ///< Zone id
+};
+
+/// @brief Identity resolving key changed (in NVS)
+struct UpdateIrk
+{
+	std::uint8_t Id;  ///< Key id
+};
+
+/// @brief Scanner filter rules changed in NVS; push them to all scanners
+struct UpdateFilterRules
+{
+};
+
+/// @brief Override the scan schedule of a scanner
+struct SetScanSchedule
+{
+	Mac Addr;                                                  ///< Scanner address
+	std::array<std::uint8_t, Core::ScanSchedule::Size> Value;  ///< 'Scan' value
+};
+
+/// @brief Request the position history of a device. Answered with `HistoryReply`.
+struct GetHistory
+{
+	Mac Addr;           ///< Device address
+	std::uint32_t Seq;  ///< Request sequence number; copied to the reply
+};
+
+/// @brief Reply to `GetHistory`. Sent through a separate queue.
+struct HistoryReply
+{
+	std::uint32_t Seq;             ///< Sequence number of the request
+	bool Found;                    ///< Whether the device was found
+	Trajectory::Snapshot History;  ///< Position history
+};
+
+static_assert(std::is_trivially_copyable_v<HistoryReply>, "HistoryReply is copied by a queue");
+
+}  // namespace Master::Msg
+
+namespace Master
+{
+
+/// @brief Any message for the memory owner task
+using MemoryMsg = std::variant<Msg::Payloads,
+                               Msg::AddScanner,
+                               Msg::RemoveScanner,
+                               Msg::UpdateCalibration,
+                               Msg::ResetScanners,
+                               Msg::ForceAdvertise,
+                               Msg::GetHistory,
+                               Msg::UpdateZone,
+                               Msg::UpdateIrk,
+                               Msg::SetScanSchedule,
+                               Msg::UpdateFilterRules,
+                               Msg::StartStreaming,
+                               Msg::SetMacName>;
+
+static_assert(std::is_trivially_copyable_v<MemoryMsg>, "MemoryMsg is copied by a FreeRTOS queue");
+
+}  // namespace Master
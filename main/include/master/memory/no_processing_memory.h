@@ -1,6 +1,8 @@
 #pragma once
 
 #include "core/clock.h"
+#include "core/utility/hash_index.h"
+#include "core/utility/lru_index.h"
 #include "master/master_cfg.h"
 #include "master/memory/device_memory_data.h"
 #include "master/memory/idevice_memory.h"
@@ -13,7 +15,7 @@ namespace
 {
 constexpr std::size_t GetSerializedDataSize(std::size_t measurements, std::size_t scanners)
 {
-	return (measurements * (71 + 5 * scanners)) + (scanners * 6) + 6;
+	return (measurements * (71 + 5 * scanners)) + (scanners * 6) + 7;
 }
 }  // namespace
 
@@ -33,15 +35,18 @@ public:
 	void RemoveScanner(std::uint16_t connId) override;
 	const ScannerInfo * GetScanner(std::uint16_t connId) const override;
 	void VisitScanners(const std::function<void(const ScannerInfo &)> & fn) override;
-	bool IsConnectedScanner(const Bt::Device & dev) const override;
+	bool IsConnectedScanner(const Bt::ScanResultView & dev) const override;
 	void UpdateDistance(const std::uint16_t scannerConnId,
-	                    const Core::DeviceDataView::Array & devices) override;
-	void UpdateDistance(const Mac & scanner, const Core::DeviceDataView::Array & devices) override;
+	                    const Core::DeviceDataView::Array & devices,
+	                    std::span<const Core::RssiStats> stats) override;
+	void UpdateDistance(const Mac & scanner,
+	                    const Core::DeviceDataView::Array & devices,
+	                    std::span<const Core::RssiStats> stats) override;
 	/// @}
 
 	/// @brief Serialize output:
-	///     1B               1B
-	/// [Scanner count(N)][Measurement count(M)][Scanners][Measurements]
+	///     4B            1B                 2B
+	/// [Timestamp][Scanner count(N)][Measurement count(M)][Scanners][Measurements]
 	///
 	/// Scanners(N):
 	///  6B
@@ -50,21 +55,15 @@ public:
 	/// Measurements(M):
 	///  6B       N*5B            1B   1B     1B       62B =  71+5*N
 	/// [MAC][(Timepoint,RSSI)][Flag][Len][EvtType][AdvData]
-	/// @return
-	std::span<std::uint8_t> SerializeOutput() override;
-
-	/// @brief Last N measurements saved.
-	static constexpr std::size_t MaximumMeasurements = 64;
+	/// @param[out] output destination; resized to the size of the serialized data (only as
+	/// large as the stored measurements, not `MaxDevices`)
+	/// @return true
+	bool SerializeOutput(std::vector<std::uint8_t> & output) override;
 
 	/// @brief Maximum scanners
 	constexpr static std::size_t MaxScanners = 10;
 
-	/// @brief Maximum size of the output data.
-	constexpr static std::size_t MaxSerializedDataSize =
-	    GetSerializedDataSize(MaximumMeasurements, 10);
-
 private:
-	std::vector<std::uint8_t> _serializedData;
 	std::vector<ScannerInfo> _scanners;
 
 	/// @brief Device measurements
@@ -89,7 +88,19 @@ private:
 		Core::TimePoint LastUpdate{};      ///< Last update of last measurement
 	};
 
-	std::array<NoProcDeviceMeasurements, MaximumMeasurements> _measurements;
+	/// @brief Last `MaxDevices` measurements; allocated in `DeviceTableRegion` (possibly PSRAM)
+	std::vector<NoProcDeviceMeasurements, Core::CapsAllocator<NoProcDeviceMeasurements>>
+	    _measurements;
+
+	/// @brief Used slots in `_measurements`, ordered by their last update
+	Core::LruIndex _measurementIndex;
+
+	/// @brief Address of the device in each slot. Always in internal RAM, so the lookup
+	/// doesn't have to touch the measurement table.
+	std::vector<Mac, Core::CapsAllocator<Mac>> _measurementMacs;
+
+	/// @brief Used slots by device MAC
+	Core::HashIndex _macIndex;
 
 	using ScannerIt = decltype(_scanners)::iterator;
 	using MeasurementIt = decltype(_measurements)::iterator;
@@ -98,6 +109,13 @@ private:
 
 	ScannerIt _FindScanner(const Mac & mac);
 	MeasurementIt _FindMeasurement(const Mac & mac);
+
+	/// @brief Free a used slot
+	/// @param mIdx slot
+	void _ReleaseMeasurement(Core::LruIndex::Index mIdx);
+
+	/// @brief MAC hash for `_macIndex`
+	static std::uint32_t _MacHash(const Mac & mac);
 };
 
 }  // namespace Master
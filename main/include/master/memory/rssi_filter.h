@@ -0,0 +1,78 @@
+#pragma once
+
+#include "master/master_cfg.h"
+
+#include <array>
+#include <cstdint>
+
+namespace Master
+{
+
+using RssiFilterConfig = AppConfig::DeviceMemoryConfig::RssiFilterConfig;
+
+/// @brief RSSI filter state of a single measurement.
+///
+/// The filter type is global (@ref RssiFilterConfig), so only the state of the used
+/// filter is stored. All of them share the same memory.
+class RssiFilter
+{
+public:
+	/// @brief Samples used by the median filter
+	static constexpr std::size_t MedianWindow = 5;
+
+	/// @brief Add a new sample
+	/// @param cfg filter configuration; should not change between the calls
+	/// @param rssi new sample
+	/// @return filtered RSSI
+	std::int8_t Update(const RssiFilterConfig & cfg, std::int8_t rssi);
+
+	/// @brief Last filtered value
+	/// @return filtered RSSI or 0, if no samples were added yet
+	std::int8_t Value() const { return _value; }
+
+	/// @brief Drop all samples
+	void Reset();
+
+private:
+	/// @brief Exponential moving average; Q8.8 fixed point
+	struct EmaState
+	{
+		std::int16_t Value;
+	};
+
+	/// @brief Sliding median
+	struct MedianState
+	{
+		std::array<std::int8_t, MedianWindow> Samples;
+		std::uint8_t Head;  ///< Next sample index
+	};
+
+	/// @brief 1D Kalman filter
+	struct KalmanState
+	{
+		float Estimate;  ///< RSSI estimate
+		float Variance;  ///< Estimate variance
+	};
+
+	union
+	{
+		EmaState Ema;
+		MedianState Median;
+		KalmanState Kalman;
+	} _state{};
+
+	std::int8_t _value{0};     ///< Last filtered value
+	std::uint8_t _samples{0};  ///< Samples added so far (saturated)
+
+	/// @brief Filter implementations
+	/// @param cfg configuration
+	/// @param rssi new sample
+	/// @return filtered value
+	/// @{
+	std::int8_t _UpdateEma(const RssiFilterConfig & cfg, std::int8_t rssi);
+	std::int8_t _UpdateMedian(std::int8_t rssi);
+	std::int8_t _UpdateKalman(const RssiFilterConfig & cfg, std::int8_t rssi);
+	/// @}
+};
+
+}  // namespace Master
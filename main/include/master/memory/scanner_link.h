@@ -0,0 +1,58 @@
+#pragma once
+
+#include "core/clock.h"
+#include "master/master_cfg.h"
+
+#include <cstdint>
+
+namespace Master
+{
+
+using ScannerLinkConfig = AppConfig::DeviceMemoryConfig::ScannerLinkConfig;
+
+/// @brief Statistics of RSSI measurements between 2 scanners (one of them advertising, the other
+/// one receiving). Used to decide which scanner should advertise next.
+class ScannerLink
+{
+public:
+	/// @brief Priority of a link which was never measured
+	static constexpr float MissingPriority = 1'000.0f;
+
+	/// @brief Add a new (raw) sample
+	/// @param rssi RSSI
+	/// @param time time of the measurement
+	void Update(std::int8_t rssi, const Core::TimePoint & time);
+
+	/// @brief The advertising scanner of the link was chosen; until a sample arrives, every
+	/// such round halves the priority, so an unreachable link doesn't starve the others
+	void Attempt();
+
+	/// @brief How much a new measurement is needed. Grows with the age of the last measurement
+	/// and with the RSSI variance.
+	/// @param cfg configuration
+	/// @param now current time
+	/// @return priority; 0 if the link converged and doesn't need to be measured, decays with
+	/// the rounds without a sample
+	float Priority(const ScannerLinkConfig & cfg, const Core::TimePoint & now) const;
+
+	/// @brief Getters
+	/// @{
+	std::uint16_t Samples() const { return _samples; }
+	float Variance() const { return _variance; }
+	/// @}
+
+private:
+	/// @brief Samples are averaged over at least this many samples (1/N weight of a new sample)
+	static constexpr std::uint16_t VarianceWindow = 8;
+	/// @brief Attempts are saturated - the priority still stays above 0, so the link is retried
+	/// once the others converge
+	static constexpr std::uint8_t MaxAttempts = 16;
+
+	std::uint16_t _samples{0};    ///< Received samples (saturated)
+	std::uint8_t _attempts{0};    ///< Advertising rounds since the last sample (saturated)
+	float _mean{0};               ///< RSSI mean
+	float _variance{0};           ///< RSSI variance [dBm^2]
+	Core::TimePoint _lastUpdate;  ///< Time of the last sample
+};
+
+}  // namespace Master
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "core/clock.h"
+#include "core/utility/caps_allocator.h"
+#include "core/utility/mac.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace Master
+{
+
+/// @brief Fixed-size history of resolved positions of a single device.
+/// When full, the newest sample replaces the oldest one.
+///
+/// Samples are quantised to save RAM (8B instead of 20B per sample) - positions are stored
+/// in centimeters and times as a difference from the previous sample in 100 ms steps.
+class Trajectory
+{
+public:
+	/// @brief Maximum length of a single trajectory
+	static constexpr std::size_t MaxLength = 128;
+
+	/// @brief Time resolution of the samples
+	using TimeStep = std::chrono::duration<std::int64_t, std::deci>;
+
+	/// @brief Quantised sample
+	struct Sample
+	{
+		std::uint16_t TimeDelta;               ///< Time since the previous sample [100 ms]
+		std::array<std::int16_t, 3> Position;  ///< The (X,Y,Z) position [cm]
+	};
+	static_assert(sizeof(Sample) == 8);
+
+	/// @brief Copy of a trajectory; trivially copyable, so it can be passed through a queue.
+	struct Snapshot
+	{
+		Core::TimePoint Newest;                 ///< Time of the newest sample
+		std::uint16_t Count{0};                 ///< Valid samples
+		std::array<Sample, MaxLength> Samples;  ///< Samples (the oldest first)
+
+		/// @brief Serialize. Format (little endian):
+		/// [6B MAC][2B sample count N] N * ([8B unix timestamp (ms)][3 * 4B float position])
+		/// The oldest sample first.
+		/// @param mac device address
+		/// @param[out] output destination; resized to the size of the serialized data
+		void Serialize(const Mac & mac, std::vector<std::uint8_t> & output) const;
+
+		/// @brief Serialized sizes
+		/// @{
+		static constexpr std::size_t HeaderSize = 8;
+		static constexpr std::size_t SampleSize = 20;
+		/// @}
+	};
+
+	/// @brief Constructor
+	/// @param length maximum samples (clamped to `MaxLength`); 0 disables the history
+	/// @param allocator allocator for the samples
+	Trajectory(std::size_t length, const Core::CapsAllocator<Sample> & allocator);
+
+	/// @brief Add a new sample. Ignored, if it isn't newer than the newest stored sample.
+	/// @param time time of the position
+	/// @param position position [m]
+	void Push(const Core::TimePoint & time, std::span<const float, 3> position);
+
+	/// @brief Copy the stored samples
+	/// @param[out] snapshot destination
+	void CopyTo(Snapshot & snapshot) const;
+
+	/// @brief Stored samples
+	std::size_t Size() const { return _count; }
+
+private:
+	/// @brief Ring storage; allocated once
+	std::vector<Sample, Core::CapsAllocator<Sample>> _samples;
+	std::uint16_t _head{0};   ///< Index of the next written sample
+	std::uint16_t _count{0};  ///< Stored samples
+
+	/// @brief Time of the newest sample; quantised the same way as the stored deltas,
+	/// so the rounding errors don't accumulate
+	Core::TimePoint _newest;
+};
+
+}  // namespace Master
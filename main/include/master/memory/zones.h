@@ -0,0 +1,192 @@
+#pragma once
+
+#include "core/clock.h"
+#include "core/utility/mac.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace Master
+{
+
+/// @brief Zone (ex. a room) - a polygon in the XY plane with a height range.
+struct Zone
+{
+	/// @brief Maximum zones; a device's state is a bitmask of the zones it's in
+	static constexpr std::size_t MaxZones = 32;
+
+	/// @brief Maximum polygon vertices
+	static constexpr std::size_t MaxVertices = 16;
+
+	/// @brief Bitmask of zones (bit N - zone with id N)
+	using Mask = std::uint32_t;
+
+	/// @brief Zone definition format (native byte order - little endian):
+	/// [1B vertex count N][4B float min Z][4B float max Z] N * ([4B float X][4B float Y])
+	/// N == 2 - axis aligned box given by 2 opposite corners; N > 2 - polygon.
+	/// @{
+	static constexpr std::size_t HeaderSize = 9;
+	static constexpr std::size_t VertexSize = 8;
+	/// @}
+
+	/// @brief Parse a zone definition
+	/// @param data definition
+	/// @return zone or nullopt, if the definition is invalid (incl. non-finite values)
+	static std::optional<Zone> Parse(std::span<const std::uint8_t> data);
+
+	/// @brief Size of a zone definition
+	/// @param vertexCount vertex count
+	/// @return size [B]
+	static constexpr std::size_t DefinitionSize(std::size_t vertexCount)
+	{
+		return HeaderSize + vertexCount * VertexSize;
+	}
+
+	/// @brief Whether a point lies inside this zone
+	/// @param point (X,Y,Z) position
+	/// @return true if inside
+	bool Contains(std::span<const float, 3> point) const;
+
+	std::uint8_t VertexCount{0};                             ///< Valid vertices
+	float MinZ{0};                                           ///< Bottom
+	float MaxZ{0};                                           ///< Top
+	std::array<std::array<float, 2>, MaxVertices> Vertices;  ///< Polygon (X,Y) vertices
+	std::array<float, 2> Min;                                ///< Bounding box (X,Y) minimum
+	std::array<float, 2> Max;                                ///< Bounding box (X,Y) maximum
+};
+
+/// @brief Device entered/left a zone
+struct ZoneEvent
+{
+	enum class Type : std::uint8_t
+	{
+		Exit = 0,
+		Enter = 1
+	};
+
+	std::uint32_t Seq;        ///< Sequence number; increases by 1 with each event
+	std::uint32_t Timestamp;  ///< Unix timestamp
+	Mac Bda;                  ///< Device address
+	std::uint8_t ZoneId;      ///< Zone id
+	Type EventType;           ///< Enter/Exit
+
+	/// @brief Data indices
+	/// @{
+	constexpr static std::size_t SeqIdx = 0;
+	constexpr static std::size_t TimestampIdx = 4;
+	constexpr static std::size_t BdaIdx = 8;
+	constexpr static std::size_t ZoneIdIdx = 14;
+	constexpr static std::size_t TypeIdx = 15;
+	/// @}
+	constexpr static std::size_t Size = 16;
+
+	/// @brief Serialize
+	/// @param[out] output output destination
+	void Serialize(std::span<std::uint8_t, Size> output) const;
+};
+
+/// @brief Zones with a spatial grid index for fast lookups and a ring buffer of
+/// enter/exit events.
+///
+/// The grid covers the bounding box of all the zones. Each cell holds a mask of zones whose
+/// bounding box overlaps it, so a lookup only tests the polygons of a few zones.
+class ZoneEngine
+{
+public:
+	/// @brief Grid cells per axis
+	static constexpr std::size_t GridSize = 16;
+
+	/// @brief Constructor
+	/// @param eventCapacity maximum stored events; the oldest get replaced
+	ZoneEngine(std::size_t eventCapacity);
+
+	/// @brief Add/replace or remove a zone. Rebuilds the grid.
+	/// @param id zone id (< MaxZones)
+	/// @param zone zone or nullopt to remove it
+	void SetZone(std::uint8_t id, const std::optional<Zone> & zone);
+
+	/// @brief Whether there are any zones
+	bool Empty() const { return _used == 0; }
+
+	/// @brief Whether a zone is set
+	/// @param id zone id
+	bool Has(std::uint8_t id) const { return id < Zone::MaxZones && (_used >> id) & 1; }
+
+	/// @brief Zones containing a point
+	/// @param point (X,Y,Z) position
+	/// @return mask of zones
+	Zone::Mask Find(std::span<const float, 3> point) const;
+
+	/// @brief Test a new device position and create events for the zones it entered/left
+	/// @param bda device address
+	/// @param[in,out] state mask of zones the device is in
+	/// @param point (X,Y,Z) position
+	/// @param time time of the position
+	/// @param mask zones to test; the others keep their state
+	void Update(const Mac & bda,
+	            Zone::Mask & state,
+	            std::span<const float, 3> point,
+	            const Core::TimePoint & time,
+	            Zone::Mask mask = ~Zone::Mask(0));
+
+	/// @brief Create exit events for zones a device is in (ex. the device was removed)
+	/// @param bda device address
+	/// @param[in,out] state mask of zones the device is in; the left zones get cleared
+	/// @param mask zones to leave
+	/// @param time time of the exit
+	void Leave(const Mac & bda,
+	           Zone::Mask & state,
+	           Zone::Mask mask,
+	           const Core::TimePoint & time);
+
+	/// @brief Serialize stored events (the oldest first), if there are new ones since the last
+	/// call. Format: [Event0][Event1]... (@ref ZoneEvent)
+	/// @param[out] output destination; resized to the size of the serialized data
+	/// @return false if there weren't any new events (output is left unchanged)
+	bool SerializeEvents(std::vector<std::uint8_t> & output);
+
+	/// @brief Created events count
+	std::uint32_t EventCount() const { return _nextSeq - 1; }
+
+private:
+	std::array<Zone, Zone::MaxZones> _zones;  ///< Zones by their id
+	Zone::Mask _used{0};                      ///< Valid zones in `_zones`
+
+	/// @brief Grid over the bounding box of all zones (row-major, Y rows)
+	/// @{
+	std::array<Zone::Mask, GridSize * GridSize> _grid{};
+	std::array<float, 2> _gridMin{0, 0};
+	std::array<float, 2> _gridMax{0, 0};
+	std::array<float, 2> _cellSize{1, 1};
+	/// @}
+
+	/// @brief Event ring buffer
+	/// @{
+	std::vector<ZoneEvent> _events;
+	std::size_t _eventHead{0};        ///< Index of the next written event
+	std::size_t _eventCount{0};       ///< Stored events
+	std::uint32_t _nextSeq{1};        ///< Sequence number of the next event
+	std::uint32_t _serializedSeq{1};  ///< `_nextSeq` during the last serialization
+	/// @}
+
+	/// @brief Rebuild the grid after the zones change
+	void _RebuildGrid();
+
+	/// @brief Grid cell index of a coordinate; expects a value inside the grid
+	/// @param value coordinate
+	/// @param axis 0 - X, 1 - Y
+	/// @return index (< GridSize)
+	std::size_t _CellOf(float value, std::size_t axis) const;
+
+	/// @brief Store an event
+	void _AddEvent(const Mac & bda,
+	               std::uint8_t zoneId,
+	               ZoneEvent::Type type,
+	               const Core::TimePoint & time);
+};
+
+}  // namespace Master
@@ -5,11 +5,13 @@
 #include <queue>
 #include <span>
 #include <string>
+#include <vector>
 
 namespace Master::Nvs
 {
 
-/// @brief NVS cache for frequently queried values.
+/// @brief NVS cache for frequently queried values. Not synchronized - only used by the memory
+/// task.
 class Cache
 {
 public:
@@ -76,4 +78,25 @@ std::optional<float> GetEnvFactor(std::span<const std::uint8_t, 6> mac);
 std::optional<std::string> GetMacName(std::span<const std::uint8_t, 6> mac);
 /// @}
 
+/// @brief Setters/Getters for zone definitions (@ref Master::Zone)
+/// @{
+void SetZone(std::uint8_t id, std::span<const std::uint8_t> definition);
+void EraseZone(std::uint8_t id);
+std::optional<std::vector<std::uint8_t>> GetZone(std::uint8_t id);
+/// @}
+
+/// @brief Setters/Getters for identity resolving keys (@ref Master::Irk)
+/// @{
+void SetIrk(std::uint8_t id, std::span<const std::uint8_t> definition);
+void EraseIrk(std::uint8_t id);
+std::optional<std::vector<std::uint8_t>> GetIrk(std::uint8_t id);
+/// @}
+
+/// @brief Setters/Getters for the scanner filter rules (@ref Core::FilterRules)
+/// @{
+void SetFilterRules(std::span<const std::uint8_t> rules);
+void EraseFilterRules();
+std::optional<std::vector<std::uint8_t>> GetFilterRules();
+/// @}
+
 }  // namespace Master::Nvs
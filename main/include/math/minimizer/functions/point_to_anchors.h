@@ -16,10 +16,14 @@ public:
 	/// @param anchorMatrix cartesian positions of each of the anchors
 	/// - N rows (anchors), M columns (dimensions - 2D/3D)
 	/// @param distances distances between a point and each anchor
-	/// - 1 row, M columns (dimensions - 2D/3D)
+	/// - 1 row, M columns (dimensions - 2D/3D); anchors with zero distance are ignored
+	/// @param weights weight of each anchor's error (confidence of its distance);
+	/// all anchors have the weight 1 if empty
 	/// No copy is made - the caller should make sure the data referenced by
-	/// the span outlives this class.
-	PointToAnchors(const Math::Matrix<float> & anchorMatrix, std::span<const float> distances);
+	/// the spans outlives this class.
+	PointToAnchors(const Math::Matrix<float> & anchorMatrix,
+	               std::span<const float> distances,
+	               std::span<const float> weights = {});
 
 	/// @brief Objective function
 	/// @param point predicted value - 1 row, N columns (dimensions)
@@ -37,6 +41,12 @@ private:
 
 	/// @brief Distances - between a point and each anchor
 	std::span<const float> _distances;
+
+	/// @brief Weights of the anchors; empty if all are the same
+	std::span<const float> _weights;
+
+	/// @brief Weight of an anchor
+	float _Weight(int anchor) const { return _weights.empty() ? 1.0f : _weights[anchor]; }
 };
 
 }  // namespace Math
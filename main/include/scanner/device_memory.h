@@ -1,12 +1,17 @@
 #pragma once
 
+#include <bitset>
 #include <cstdint>
+#include <optional>
 #include <span>
 #include <vector>
 
+#include "core/compact_records.h"
 #include "core/device_data.h"
-#include "core/wrapper/device.h"
+#include "core/utility/hash_index.h"
+#include "core/utility/lru_index.h"
 #include "scanner/device_memory_data.h"
+#include "scanner/scan_record.h"
 #include "scanner/scanner_cfg.h"
 
 namespace Scanner
@@ -21,30 +26,119 @@ public:
 	DeviceMemory(const AppConfig::DeviceMemoryConfig & cfg);
 
 	/// @brief Add new device
-	/// @param device device info
-	void AddDevice(const Bt::Device & device);
+	/// @param device scan result
+	void AddDevice(const ScanRecord & device);
 
-	/// @brief Serialize data - only up to 512B. This is destructive - serialized data will be
-	/// removed.
-	/// @param[out] output output destination. Will be cleared and resized
-	void SerializeData(std::vector<std::uint8_t> & out);
+	/// @brief Serialize as many devices as fit, the oldest first, in the current format.
+	/// This is destructive - serialized data will be removed.
+	/// @param[out] out output destination; at least @ref Core::Compact::MinPayloadSize
+	/// @return written bytes; 0 if there's nothing to serialize
+	std::size_t SerializeData(std::span<std::uint8_t> out);
 
-	/// @brief Manually remove stale devices.
-	/// This method might be called during in other public methods when required,
-	/// so it isn't necessary, to be called manually.
+	/// @brief Amount of stored devices
+	std::size_t Size() const { return _index.Size(); }
+
+	/// @brief Estimated amount of distinct devices added since @ref ResetSeen. Unlike
+	/// @ref Size, it doesn't drop when devices are serialized.
+	std::size_t SeenDevices() const;
+
+	/// @brief Start counting seen devices again
+	void ResetSeen() { _seen.reset(); }
+
+	/// @brief Set the serialization format. Starts a new compact record epoch.
+	/// @param version @ref Core::Compact version
+	/// @return false if the version isn't supported
+	bool SetFormat(std::uint8_t version);
+
+	/// @brief Serialization format (@ref Core::Compact version)
+	std::uint8_t Format() const { return _format; }
+
+	/// @brief Start a new compact record epoch, if the Master lost the current one
+	/// @param epoch epoch the Master lost
+	void Resync(std::uint8_t epoch);
+
+	/// @brief Smallest serialized size of a device in the current format; for estimating how
+	/// many devices fit a payload
+	std::size_t RecordSize() const;
+
+	/// @brief Remove devices not updated for `StaleLimit`. Devices are ordered by their last
+	/// update, so this only costs O(removed devices). Should be called periodically; other
+	/// public methods only call it when required (before serializing, when full).
 	void RemoveStaleDevices();
 
 private:
+	using Index = Core::LruIndex::Index;
+
 	/// @brief Configuration
 	const AppConfig::DeviceMemoryConfig & _cfg;
 
-	/// @brief Device data
-	std::vector<DeviceInfo> _devData;
+	/// @brief Device slots; only slots used in `_index` are valid. Slots never move, so
+	/// the views into the device data stay valid.
+	std::vector<std::optional<DeviceInfo>> _devData;
+
+	/// @brief Used slots ordered by their last update (the oldest are serialized and
+	/// expired first)
+	Core::LruIndex _index;
+
+	/// @brief Slots by device MAC
+	Core::HashIndex _macIndex;
+
+	/// @brief Slots of devices which can be associated (@ref _IsAssociable), by their
+	/// advertising payload digest
+	Core::HashIndex _payloadIndex;
+
+	/// @brief Devices seen since the last @ref ResetSeen, as bits set by their MAC hash
+	/// (linear counting)
+	static constexpr std::size_t SeenBits = 512;
+	std::bitset<SeenBits> _seen;
+
+	/// @brief Serialization format (@ref Core::Compact version)
+	std::uint8_t _format{Core::Compact::LegacyVersion};
+
+	/// @brief Compact record dictionary shared with the Master
+	Core::CompactEncoder _encoder;
+
+	/// @brief Serialize in the legacy/compact format
+	/// @param[out] out output destination
+	/// @return written bytes
+	/// @{
+	std::size_t _SerializeLegacy(std::span<std::uint8_t> out);
+	std::size_t _SerializeCompact(std::span<std::uint8_t> out);
+	/// @}
+
+	/// @brief Find a device
+	/// @param bda device address
+	/// @return slot or Npos
+	Index _FindDevice(std::span<const std::uint8_t, 6> bda) const;
 
 	/// @brief Attempt to associate a device to another device
-	/// @param device device info
+	/// @param device scan result
 	/// @return true if device was associated and added to the data vector
-	bool _AssociateDevice(const Bt::Device & device);
+	bool _AssociateDevice(const ScanRecord & device);
+
+	/// @brief Store a new device in a free slot
+	/// @param device scan result
+	void _AddDevice(const ScanRecord & device);
+
+	/// @brief Remove a device and free its slot
+	/// @param idx used slot
+	void _RemoveDevice(Index idx);
+
+	/// @brief Find the device which should be replaced by a new device
+	/// @param device new device
+	/// @return slot or Npos, if the new device shouldn't replace any
+	Index _FindReplaceable(const ScanRecord & device) const;
+
+	/// @brief Whether a stored device is indexed in `_payloadIndex`
+	/// (BLE devices with a random address)
+	bool _IsAssociable(const Core::DeviceDataView & view) const;
+
+	/// @brief Hashes
+	/// @{
+	static std::uint32_t _MacHash(std::span<const std::uint8_t, 6> bda);
+	static std::uint32_t _PayloadHash(esp_ble_evt_type_t eventType,
+	                                  std::span<const std::uint8_t> advData);
+	/// @}
 };
 
 }  // namespace Scanner
@@ -5,6 +5,7 @@
 
 #include "core/clock.h"
 #include "core/device_data.h"
+#include "core/rssi_stats.h"
 
 namespace Scanner
 {
@@ -24,7 +25,7 @@ public:
 	           esp_ble_evt_type_t eventType,
 	           std::span<const std::uint8_t> data);
 
-	/// @brief Update RSSI value
+	/// @brief Add an RSSI sample
 	/// @param rssi RSSI
 	void Update(std::int8_t rssi);
 
@@ -45,29 +46,14 @@ public:
 	/// @return time point
 	const Core::TimePoint & GetLastUpdate() const;
 
-private:
-	/// @brief Average of the last `Size` values
-	class AverageWindow
-	{
-	public:
-		AverageWindow(std::int8_t value);
-
-		void Add(std::int8_t value);
-
-		std::int8_t Average() const;
-
-	public:
-		constexpr static std::uint8_t Size = 10;
-		std::array<std::int8_t, Size> Window;
-		std::uint8_t Idx{0};
-
-		static std::uint8_t _NextIdx(std::uint8_t idx);
-	};
+	/// @brief RSSI statistics of all samples
+	Core::RssiStats Stats() const { return _rssi.Stats(); }
 
+private:
 	Core::DeviceData _outData;     ///< Raw output data
 	Core::TimePoint _firstUpdate;  ///< First update
 	Core::TimePoint _lastUpdate;   ///< Last RSSI update
-	AverageWindow _rssi;           ///< Average window for rssi
+	Core::RssiAccumulator _rssi;   ///< RSSI samples
 };
 
 }  // namespace Scanner
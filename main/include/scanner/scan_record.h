@@ -0,0 +1,43 @@
+#pragma once
+
+#include "core/device_data.h"
+#include "core/utility/mac.h"
+#include "core/wrapper/scan_result_view.h"
+
+#include <array>
+#include <cstdint>
+
+namespace Scanner
+{
+
+/// @brief Compact scan result. Copied from the GAP callbacks to the worker task, so it has
+/// to stay trivially copyable; unlike `Bt::Device`, it doesn't allocate.
+struct ScanRecord
+{
+	/// @brief EIR size (advertising data + scan response)
+	static constexpr std::size_t EirSize = ESP_BLE_ADV_DATA_LEN_MAX + ESP_BLE_SCAN_RSP_DATA_LEN_MAX;
+
+	/// @brief Create from a BLE scan result or a BR/EDR discovery result. The RSSI is
+	/// the lowest possible value, if the result doesn't contain it.
+	/// @param view scan result
+	/// @return record
+	static ScanRecord From(const Bt::ScanResultView & view);
+
+	/// @brief Output flags
+	/// @return flags @ref Core::FlagMask
+	std::uint8_t Flags() const;
+
+	/// @brief Whether it's a BLE device with a public address
+	bool IsBlePublic() const { return IsBle && AddrType == BLE_ADDR_TYPE_PUBLIC; }
+
+	Mac Bda;                                ///< Device address
+	std::int8_t Rssi;                       ///< RSSI
+	bool IsBle;                             ///< BLE or BR/EDR device
+	esp_ble_addr_type_t AddrType;           ///< Address type (BLE only)
+	esp_ble_evt_type_t EvtType;             ///< Event type (BLE only)
+	std::uint8_t AdvDataLen;                ///< Advertising data length (BLE only)
+	std::uint8_t ScanRspLen;                ///< Scan response length (BLE only)
+	std::array<std::uint8_t, EirSize> Eir;  ///< Advertising data + scan response (BLE only)
+};
+
+}  // namespace Scanner
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "core/scan_schedule.h"
+#include "scanner/scanner_cfg.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+namespace Scanner
+{
+
+/// @brief Adaptive scan schedule. Tunes the BLE scan window/interval and the BLE/Classic split
+/// from the seen devices, the scan result rate and the scan queue drops, so devices get
+/// sampled at about the target rate and the radio is free the rest of the time.
+/// The Master can override it.
+class ScanScheduler
+{
+public:
+	/// @brief Observed since the last update
+	struct Observation
+	{
+		std::size_t Devices;           ///< Distinct devices seen
+		std::uint32_t BleResults;      ///< BLE scan results
+		std::uint32_t ClassicResults;  ///< Classic discovery results
+		std::uint32_t Drops;           ///< Scan results dropped by the full queue
+		std::uint32_t BleTime;         ///< Time spent scanning BLE [ms]
+		std::uint32_t ClassicTime;     ///< Time spent discovering Classic devices [ms]
+	};
+
+	/// @brief Constructor
+	/// @param cfg configuration
+	ScanScheduler(const AppConfig & cfg);
+
+	/// @brief Update the adaptive schedule
+	/// @param obs observed since the last update
+	/// @return whether the schedule in use changed
+	bool Update(const Observation & obs);
+
+	/// @brief Override the adaptive schedule (@ref Core::ScanSchedule::Mode::Fixed) or return
+	/// to it (@ref Core::ScanSchedule::Mode::Adaptive)
+	/// @param schedule schedule
+	void Override(const Core::ScanSchedule & schedule);
+
+	/// @brief Schedule in use
+	const Core::ScanSchedule & Current() const;
+
+	/// @brief Duration of a BLE scan period [s]
+	float BlePeriod() const;
+
+	/// @brief Duration of a Classic discovery period [s] (@ref ScanMode::Both)
+	float ClassicPeriod() const;
+
+private:
+	const AppConfig & _cfg;
+	Core::ScanSchedule _adaptive;                 ///< Tuned schedule
+	std::optional<Core::ScanSchedule> _override;  ///< Schedule set by the Master
+};
+
+}  // namespace Scanner
@@ -1,5 +1,8 @@
 #pragma once
 
+#include "core/task.h"
+
+#include <cstddef>
 #include <cstdint>
 
 namespace Scanner
@@ -23,9 +26,51 @@ struct AppConfig
 	std::uint16_t ScanModePeriodClassic{5};
 	std::uint16_t ScanModePeriodBle{20};
 
+	/// @brief Adaptive scan schedule (@ref ScanScheduler)
+	struct ScanScheduleConfig
+	{
+		/// @brief Tune the schedule from the observed devices; otherwise it only changes
+		/// when the Master overrides it
+		bool Adaptive{true};
+
+		/// @brief BLE scan period; the schedule is updated after each one [s]. With
+		/// ScanMode::Both, the periods are split from `ScanModePeriodBle + ScanModePeriodClassic`.
+		std::uint16_t Period{10};
+
+		/// @brief Wanted scan results per device and second
+		std::uint8_t TargetRate{2};
+
+		/// @brief Minimum BLE scan duty cycle (window / interval) [%]
+		std::uint8_t MinDuty{10};
+
+		/// @brief BLE scan interval range [ms]; the more devices, the shorter
+		/// @{
+		std::uint16_t MinInterval{100};
+		std::uint16_t MaxInterval{1'000};
+		/// @}
+
+		/// @brief Minimum share of both BLE and Classic in the scanning time
+		/// (ScanMode::Both) [%]
+		std::uint8_t MinShare{20};
+	} ScheduleCfg;
+
 	/// @brief Interval at which the 'Devices' GATT attribute gets updated.
 	std::size_t DevicesUpdateInterval{5'000};
 
+	/// @brief Maximum size of a batch read by the Master in multiple chunks (framed reads).
+	/// At most `Core::Frames::MaxBatchSize`.
+	std::size_t ReadBatchSize{2'048};
+
+	/// @brief Maximum interval between 'Devices' notifications/indications, when the Master
+	/// subscribes to them [ms]. A full payload is sent right away.
+	std::size_t StreamInterval{1'000};
+
+	/// @brief Maximum amount of scan results waiting for the worker task; more are dropped.
+	std::size_t ScanQueueDepth{32};
+
+	/// @brief Task owning the device memory (processes scan results)
+	Core::TaskConfig WorkerTaskCfg{.StackSize = 4096, .Priority = 5, .Core = 1};
+
 	struct DeviceMemoryConfig
 	{
 		/// @brief Maximum amount of devices saved in DeviceMemory
@@ -40,6 +85,9 @@ struct AppConfig
 		/// @brief Maximum interval in milliseconds, after which a device is removed if not updated
 		std::size_t StaleLimit{30'000};
 
+		/// @brief Interval of the periodic stale devices removal [ms]
+		std::size_t ExpiryInterval{1'000};
+
 		/// @brief Minimum measured RSSI to save a device.
 		std::int8_t MinRssi{-95};
 	} DeviceMemoryCfg;
@@ -1,8 +1,13 @@
 #pragma once
 
+#include <atomic>
 #include <cstdint>
+#include <optional>
 
+#include "core/batch_frames.h"
 #include "core/clock.h"
+#include "core/filter_rules.h"
+#include "core/utility/spsc_ring.h"
 #include "core/wrapper/gap_ble_wrapper.h"
 #include "core/wrapper/gap_bt_wrapper.h"
 #include "core/wrapper/gatt_attribute_table.h"
@@ -10,11 +15,15 @@
 #include "core/wrapper/interface/gap_ble_if.h"
 #include "core/wrapper/interface/gap_bt_if.h"
 #include "core/wrapper/interface/gatts_if.h"
+#include "core/wrapper/scan_result_view.h"
 
 #include "scanner/device_memory.h"
+#include "scanner/scan_record.h"
+#include "scanner/scan_scheduler.h"
 #include "scanner/scanner_cfg.h"
 
 #include <freertos/semphr.h>
+#include <freertos/timers.h>
 
 namespace Scanner::Impl
 {
@@ -27,8 +36,13 @@ enum Handle : std::size_t
 	State = 2,
 	DevicesDecl = 3,
 	Devices = 4,
-	TimestampDecl = 5,
-	Timestamp = 6
+	DevicesCccd = 5,
+	TimestampDecl = 6,
+	Timestamp = 7,
+	ScanDecl = 8,
+	Scan = 9,
+	FilterDecl = 10,
+	Filter = 11
 };
 
 /// @brief Connection status
@@ -71,8 +85,19 @@ public:
 	void GattsDisconnect(const Gatts::Type::Disconnect & p) override;
 	void GattsRead(const Gatts::Type::Read & p) override;
 	void GattsWrite(const Gatts::Type::Write & p) override;
+	void GattsMtu(const Gatts::Type::Mtu & p) override;
+	void GattsConf(const Gatts::Type::Conf & p) override;
+	void GattsCongest(const Gatts::Type::Congest & p) override;
 	/// @}
 
+	/// @brief Request removal of stale devices from the memory. Called periodically from
+	/// a timer.
+	void ExpireDevices();
+
+	/// @brief Worker task loop - stores queued scan results into the memory and streams
+	/// them to the Master, if it subscribed.
+	void WorkerLoop();
+
 private:
 	AppConfig _cfg;
 
@@ -87,32 +112,118 @@ private:
 	/// @brief State
 	Gatt::StateChar _state;
 
-	/// @brief Memory for storing devices
+	/// @brief Memory for storing devices. Written by the worker task; the mutex is only
+	/// shared with GATT reads.
 	DeviceMemory _memory;
 	SemaphoreHandle_t _memMutex;
 
-	/// @brief Vector for serializing data
+	/// @brief Scan results from the GAP callbacks (single producer - both BLE and BR/EDR
+	/// callbacks run in the Bluedroid task) for the worker task
+	Core::SpscRing<ScanRecord> _scanQueue;
+
+	/// @brief Worker task
+	TaskHandle_t _workerTask = nullptr;
+
+	/// @brief Stale devices removal was requested
+	std::atomic<bool> _expireRequested{false};
+
+	/// @brief 'Devices' commands for the memory from the GATTS callbacks, which don't wait
+	/// for the mutex; applied before the next serialization (-1 - none)
+	/// @{
+	std::atomic<std::int16_t> _requestedFormat{-1};  ///< @ref Core::Compact version
+	std::atomic<std::int16_t> _requestedResync{-1};  ///< Epoch to reset
+	/// @}
+
+	/// @brief Scan result filter set by the Master. Only used by the GAP/GATTS callbacks
+	/// (Bluedroid task).
+	Core::FilterRules _filter;
+
+	/// @brief Dropped scan results during the last report
+	std::uint32_t _reportedDrops{0};
+
+	/// @brief Distinct devices seen during the scan schedule period, published by the worker
+	/// task; a reset is requested when a new period starts
+	/// @{
+	std::atomic<std::uint16_t> _seenDevices{0};
+	std::atomic<bool> _seenResetRequested{false};
+	/// @}
+
+	/// @brief Scan schedule. Only used by the GAP/GATTS callbacks (Bluedroid task).
+	/// @{
+	ScanScheduler _scheduler;
+	ScanScheduler::Observation _observed{};  ///< Since the last schedule update
+	std::uint32_t _scheduledDrops{0};        ///< Scan queue overflows at the last update
+	std::optional<bool> _scanningBle;        ///< Running scan period (BLE/Classic)
+	Core::TimePoint _scanStart;              ///< Start of the running scan period
+	bool _bleTurn{true};                     ///< Next period is BLE (ScanMode::Both)
+	/// @}
+
+	/// @brief Timer for `ExpireDevices`
+	/// @{
+	TimerHandle_t _expiryTimerHandle = nullptr;
+	StaticTimer_t _expiryTimerBuffer;
+	/// @}
+
+	/// @brief 'Devices' value being read (the rest of it is read with an offset)
 	std::vector<std::uint8_t> _serializeVec;
 
+	/// @brief Framed reads (@ref Core::Frames); enabled by the Master
+	/// @{
+	bool _framedReads{false};  ///< Whether the Master understands frames
+	Core::BatchFramer _batch;  ///< Batch waiting for an acknowledgement
+	/// @}
+
+	/// @brief 'Devices' streaming. The connection state is written by the GATTS callbacks;
+	/// the rest is only used by the worker task.
+	/// @{
+	std::uint16_t _connId{0};                          ///< Master connection
+	std::atomic<std::uint16_t> _mtu{0};                ///< Negotiated ATT MTU
+	std::atomic<std::uint16_t> _subscription{0};       ///< @ref Gatt::ClientConfigBits
+	std::atomic<bool> _congested{false};               ///< Stack can't take more now
+	std::atomic<bool> _awaitingConf{false};            ///< Waiting for indication confirmation
+	std::uint16_t _streamSeq{0};                       ///< Sequence number of the next payload
+	Core::TimePoint _lastStream = Core::Clock::now();  ///< Last sent payload
+	std::vector<std::uint8_t> _streamVec;              ///< Payload buffer
+	/// @}
+
 	/// @brief GATT attribute table
 	/// Scanner Service
 	///  - State characteristic declaration
 	///   - State characteristic value
 	///  - Devices characteristic declaration
 	///   - Devices characteristic value
+	///   - Devices client characteristic configuration
+	///  - Timestamp characteristic declaration
+	///   - Timestamp characteristic value
+	///  - Scan characteristic declaration
+	///   - Scan characteristic value
+	///  - Filter characteristic declaration
+	///   - Filter characteristic value
 	Gatt::AttributeTable _attributeTable = std::move(
 	    Gatt::AttributeTableBuilder::Build()
 	        .Service(Gatt::ScannerService)
 	        .Declaration(ESP_GATT_CHAR_PROP_BIT_WRITE | ESP_GATT_CHAR_PROP_BIT_READ)
 	        .Value(Gatt::StateCharacteristic, 1, 1, ESP_GATT_PERM_READ | ESP_GATT_PERM_WRITE)
-	        .Declaration(ESP_GATT_CHAR_PROP_BIT_WRITE | ESP_GATT_CHAR_PROP_BIT_READ)
+	        .Declaration(ESP_GATT_CHAR_PROP_BIT_WRITE | ESP_GATT_CHAR_PROP_BIT_READ
+	                     | ESP_GATT_CHAR_PROP_BIT_NOTIFY | ESP_GATT_CHAR_PROP_BIT_INDICATE)
 	        .Value(Gatt::DevicesCharacteristic,
 	               0,
 	               Core::DeviceMemoryByteSize(),
-	               ESP_GATT_PERM_READ,
-	               ESP_GATT_RSP_BY_APP)  // Using custom logic
+	               ESP_GATT_PERM_READ | ESP_GATT_PERM_WRITE,  // Writes are commands
+	               ESP_GATT_RSP_BY_APP)                       // Using custom logic
+	        .ClientConfig()
 	        .Declaration(ESP_GATT_CHAR_PROP_BIT_WRITE | ESP_GATT_CHAR_PROP_BIT_READ)
 	        .Value(Gatt::TimestampCharacteristic, 4, 4, ESP_GATT_PERM_READ | ESP_GATT_PERM_WRITE)
+	        .Declaration(ESP_GATT_CHAR_PROP_BIT_WRITE | ESP_GATT_CHAR_PROP_BIT_READ)
+	        .Value(Gatt::ScanCharacteristic,
+	               Core::ScanSchedule::Size,
+	               Core::ScanSchedule::Size,
+	               ESP_GATT_PERM_READ | ESP_GATT_PERM_WRITE)
+	        .Declaration(ESP_GATT_CHAR_PROP_BIT_WRITE | ESP_GATT_CHAR_PROP_BIT_READ)
+	        .Value(Gatt::FilterCharacteristic,
+	               0,
+	               Core::FilterRules::MaxSize,
+	               ESP_GATT_PERM_READ | ESP_GATT_PERM_WRITE)
 	        .Finish());
 
 	/// @brief Connection state
@@ -121,6 +232,35 @@ private:
 	/// @brief Last time the `Devices` GATT attribute was updated
 	Core::TimePoint _lastDevicesUpdate = Core::Clock::now();
 
+	/// @brief Queue a scan result for the worker task. Dropped if it's below the minimum RSSI,
+	/// doesn't pass the filter or the queue is full.
+	/// @param view scan result
+	void _Enqueue(const Bt::ScanResultView & view);
+
+	/// @brief Log dropped scan results, if there are new ones
+	void _ReportDrops();
+
+	/// @brief Send stored devices to the Master through 'Devices' notifications/indications,
+	/// if it subscribed, the stream interval elapsed or a full payload is ready and the stack
+	/// can take it. Called by the worker task with the memory mutex held.
+	void _StreamDevices();
+
+	/// @brief How long the worker task can wait for new scan results before streaming
+	/// @return ticks; portMAX_DELAY if the Master didn't subscribe
+	TickType_t _StreamWait() const;
+
+	/// @brief Maximum payload of a single notification/indication without the header
+	/// (0 if the MTU is too small)
+	std::size_t _StreamCapacity() const;
+
+	/// @brief Handle a 'Devices' command (@ref Gatt::DevicesControl)
+	/// @param data written value
+	/// @return whether the command was valid
+	bool _DevicesControl(std::span<const std::uint8_t> data);
+
+	/// @brief Apply the requested 'Devices' commands to the memory; with the memory mutex held
+	void _ApplyDevicesRequests();
+
 	/// @brief Changes state - start/stop advertising/scanning
 	/// @param state new state
 	void _ChangeState(const Gatt::StateChar state);
@@ -132,6 +272,19 @@ private:
 	void _ScanForDevices();
 	/// @}
 
+	/// @brief Account the time of the running scan period, if any
+	void _EndScanPeriod();
+
+	/// @brief Update the scan schedule from the results since the last update and apply it
+	/// to the next BLE scan period
+	void _UpdateSchedule();
+
+	/// @brief Set the BLE scan parameters to the schedule in use (while not scanning)
+	void _ApplySchedule();
+
+	/// @brief Set the 'scan' value to the schedule in use
+	void _PublishSchedule();
+
 	/// Checks if `Devices` data (GATTS attribute) needs to be updated and updates it if so
 	void _CheckAndUpdateDevicesData();
 	/// Forces `Devices` data (GATTS attribute) update
@@ -22,13 +22,51 @@ extern uint8_t ClientKeyEnd[] asm("_binary_client_key_end");
 // clang-format off
 const Master::AppConfig Cfg
 {
+#if defined(CONFIG_MASTER_SCANNER_TRANSFER_READ)
+	.Transfer = Master::ScannerTransfer::Read,
+#elif defined(CONFIG_MASTER_SCANNER_TRANSFER_INDICATE)
+	.Transfer = Master::ScannerTransfer::Indicate,
+#else
+	.Transfer = Master::ScannerTransfer::Notify,
+#endif
+#if defined(CONFIG_MASTER_COMPACT_RECORDS)
+	.CompactRecords = true,
+#else
+	.CompactRecords = false,
+#endif
 	.GattReadInterval = CONFIG_MASTER_GATT_READ_INTERVAL,
 	.DelayBetweenGattReads = CONFIG_MASTER_DELAY_BETWEEN_GATT_READS,
+	.GattReadQueueDepth = CONFIG_MASTER_GATT_READ_QUEUE_DEPTH,
+	.MemoryQueueDepth = CONFIG_MASTER_MEMORY_QUEUE_DEPTH,
+	.MemoryTaskCfg = Core::TaskConfig {
+		.StackSize = CONFIG_MASTER_MEMORY_TASK_STACK_SIZE,
+		.Priority = CONFIG_MASTER_MEMORY_TASK_PRIORITY,
+		.Core = CONFIG_MASTER_MEMORY_TASK_CORE,
+	},
+	.TaskStatsInterval = CONFIG_MASTER_TASK_STATS_INTERVAL,
 	.DeviceMemoryCfg = Master::AppConfig::DeviceMemoryConfig {
 		.MinMeasurements = CONFIG_MASTER_MIN_MEASUREMENTS,
 		.MinScanners = CONFIG_MASTER_MIN_SCANNERS,
 		.MaxScanners = CONFIG_MASTER_MAX_SCANNERS,
+		.MaxDevices = CONFIG_MASTER_MAX_DEVICES,
+#if defined(CONFIG_MASTER_DEVICE_TABLES_IN_PSRAM)
+		.DeviceTableRegion = Core::MemoryRegion::External,
+#else
+		.DeviceTableRegion = Core::MemoryRegion::Internal,
+#endif
 		.DeviceStoreTime = CONFIG_MASTER_DEVICE_STORE_TIME,
+		.MeasurementFreshness = CONFIG_MASTER_MEASUREMENT_FRESHNESS,
+		.FusionWindow = CONFIG_MASTER_FUSION_WINDOW,
+#if defined(CONFIG_MASTER_ASSOCIATE_RANDOM_ADDRESSES)
+		.AssociateRandomAddresses = true,
+#else
+		.AssociateRandomAddresses = false,
+#endif
+#if defined(CONFIG_MASTER_ASSOCIATION_GAP)
+		.AssociationGap = CONFIG_MASTER_ASSOCIATION_GAP,
+#endif
+		.HistoryLength = CONFIG_MASTER_HISTORY_LENGTH,
+		.ZoneEventCapacity = CONFIG_MASTER_ZONE_EVENTS,
 		.DefaultPathLoss = CONFIG_MASTER_DEFAULT_PATH_LOSS,
 		.DefaultEnvFactor = CONFIG_MASTER_DEFAULT_ENV_FACTOR,
 #if defined(CONFIG_MASTER_NO_POSITION_CALCULATION)
@@ -36,6 +74,32 @@ const Master::AppConfig Cfg
 #else
 		.NoPositionCalculation = false,
 #endif
+		.RssiFilterCfg = Master::AppConfig::DeviceMemoryConfig::RssiFilterConfig {
+#if defined(CONFIG_MASTER_RSSI_FILTER_MEDIAN)
+			.FilterType = Master::AppConfig::DeviceMemoryConfig::RssiFilterConfig::Type::Median,
+#elif defined(CONFIG_MASTER_RSSI_FILTER_KALMAN)
+			.FilterType = Master::AppConfig::DeviceMemoryConfig::RssiFilterConfig::Type::Kalman,
+#else
+			.FilterType = Master::AppConfig::DeviceMemoryConfig::RssiFilterConfig::Type::Ema,
+#endif
+#if defined(CONFIG_MASTER_RSSI_FILTER_EMA_ALPHA)
+			.EmaAlpha = CONFIG_MASTER_RSSI_FILTER_EMA_ALPHA,
+#else
+			.EmaAlpha = 64,
+#endif
+#if defined(CONFIG_MASTER_RSSI_FILTER_KALMAN)
+			.KalmanProcessNoise = CONFIG_MASTER_RSSI_FILTER_KALMAN_PROCESS_NOISE / 100.0f,
+			.KalmanMeasurementNoise = CONFIG_MASTER_RSSI_FILTER_KALMAN_MEASUREMENT_NOISE / 100.0f,
+#else
+			.KalmanProcessNoise = 0.5,
+			.KalmanMeasurementNoise = 4.0,
+#endif
+		},
+		.ScannerLinkCfg = Master::AppConfig::DeviceMemoryConfig::ScannerLinkConfig {
+			.MaxAge = CONFIG_MASTER_SCANNER_LINK_MAX_AGE,
+			.ConvergedVariance = CONFIG_MASTER_SCANNER_LINK_CONVERGED_VARIANCE / 100.0f,
+			.MinSamples = CONFIG_MASTER_SCANNER_LINK_MIN_SAMPLES,
+		},
 	},
 	.WifiCfg = Master::WifiConfig{
 #if defined(CONFIG_WIFI_AS_AP)
@@ -103,6 +167,11 @@ const Master::AppConfig Cfg
 			.EapPassword = {},
 #endif // CONFIG_WIFI_USE_WPA2
 		},
+		.ServerTask = Core::TaskConfig {
+			.StackSize = CONFIG_MASTER_HTTP_TASK_STACK_SIZE,
+			.Priority = CONFIG_MASTER_HTTP_TASK_PRIORITY,
+			.Core = CONFIG_MASTER_HTTP_TASK_CORE,
+		},
 	},
 };
 // clang-format on
\ No newline at end of file
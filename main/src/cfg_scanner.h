@@ -15,6 +15,28 @@ constexpr Scanner::AppConfig Cfg
 	.ScanModePeriodClassic = CONFIG_SCANNER_SCAN_BOTH_PERIOD_CLASSIC,
 	.ScanModePeriodBle = CONFIG_SCANNER_SCAN_BOTH_PERIOD_BLE,
 #endif
+	.ScheduleCfg = {
+#if defined(CONFIG_SCANNER_ADAPTIVE_SCAN)
+		.Adaptive = true,
+#else
+		.Adaptive = false,
+#endif
+#if defined(CONFIG_SCANNER_SCAN_BLE_ONLY)
+		.Period = CONFIG_SCANNER_SCAN_PERIOD,
+#endif
+#if defined(CONFIG_SCANNER_ADAPTIVE_SCAN)
+		.TargetRate = CONFIG_SCANNER_SCAN_TARGET_RATE,
+		.MinDuty = CONFIG_SCANNER_SCAN_MIN_DUTY,
+#endif
+	},
+	.ReadBatchSize = CONFIG_SCANNER_READ_BATCH_SIZE,
+	.StreamInterval = CONFIG_SCANNER_STREAM_INTERVAL,
+	.ScanQueueDepth = CONFIG_SCANNER_SCAN_QUEUE_DEPTH,
+	.WorkerTaskCfg = Core::TaskConfig {
+		.StackSize = 4096,
+		.Priority = CONFIG_SCANNER_WORKER_TASK_PRIORITY,
+		.Core = CONFIG_SCANNER_WORKER_TASK_CORE,
+	},
 	.DeviceMemoryCfg = {
 		.MemorySizeLimit = CONFIG_SCANNER_DEVICE_COUNT_LIMIT,
 #if defined(CONFIG_SCANNER_ENABLE_ASSOCIATION)
@@ -23,6 +45,7 @@ constexpr Scanner::AppConfig Cfg
 		.EnableAssociation = false,
 #endif
 		.StaleLimit = CONFIG_SCANNER_STALE_LIMIT,
+		.ExpiryInterval = CONFIG_SCANNER_EXPIRY_INTERVAL,
 		.MinRssi = CONFIG_SCANNER_MIN_RSSI
 	}
 };
@@ -0,0 +1,110 @@
+#include "core/batch_frames.h"
+
+#include <esp_log.h>
+
+#include <algorithm>
+
+namespace Core
+{
+
+static const char * TAG = "Frames";
+
+std::span<std::uint8_t> BatchFramer::Prepare(std::size_t size)
+{
+	_pending = false;
+	_data.resize(std::min(size, Frames::MaxBatchSize));
+	return _data;
+}
+
+void BatchFramer::Commit(std::size_t size)
+{
+	_data.resize(std::min(size, _data.size()));
+	_pending = !_data.empty();
+	if (_pending) {
+		_id++;
+		_next = 0;
+	}
+}
+
+void BatchFramer::NextFrame(std::vector<std::uint8_t> & out)
+{
+	out.clear();
+	if (!_pending) {
+		return;
+	}
+
+	const std::size_t offset = _next * Frames::ChunkSize;
+	const std::size_t size = std::min(Frames::ChunkSize, _data.size() - offset);
+	out.resize(Frames::HeaderSize + size);
+	out[0] = _id;
+	out[1] = _next;
+	out[2] = static_cast<std::uint8_t>(_data.size() & 0xFF);
+	out[3] = static_cast<std::uint8_t>(_data.size() >> 8);
+	std::copy_n(_data.begin() + offset, size, out.begin() + Frames::HeaderSize);
+
+	_next = (_next + 1) % _ChunkCount();
+}
+
+bool BatchFramer::Ack(std::uint8_t id)
+{
+	if (!_pending || id != _id) {
+		return false;
+	}
+	_pending = false;
+	_data.clear();
+	return true;
+}
+
+void BatchFramer::Clear()
+{
+	_pending = false;
+	_data.clear();
+}
+
+std::size_t BatchFramer::_ChunkCount() const
+{
+	return (_data.size() + Frames::ChunkSize - 1) / Frames::ChunkSize;
+}
+
+BatchAssembler::Result BatchAssembler::Add(std::span<const std::uint8_t> frame)
+{
+	if (frame.size() <= Frames::HeaderSize) {
+		return Result::Invalid;
+	}
+	const std::uint8_t id = frame[0];
+	const std::uint8_t index = frame[1];
+	const std::size_t length = frame[2] | (frame[3] << 8);
+	const std::span<const std::uint8_t> chunk = frame.subspan(Frames::HeaderSize);
+
+	const std::size_t chunks = (length + Frames::ChunkSize - 1) / Frames::ChunkSize;
+	const std::size_t offset = index * Frames::ChunkSize;
+	if (length == 0 || length > Frames::MaxBatchSize || index >= chunks
+	    || chunk.size() != std::min(Frames::ChunkSize, length - offset)) {
+		ESP_LOGW(TAG, "Invalid frame (batch %u, chunk %u, length %d)", id, index, length);
+		return Result::Invalid;
+	}
+
+	if (_completed && id == _id) {
+		return Result::Duplicate;  // Acknowledgement got lost
+	}
+	if (!_active || id != _id || _data.size() != length) {
+		// New batch; an incomplete one won't be sent anymore
+		_data.assign(length, 0);
+		_received = 0;
+		_id = id;
+		_active = true;
+		_completed = false;
+	}
+
+	std::copy(chunk.begin(), chunk.end(), _data.begin() + offset);
+	_received |= 1u << index;
+	const std::uint32_t all = chunks == Frames::MaxChunks ? ~0u : (1u << chunks) - 1;
+	if (_received != all) {
+		return Result::Incomplete;
+	}
+	_active = false;
+	_completed = true;
+	return Result::Complete;
+}
+
+}  // namespace Core
@@ -13,4 +13,9 @@ std::uint32_t ToUnix(const TimePoint & timepoint)
 	return std::chrono::duration_cast<std::chrono::seconds>(timepoint.time_since_epoch()).count();
 }
 
+TimePoint FromUnix(std::uint32_t timestamp)
+{
+	return TimePoint(std::chrono::duration_cast<Clock::duration>(std::chrono::seconds(timestamp)));
+}
+
 }  // namespace Core
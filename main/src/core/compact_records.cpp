@@ -0,0 +1,272 @@
+#include "core/compact_records.h"
+
+#include <esp_log.h>
+
+#include <limits>
+
+namespace Core
+{
+
+static const char * TAG = "Compact";
+
+namespace
+{
+/// @brief Index of the definition record fields
+/// @{
+constexpr std::size_t IdIdx = 0;
+constexpr std::size_t RssiIdx = 1;
+constexpr std::size_t AgeIdx = 2;
+constexpr std::size_t FlagsIdx = 3;
+constexpr std::size_t EventTypeIdx = 4;
+constexpr std::size_t AdvDataSizeIdx = 5;
+constexpr std::size_t MacIdx = 6;
+constexpr std::size_t AdvLengthIdx = 12;
+/// @}
+
+constexpr std::size_t MacSize = 6;
+constexpr std::size_t AdvSize = DeviceDataView::AdvDataEndIdx - DeviceDataView::AdvDataStartIdx + 1;
+
+/// @brief MAC of a record
+std::span<const std::uint8_t, MacSize> RecordMac(std::span<const std::uint8_t> record)
+{
+	return record.subspan<DeviceDataView::MacStartIdx, MacSize>();
+}
+
+/// @brief Part of a record, which requires a definition when it changes
+std::span<const std::uint8_t> DefinedPart(std::span<const std::uint8_t> record)
+{
+	return record.subspan(DeviceDataView::FlagsIdx);
+}
+}  // namespace
+
+CompactEncoder::CompactEncoder()
+{
+	Reset();
+}
+
+void CompactEncoder::Reset()
+{
+	for (Entry & entry : _entries) {
+		entry.Used = false;
+	}
+	_uses = 0;
+	_epoch++;
+	_seq = 0;
+	ESP_LOGD(TAG, "Epoch %u", _epoch);
+}
+
+void CompactEncoder::SetVersion(std::uint8_t version)
+{
+	_version = version;
+	Reset();
+}
+
+std::size_t CompactEncoder::Begin(std::span<std::uint8_t> out, std::uint32_t timestamp)
+{
+	if (out.size() < Compact::HeaderSize) {
+		return 0;
+	}
+	out[0] = _version;
+	out[1] = _epoch;
+	out[2] = _seq++;
+	for (std::size_t i = 0; i < 4; i++) {
+		out[3 + i] = static_cast<std::uint8_t>(timestamp >> (8 * i));
+	}
+	_timestamp = timestamp;
+	return Compact::HeaderSize;
+}
+
+std::size_t CompactEncoder::Add(const DeviceDataView & record,
+                                const RssiStats & stats,
+                                std::span<std::uint8_t> out)
+{
+	std::span<const std::uint8_t> data = record.Span;
+	const std::uint32_t timestamp = record.Timestamp();
+	const std::uint32_t delta = timestamp < _timestamp ? _timestamp - timestamp : 0;
+	const std::uint8_t age = static_cast<std::uint8_t>(
+	    std::min<std::uint32_t>(delta, std::numeric_limits<std::uint8_t>::max()));
+
+	const std::size_t statsSize = Compact::StatsSize(_version);
+
+	std::optional<std::uint8_t> id = _Find(RecordMac(data));
+	if (id && std::ranges::equal(DefinedPart(_entries[*id].Record), DefinedPart(data))) {
+		const std::size_t size = Compact::UpdateSize + statsSize;
+		if (out.size() < size) {
+			return 0;
+		}
+		out[IdIdx] = *id;
+		out[RssiIdx] = static_cast<std::uint8_t>(record.Rssi());
+		out[AgeIdx] = age;
+		_WriteStats(stats, out.subspan(Compact::UpdateSize, statsSize));
+		_entries[*id].LastUse = ++_uses;
+		return size;
+	}
+
+	// Trailing zeros are padding
+	std::span<const std::uint8_t> adv = data.subspan<DeviceDataView::AdvDataStartIdx, AdvSize>();
+	auto last = std::find_if(adv.rbegin(), adv.rend(), [](std::uint8_t b) { return b != 0; });
+	const std::size_t advLength = static_cast<std::size_t>(adv.rend() - last);
+	const std::size_t size = Compact::DefinitionHeaderSize + advLength + statsSize;
+	if (out.size() < size) {
+		return 0;
+	}
+
+	const std::uint8_t newId = id.value_or(_Replaceable());
+	out[IdIdx] = newId | Compact::DefinitionBit;
+	out[RssiIdx] = static_cast<std::uint8_t>(record.Rssi());
+	out[AgeIdx] = age;
+	out[FlagsIdx] = data[DeviceDataView::FlagsIdx];
+	out[EventTypeIdx] = data[DeviceDataView::AdvEventTypeIdx];
+	out[AdvDataSizeIdx] = data[DeviceDataView::AdvDataSizeIdx];
+	std::ranges::copy(RecordMac(data), out.begin() + MacIdx);
+	out[AdvLengthIdx] = static_cast<std::uint8_t>(advLength);
+	std::copy_n(adv.begin(), advLength, out.begin() + Compact::DefinitionHeaderSize);
+	_WriteStats(stats, out.subspan(Compact::DefinitionHeaderSize + advLength, statsSize));
+
+	Entry & entry = _entries[newId];
+	std::ranges::copy(data, entry.Record.begin());
+	entry.LastUse = ++_uses;
+	entry.Used = true;
+	return size;
+}
+
+void CompactEncoder::_WriteStats(const RssiStats & stats, std::span<std::uint8_t> out)
+{
+	if (!out.empty()) {
+		stats.Serialize(out.first<RssiStats::Size>());
+	}
+}
+
+std::optional<std::uint8_t> CompactEncoder::_Find(std::span<const std::uint8_t, 6> mac) const
+{
+	for (std::size_t i = 0; i < _entries.size(); i++) {
+		if (_entries[i].Used && std::ranges::equal(RecordMac(_entries[i].Record), mac)) {
+			return static_cast<std::uint8_t>(i);
+		}
+	}
+	return std::nullopt;
+}
+
+std::uint8_t CompactEncoder::_Replaceable() const
+{
+	auto it = std::ranges::min_element(_entries, [](const Entry & a, const Entry & b) {
+		// Unused entries first
+		return a.Used != b.Used ? !a.Used : a.LastUse < b.LastUse;
+	});
+	return static_cast<std::uint8_t>(it - _entries.begin());
+}
+
+CompactDecoder::CompactDecoder(MemoryRegion region)
+    : _records(Compact::MaxIds * DeviceDataView::Size, 0, CapsAllocator<std::uint8_t>(region))
+{
+}
+
+CompactDecoder::Result CompactDecoder::Decode(std::span<const std::uint8_t> payload,
+                                              std::vector<std::uint8_t> & out,
+                                              std::vector<RssiStats> & stats)
+{
+	out.clear();
+	stats.clear();
+	if (payload.size() < Compact::HeaderSize || !Compact::IsCompact(payload[0])) {
+		return Result::Invalid;
+	}
+	const std::size_t statsSize = Compact::StatsSize(payload[0]);
+	const std::uint8_t epoch = payload[1];
+	const std::uint8_t seq = payload[2];
+	std::uint32_t base = 0;
+	for (std::size_t i = 0; i < 4; i++) {
+		base |= static_cast<std::uint32_t>(payload[3 + i]) << (8 * i);
+	}
+
+	if (_synced && epoch == _epoch) {
+		if (seq == _seq) {
+			return Result::Duplicate;
+		}
+		if (seq != static_cast<std::uint8_t>(_seq + 1)) {
+			ESP_LOGW(TAG, "Lost payloads (epoch %u, seq %u, expected %u)", epoch, seq,
+			         static_cast<std::uint8_t>(_seq + 1));
+			return _Desync(epoch);
+		}
+		_seq = seq;
+	}
+	else {
+		if (_resyncPending && epoch == _epoch) {
+			// The Scanner hasn't reset yet
+			return Result::Resync;
+		}
+		if (seq != 0) {
+			ESP_LOGW(TAG, "Joined epoch %u at seq %u", epoch, seq);
+			return _Desync(epoch);
+		}
+		_defined.fill(false);
+		_epoch = epoch;
+		_seq = 0;
+		_synced = true;
+		_resyncPending = false;
+	}
+
+	std::size_t pos = Compact::HeaderSize;
+	while (pos < payload.size()) {
+		const std::uint8_t id = payload[pos] & ~Compact::DefinitionBit;
+		const bool definition = (payload[pos] & Compact::DefinitionBit) != 0;
+		if (id >= Compact::MaxIds) {
+			ESP_LOGW(TAG, "Invalid id %u", id);
+			return _Desync(epoch);
+		}
+
+		std::span<std::uint8_t, DeviceDataView::Size> record = _Record(id);
+		std::span<const std::uint8_t> rest = payload.subspan(pos);
+		if (definition) {
+			if (rest.size() < Compact::DefinitionHeaderSize || rest[AdvLengthIdx] > AdvSize
+			    || rest.size() < Compact::DefinitionHeaderSize + rest[AdvLengthIdx] + statsSize) {
+				ESP_LOGW(TAG, "Truncated definition of %u", id);
+				return _Desync(epoch);
+			}
+			const std::size_t advLength = rest[AdvLengthIdx];
+			std::fill(record.begin(), record.end(), 0);
+			std::ranges::copy(rest.subspan<MacIdx, MacSize>(),
+			                  record.begin() + DeviceDataView::MacStartIdx);
+			record[DeviceDataView::FlagsIdx] = rest[FlagsIdx];
+			record[DeviceDataView::AdvDataSizeIdx] = rest[AdvDataSizeIdx];
+			record[DeviceDataView::AdvEventTypeIdx] = rest[EventTypeIdx];
+			std::copy_n(rest.begin() + Compact::DefinitionHeaderSize, advLength,
+			            record.begin() + DeviceDataView::AdvDataStartIdx);
+			_defined[id] = true;
+			pos += Compact::DefinitionHeaderSize + advLength;
+		}
+		else {
+			if (rest.size() < Compact::UpdateSize + statsSize || !_defined[id]) {
+				ESP_LOGW(TAG, "Update of undefined id %u", id);
+				return _Desync(epoch);
+			}
+			pos += Compact::UpdateSize;
+		}
+
+		if (statsSize != 0) {
+			stats.push_back(RssiStats::Parse(payload.subspan(pos).first<RssiStats::Size>()));
+			pos += statsSize;
+		}
+
+		DeviceDataView view(record);
+		view.Timestamp() = base - rest[AgeIdx];
+		view.Rssi() = static_cast<std::int8_t>(rest[RssiIdx]);
+		out.insert(out.end(), record.begin(), record.end());
+	}
+	return Result::Ok;
+}
+
+CompactDecoder::Result CompactDecoder::_Desync(std::uint8_t epoch)
+{
+	_epoch = epoch;
+	_synced = false;
+	_resyncPending = true;
+	return Result::Resync;
+}
+
+std::span<std::uint8_t, DeviceDataView::Size> CompactDecoder::_Record(std::uint8_t id)
+{
+	return std::span<std::uint8_t, DeviceDataView::Size>(
+	    _records.data() + id * DeviceDataView::Size, DeviceDataView::Size);
+}
+
+}  // namespace Core
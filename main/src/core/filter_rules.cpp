@@ -0,0 +1,173 @@
+#include "core/filter_rules.h"
+
+#include <algorithm>
+
+namespace Core
+{
+
+namespace
+{
+/// @brief Rule header size (kind, data length)
+constexpr std::size_t RuleHeaderSize = 2;
+
+/// @brief Whether a rule has a valid length
+bool IsValidRule(FilterRules::Kind kind, std::size_t length)
+{
+	switch (kind) {
+	case FilterRules::Kind::MacPrefix:
+		return length >= 1 && length <= Mac::Size;
+	case FilterRules::Kind::ServiceUuid:
+		return length == 2 || length == 4 || length == 16;
+	case FilterRules::Kind::ManufacturerId:
+		return length == 2;
+	case FilterRules::Kind::ByteMask:
+		// AD type, offset, value and mask of the same length
+		return length >= 4 && length % 2 == 0;
+	}
+	return false;
+}
+
+/// @brief Call a function for each rule until it returns true
+/// @param data serialized rules
+/// @param fn `bool(Kind, std::span<const std::uint8_t>)`
+/// @return whether the function returned true
+template <typename Fn>
+bool AnyRule(std::span<const std::uint8_t> data, Fn && fn)
+{
+	while (data.size() >= RuleHeaderSize) {
+		const std::size_t length = data[1];
+		if (data.size() < RuleHeaderSize + length) {
+			return false;
+		}
+		if (fn(static_cast<FilterRules::Kind>(data[0]), data.subspan(RuleHeaderSize, length))) {
+			return true;
+		}
+		data = data.subspan(RuleHeaderSize + length);
+	}
+	return false;
+}
+
+/// @brief Whether a list of UUIDs contains one
+bool ListContains(std::span<const std::uint8_t> list, std::span<const std::uint8_t> uuid)
+{
+	for (; list.size() >= uuid.size(); list = list.subspan(uuid.size())) {
+		if (std::ranges::equal(list.first(uuid.size()), uuid)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+/// @brief Whether an EIR record advertises a service UUID
+bool HasService(const Bt::EirView::Record & record, std::span<const std::uint8_t> uuid)
+{
+	switch (record.Type) {
+	case ESP_BLE_AD_TYPE_16SRV_PART:
+	case ESP_BLE_AD_TYPE_16SRV_CMPL:
+		return uuid.size() == 2 && ListContains(record.Data, uuid);
+	case ESP_BLE_AD_TYPE_32SRV_PART:
+	case ESP_BLE_AD_TYPE_32SRV_CMPL:
+		return uuid.size() == 4 && ListContains(record.Data, uuid);
+	case ESP_BLE_AD_TYPE_128SRV_PART:
+	case ESP_BLE_AD_TYPE_128SRV_CMPL:
+		return uuid.size() == 16 && ListContains(record.Data, uuid);
+	case ESP_BLE_AD_TYPE_SERVICE_DATA:
+	case ESP_BLE_AD_TYPE_32SERVICE_DATA:
+	case ESP_BLE_AD_TYPE_128SERVICE_DATA: {
+		// Service data starts with the UUID; the type determines its size
+		const std::size_t size = record.Type == ESP_BLE_AD_TYPE_SERVICE_DATA    ? 2
+		                         : record.Type == ESP_BLE_AD_TYPE_32SERVICE_DATA ? 4
+		                                                                         : 16;
+		return uuid.size() == size && record.Data.size() >= size
+		       && std::ranges::equal(record.Data.first(size), uuid);
+	}
+	default:
+		return false;
+	}
+}
+}  // namespace
+
+bool FilterRules::IsValid(std::span<const std::uint8_t> data)
+{
+	if (data.size() > MaxSize) {
+		return false;
+	}
+	std::size_t consumed = 0;
+	const bool invalid = AnyRule(data, [&](Kind kind, std::span<const std::uint8_t> rule) {
+		consumed += RuleHeaderSize + rule.size();
+		return !IsValidRule(kind, rule.size());
+	});
+	return !invalid && consumed == data.size();
+}
+
+bool FilterRules::Set(std::span<const std::uint8_t> data)
+{
+	if (!IsValid(data)) {
+		return false;
+	}
+	std::ranges::copy(data, _data.begin());
+	_size = data.size();
+	return true;
+}
+
+std::size_t FilterRules::Count() const
+{
+	std::size_t count = 0;
+	AnyRule(Data(), [&](Kind, std::span<const std::uint8_t>) {
+		count++;
+		return false;
+	});
+	return count;
+}
+
+bool FilterRules::Matches(const Bt::ScanResultView & view) const
+{
+	if (Empty()) {
+		return true;
+	}
+	const Bt::EirView eir = view.Eir();
+	return AnyRule(Data(), [&](Kind kind, std::span<const std::uint8_t> rule) {
+		return _Matches(kind, rule, view, eir);
+	});
+}
+
+bool FilterRules::_Matches(Kind kind,
+                           std::span<const std::uint8_t> rule,
+                           const Bt::ScanResultView & view,
+                           const Bt::EirView & eir)
+{
+	switch (kind) {
+	case Kind::MacPrefix:
+		return std::ranges::equal(view.Bda().first(rule.size()), rule);
+	case Kind::ServiceUuid:
+		return std::any_of(eir.begin(), eir.end(), [&](const Bt::EirView::Record & record) {
+			return HasService(record, rule);
+		});
+	case Kind::ManufacturerId: {
+		const auto record = eir.Find(ESP_BLE_AD_MANUFACTURER_SPECIFIC_TYPE);
+		return record.has_value() && record->Data.size() >= rule.size()
+		       && std::ranges::equal(record->Data.first(rule.size()), rule);
+	}
+	case Kind::ByteMask: {
+		const auto type = static_cast<esp_ble_adv_data_type>(rule[0]);
+		const std::size_t offset = rule[1];
+		const std::size_t length = (rule.size() - 2) / 2;
+		const std::span<const std::uint8_t> value = rule.subspan(2, length);
+		const std::span<const std::uint8_t> mask = rule.subspan(2 + length, length);
+		return std::any_of(eir.begin(), eir.end(), [&](const Bt::EirView::Record & record) {
+			if (record.Type != type || record.Data.size() < offset + length) {
+				return false;
+			}
+			for (std::size_t i = 0; i < length; i++) {
+				if ((record.Data[offset + i] & mask[i]) != (value[i] & mask[i])) {
+					return false;
+				}
+			}
+			return true;
+		});
+	}
+	}
+	return false;
+}
+
+}  // namespace Core
@@ -0,0 +1,70 @@
+#include "core/rssi_stats.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace Core
+{
+
+namespace
+{
+/// @brief Fractional bits of the fixed point values
+constexpr int FractionBits = 8;
+
+/// @brief Q8 variance to 1/4 dBm^2 (Q2)
+constexpr int VarianceShift = FractionBits - 2;
+}  // namespace
+
+void RssiStats::Serialize(std::span<std::uint8_t, Size> out) const
+{
+	out[0] = Count;
+	out[1] = Variance;
+	out[2] = static_cast<std::uint8_t>(Min);
+	out[3] = static_cast<std::uint8_t>(Max);
+}
+
+RssiStats RssiStats::Parse(std::span<const std::uint8_t, Size> data)
+{
+	return {data[0], data[1], static_cast<std::int8_t>(data[2]), static_cast<std::int8_t>(data[3])};
+}
+
+RssiAccumulator::RssiAccumulator(std::int8_t rssi)
+    : _min(rssi)
+    , _max(rssi)
+{
+	Add(rssi);
+}
+
+void RssiAccumulator::Add(std::int8_t rssi)
+{
+	_min = std::min(_min, rssi);
+	_max = std::max(_max, rssi);
+	if (_count < std::numeric_limits<std::uint16_t>::max()) {
+		_count++;
+	}
+
+	// The mean moves towards the sample (truncated), so both deltas have the same sign
+	const std::int32_t sample = static_cast<std::int32_t>(rssi) * (1 << FractionBits);
+	const std::int32_t delta = sample - _mean;
+	_mean += delta / _count;
+	const std::int32_t delta2 = sample - _mean;
+	_m2 += static_cast<std::uint64_t>(static_cast<std::int64_t>(delta) * delta2) >> FractionBits;
+}
+
+std::int8_t RssiAccumulator::Mean() const
+{
+	constexpr std::int32_t half = 1 << (FractionBits - 1);
+	return static_cast<std::int8_t>((_mean + (_mean < 0 ? -half : half)) / (1 << FractionBits));
+}
+
+RssiStats RssiAccumulator::Stats() const
+{
+	constexpr std::uint64_t maxByte = std::numeric_limits<std::uint8_t>::max();
+	const std::uint64_t variance = _count > 1 ? (_m2 / (_count - 1)) >> VarianceShift : 0;
+	return {static_cast<std::uint8_t>(std::min<std::uint64_t>(_count, maxByte)),
+	        static_cast<std::uint8_t>(std::min(variance, maxByte)),
+	        _min,
+	        _max};
+}
+
+}  // namespace Core
@@ -0,0 +1,42 @@
+#include "core/scan_schedule.h"
+
+namespace Core
+{
+
+void ScanSchedule::Serialize(std::span<std::uint8_t, Size> out) const
+{
+	out[0] = static_cast<std::uint8_t>(Source);
+	out[1] = static_cast<std::uint8_t>(Window & 0xFF);
+	out[2] = static_cast<std::uint8_t>(Window >> 8);
+	out[3] = static_cast<std::uint8_t>(Interval & 0xFF);
+	out[4] = static_cast<std::uint8_t>(Interval >> 8);
+	out[5] = BleShare;
+}
+
+std::optional<ScanSchedule> ScanSchedule::Parse(std::span<const std::uint8_t> data)
+{
+	if (data.empty()) {
+		return std::nullopt;
+	}
+	if (data[0] == static_cast<std::uint8_t>(Mode::Adaptive)) {
+		return ScanSchedule{};
+	}
+	if (data[0] != static_cast<std::uint8_t>(Mode::Fixed) || data.size() != Size) {
+		return std::nullopt;
+	}
+
+	ScanSchedule schedule{
+	    .Source = Mode::Fixed,
+	    .Window = static_cast<std::uint16_t>(data[1] | (data[2] << 8)),
+	    .Interval = static_cast<std::uint16_t>(data[3] | (data[4] << 8)),
+	    .BleShare = data[5],
+	};
+	if (schedule.Interval < MinInterval || schedule.Interval > MaxInterval
+	    || schedule.Window < MinInterval || schedule.Window > schedule.Interval
+	    || schedule.BleShare > 100) {
+		return std::nullopt;
+	}
+	return schedule;
+}
+
+}  // namespace Core
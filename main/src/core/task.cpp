@@ -0,0 +1,78 @@
+#include "core/task.h"
+
+#include <esp_log.h>
+
+#include <algorithm>
+
+namespace
+{
+/// @brief Logger tag
+static const char * TAG = "Task";
+}  // namespace
+
+namespace Core
+{
+
+bool CreateTask(TaskFunction_t fn,
+                const char * name,
+                const TaskConfig & cfg,
+                void * arg,
+                TaskHandle_t * handle)
+{
+	const BaseType_t core =
+	    (cfg.Core >= 0 && cfg.Core < portNUM_PROCESSORS) ? cfg.Core : tskNO_AFFINITY;
+	const auto stackSize =
+	    std::max(cfg.StackSize, static_cast<std::uint32_t>(configMINIMAL_STACK_SIZE));
+
+	const auto ret = xTaskCreatePinnedToCore(fn, name, stackSize, arg, cfg.Priority, handle, core);
+	if (ret != pdPASS) {
+		ESP_LOGE(TAG, "Failed creating task %s (%d)", name, ret);
+		return false;
+	}
+	ESP_LOGI(TAG, "Created %s (prio %d, core %d, stack %lu)", name, cfg.Priority, core, stackSize);
+	return true;
+}
+
+void TaskStats::Report()
+{
+#if (configGENERATE_RUN_TIME_STATS == 1) && (configUSE_TRACE_FACILITY == 1)
+	_status.resize(uxTaskGetNumberOfTasks() + 2);  // +2 in case some get created meanwhile
+
+	RunTime total = 0;
+	_status.resize(uxTaskGetSystemState(_status.data(), _status.size(), &total));
+
+	// Each core accumulates its own run time
+	const RunTime elapsed = (total - _previousTotal) * portNUM_PROCESSORS;
+	_previousTotal = total;
+	if (elapsed == 0) {
+		return;
+	}
+
+	std::sort(_status.begin(), _status.end(), [](const TaskStatus_t & a, const TaskStatus_t & b) {
+		return a.xTaskNumber < b.xTaskNumber;
+	});
+
+	ESP_LOGI(TAG, "%-16s %4s %4s %6s %6s", "Task", "Prio", "Core", "CPU", "Stack");
+	for (const TaskStatus_t & s : _status) {
+		auto prev = std::find_if(_previous.begin(), _previous.end(),
+		                         [&](const Previous & p) { return p.Handle == s.xHandle; });
+		const RunTime busy = s.ulRunTimeCounter - ((prev != _previous.end()) ? prev->Time : 0);
+		const float usage = 100.0f * static_cast<float>(busy) / static_cast<float>(elapsed);
+
+		const BaseType_t core = xTaskGetCoreID(s.xHandle);
+
+		ESP_LOGI(TAG, "%-16s %4d %4d %5.1f%% %6lu", s.pcTaskName, s.uxCurrentPriority,
+		         (core == tskNO_AFFINITY) ? -1 : static_cast<int>(core), usage,
+		         static_cast<unsigned long>(s.usStackHighWaterMark));
+	}
+
+	_previous.clear();
+	for (const TaskStatus_t & s : _status) {
+		_previous.emplace_back(s.xHandle, s.ulRunTimeCounter);
+	}
+#else
+	ESP_LOGW(TAG, "Task stats require FreeRTOS run time stats and trace facility");
+#endif
+}
+
+}  // namespace Core
@@ -0,0 +1,26 @@
+#include "core/utility/caps_allocator.h"
+
+#include <esp_heap_caps.h>
+
+namespace Core
+{
+
+void * AllocateIn(std::size_t size, MemoryRegion region)
+{
+	switch (region) {
+	case MemoryRegion::External:
+		// Prefer PSRAM, fall back to any 8bit capable memory
+		return heap_caps_malloc_prefer(size, 2, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT,
+		                               MALLOC_CAP_DEFAULT);
+	case MemoryRegion::Internal:
+	default:
+		return heap_caps_malloc(size, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+	}
+}
+
+void FreeIn(void * ptr)
+{
+	heap_caps_free(ptr);
+}
+
+}  // namespace Core
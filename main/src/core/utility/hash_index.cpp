@@ -0,0 +1,54 @@
+#include "core/utility/hash_index.h"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+
+namespace Core
+{
+
+HashIndex::HashIndex(std::size_t capacity)
+    : _buckets(std::bit_ceil(std::max<std::size_t>(capacity * 2, 2)),
+               CapsAllocator<Bucket>(MemoryRegion::Internal))
+    , _mask(_buckets.size() - 1)
+{
+}
+
+void HashIndex::Insert(std::uint32_t hash, Index idx)
+{
+	assert(idx != Npos);
+
+	std::size_t b = hash & _mask;
+	while (_buckets[b].Idx != Npos) {
+		b = (b + 1) & _mask;
+	}
+	_buckets[b] = Bucket{hash, idx};
+}
+
+void HashIndex::Erase(std::uint32_t hash, Index idx)
+{
+	std::size_t hole = hash & _mask;
+	for (; _buckets[hole].Idx != idx; hole = (hole + 1) & _mask) {
+		if (_buckets[hole].Idx == Npos) {
+			return;  // Not stored
+		}
+	}
+
+	// Backward shift - move the following entries of the probe sequence into the hole,
+	// if they don't end up before their home bucket
+	for (std::size_t b = (hole + 1) & _mask; _buckets[b].Idx != Npos; b = (b + 1) & _mask) {
+		const std::size_t home = _buckets[b].Hash & _mask;
+		if (((b - home) & _mask) >= ((b - hole) & _mask)) {
+			_buckets[hole] = _buckets[b];
+			hole = b;
+		}
+	}
+	_buckets[hole] = Bucket{};
+}
+
+void HashIndex::Clear()
+{
+	std::fill(_buckets.begin(), _buckets.end(), Bucket{});
+}
+
+}  // namespace Core
@@ -0,0 +1,100 @@
+#include "core/utility/lru_index.h"
+
+#include <cassert>
+
+namespace Core
+{
+
+LruIndex::LruIndex(std::size_t capacity)
+    : _nodes(capacity, CapsAllocator<Node>(MemoryRegion::Internal))
+{
+	assert(capacity < Npos);
+	Clear();
+}
+
+LruIndex::Index LruIndex::Acquire()
+{
+	if (_free == Npos) {
+		return Npos;
+	}
+	const Index idx = _free;
+	_free = _nodes[idx].Next;
+
+	_nodes[idx].Used = true;
+	_PushFront(idx);
+	_size++;
+	return idx;
+}
+
+void LruIndex::Release(Index idx)
+{
+	assert(idx < _nodes.size() && _nodes[idx].Used);
+
+	_Unlink(idx);
+	_nodes[idx].Used = false;
+	_nodes[idx].Prev = Npos;
+	_nodes[idx].Next = _free;
+	_free = idx;
+	_size--;
+}
+
+void LruIndex::Touch(Index idx)
+{
+	assert(idx < _nodes.size() && _nodes[idx].Used);
+
+	if (idx == _head) {
+		return;
+	}
+	_Unlink(idx);
+	_PushFront(idx);
+}
+
+void LruIndex::Clear()
+{
+	// Free list in ascending order, so the slots get used from the beginning
+	for (std::size_t i = 0; i < _nodes.size(); i++) {
+		_nodes[i].Used = false;
+		_nodes[i].Prev = Npos;
+		_nodes[i].Next = (i + 1 < _nodes.size()) ? static_cast<Index>(i + 1) : Npos;
+	}
+	_free = _nodes.empty() ? Npos : 0;
+	_head = Npos;
+	_tail = Npos;
+	_size = 0;
+}
+
+void LruIndex::_Unlink(Index idx)
+{
+	Node & node = _nodes[idx];
+	if (node.Prev != Npos) {
+		_nodes[node.Prev].Next = node.Next;
+	}
+	else {
+		_head = node.Next;
+	}
+
+	if (node.Next != Npos) {
+		_nodes[node.Next].Prev = node.Prev;
+	}
+	else {
+		_tail = node.Prev;
+	}
+	node.Prev = Npos;
+	node.Next = Npos;
+}
+
+void LruIndex::_PushFront(Index idx)
+{
+	Node & node = _nodes[idx];
+	node.Prev = Npos;
+	node.Next = _head;
+	if (_head != Npos) {
+		_nodes[_head].Prev = idx;
+	}
+	_head = idx;
+	if (_tail == Npos) {
+		_tail = idx;
+	}
+}
+
+}  // namespace Core
@@ -49,3 +49,38 @@ std::string ToString(std::span<const std::uint8_t, Mac::Size> addr)
 	buffer.back() = '\0';
 	return std::string(buffer.data());
 }
+
+std::optional<Mac> ParseMac(std::string_view str)
+{
+	const auto hexValue = [](char c) -> int {
+		if (c >= '0' && c <= '9') {
+			return c - '0';
+		}
+		if (c >= 'A' && c <= 'F') {
+			return c - 'A' + 10;
+		}
+		if (c >= 'a' && c <= 'f') {
+			return c - 'a' + 10;
+		}
+		return -1;
+	};
+
+	Mac mac;
+	std::size_t digits = 0;
+	for (const char c : str) {
+		if (c == ':' || c == '-') {
+			continue;
+		}
+		const int value = hexValue(c);
+		if (value < 0 || digits >= Mac::Size * 2) {
+			return std::nullopt;
+		}
+		auto & byte = mac.Addr[digits / 2];
+		byte = (digits % 2 == 0) ? (value << 4) : (byte | value);
+		digits++;
+	}
+	if (digits != Mac::Size * 2) {
+		return std::nullopt;
+	}
+	return mac;
+}
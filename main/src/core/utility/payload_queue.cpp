@@ -0,0 +1,64 @@
+#include "core/utility/payload_queue.h"
+
+#include <algorithm>
+
+namespace Core
+{
+
+PayloadQueue::PayloadQueue(std::size_t capacity)
+    : _slots(std::max<std::size_t>(capacity, 1))
+{
+}
+
+bool PayloadQueue::Push(std::uint16_t id, std::span<const std::uint8_t> data, std::uint8_t kind)
+{
+	if (data.size() > MaxPayloadSize) {
+		return false;
+	}
+
+	const std::size_t tail = _tail.load(std::memory_order_relaxed);
+	const std::size_t size = tail - _head.load(std::memory_order_acquire);
+	if (size >= _slots.size()) {
+		_overflows.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+
+	Payload & slot = _slots[tail % _slots.size()];
+	slot.Id = id;
+	slot.Size = static_cast<std::uint16_t>(data.size());
+	slot.Kind = kind;
+	std::copy(data.begin(), data.end(), slot.Data.begin());
+	_tail.store(tail + 1, std::memory_order_release);
+
+	if (size + 1 > _highWatermark.load(std::memory_order_relaxed)) {
+		_highWatermark.store(size + 1, std::memory_order_relaxed);
+	}
+	return true;
+}
+
+PayloadQueue::Payload * PayloadQueue::Front()
+{
+	const std::size_t head = _head.load(std::memory_order_relaxed);
+	if (head == _tail.load(std::memory_order_acquire)) {
+		return nullptr;
+	}
+	return &_slots[head % _slots.size()];
+}
+
+void PayloadQueue::Pop()
+{
+	const std::size_t head = _head.load(std::memory_order_relaxed);
+	if (head == _tail.load(std::memory_order_acquire)) {
+		return;
+	}
+	_head.store(head + 1, std::memory_order_release);
+}
+
+std::size_t PayloadQueue::Size() const
+{
+	// Head first; the tail can only move forward in the meantime
+	const std::size_t head = _head.load(std::memory_order_acquire);
+	return _tail.load(std::memory_order_acquire) - head;
+}
+
+}  // namespace Core
@@ -0,0 +1,21 @@
+#include "core/utility/triple_buffer.h"
+
+namespace Core
+{
+
+void TripleBuffer::Publish()
+{
+	const std::uint8_t prev = _middle.exchange(_back | NewDataFlag, std::memory_order_acq_rel);
+	_back = prev & IndexMask;
+}
+
+const TripleBuffer::Buffer & TripleBuffer::Read()
+{
+	if (_middle.load(std::memory_order_acquire) & NewDataFlag) {
+		const std::uint8_t prev = _middle.exchange(_front, std::memory_order_acq_rel);
+		_front = prev & IndexMask;
+	}
+	return _buffers[_front];
+}
+
+}  // namespace Core
@@ -62,6 +62,21 @@ void AttributeTable::Value(std::string_view uuid128,
 	Db.push_back(db);
 }
 
+void AttributeTable::ClientConfig()
+{
+	// Notifications and indications disabled
+	Attributes.emplace_back(std::make_unique<std::vector<std::uint8_t>>(2, 0));
+
+	esp_gatts_attr_db_t entry{.attr_control = ESP_GATT_AUTO_RSP,
+	                          .att_desc = {.uuid_length = ESP_UUID_LEN_16,
+	                                       .uuid_p = (std::uint8_t *)&ClientCharConfig,
+	                                       .perm = ESP_GATT_PERM_READ | ESP_GATT_PERM_WRITE,
+	                                       .max_length = 2,
+	                                       .length = 2,
+	                                       .value = Attributes.back()->data()}};
+	Db.push_back(entry);
+}
+
 AttributeTableBuilder AttributeTableBuilder::Build()
 {
 	return AttributeTableBuilder();
@@ -91,6 +106,12 @@ AttributeTableBuilder & AttributeTableBuilder::Value(std::string_view uuid128,
 	return *this;
 }
 
+AttributeTableBuilder & AttributeTableBuilder::ClientConfig()
+{
+	_table.ClientConfig();
+	return *this;
+}
+
 AttributeTable && AttributeTableBuilder::Finish()
 {
 	return std::move(_table);
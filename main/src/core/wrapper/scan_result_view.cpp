@@ -0,0 +1,106 @@
+#include "core/wrapper/scan_result_view.h"
+
+#include <algorithm>
+
+namespace Bt
+{
+
+EirView::Iterator::Iterator(std::span<const std::uint8_t> data)
+    : _rest(data)
+{
+	_Parse();
+}
+
+EirView::Iterator & EirView::Iterator::operator++()
+{
+	// [Length][Type][Data]; the length covers the type and data
+	_rest = _rest.subspan(_record.Data.size() + 2);
+	_Parse();
+	return *this;
+}
+
+EirView::Iterator EirView::Iterator::operator++(int)
+{
+	Iterator it = *this;
+	++(*this);
+	return it;
+}
+
+void EirView::Iterator::_Parse()
+{
+	if (_rest.size() < 2 || _rest[0] == 0 || _rest[0] + 1u > _rest.size() /* corrupted */) {
+		_rest = {};
+		return;
+	}
+	_record = Record{static_cast<esp_ble_adv_data_type>(_rest[1]), _rest.subspan(2, _rest[0] - 1)};
+}
+
+bool EirView::IsSingleRecord() const
+{
+	Iterator it = begin();
+	return it != end() && ++it == end();
+}
+
+std::optional<EirView::Record> EirView::Find(esp_ble_adv_data_type type) const
+{
+	auto it = std::find_if(begin(), end(), [type](const Record & r) { return r.Type == type; });
+	if (it == end()) {
+		return std::nullopt;
+	}
+	return *it;
+}
+
+std::span<const std::uint8_t, Mac::Size> ScanResultView::Bda() const
+{
+	return IsBle() ? std::span<const std::uint8_t, Mac::Size>(_ble->bda)
+	               : std::span<const std::uint8_t, Mac::Size>(_brEdr->bda);
+}
+
+std::optional<std::int8_t> ScanResultView::Rssi() const
+{
+	if (IsBle()) {
+		return static_cast<std::int8_t>(_ble->rssi);
+	}
+	const esp_bt_gap_dev_prop_t * prop = _FindProp(ESP_BT_GAP_DEV_PROP_RSSI);
+	if (prop == nullptr || prop->len < 1) {
+		return std::nullopt;
+	}
+	return *reinterpret_cast<const std::int8_t *>(prop->val);
+}
+
+bool ScanResultView::IsBlePublic() const
+{
+	return IsBle() && _ble->ble_addr_type == BLE_ADDR_TYPE_PUBLIC;
+}
+
+EirView ScanResultView::Eir() const
+{
+	if (IsBle()) {
+		const std::size_t length = std::min<std::size_t>(
+		    _ble->adv_data_len + _ble->scan_rsp_len, std::size(_ble->ble_adv));
+		return EirView(std::span<const std::uint8_t>(_ble->ble_adv, length));
+	}
+	const esp_bt_gap_dev_prop_t * prop = _FindProp(ESP_BT_GAP_DEV_PROP_EIR);
+	if (prop == nullptr || prop->len <= 0) {
+		return EirView({});
+	}
+	return EirView(std::span<const std::uint8_t>(static_cast<const std::uint8_t *>(prop->val),
+	                                             static_cast<std::size_t>(prop->len)));
+}
+
+Device ScanResultView::ToDevice() const
+{
+	return IsBle() ? Device(*_ble) : Device(*_brEdr);
+}
+
+const esp_bt_gap_dev_prop_t * ScanResultView::_FindProp(esp_bt_gap_dev_prop_type_t type) const
+{
+	for (int i = 0; i < _brEdr->num_prop; i++) {
+		if (_brEdr->prop[i].type == type) {
+			return &_brEdr->prop[i];
+		}
+	}
+	return nullptr;
+}
+
+}  // namespace Bt
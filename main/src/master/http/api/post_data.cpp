@@ -1,4 +1,8 @@
 #include "master/http/api/post_data.h"
+#include "core/filter_rules.h"
+#include "core/scan_schedule.h"
+#include "master/memory/irk_resolver.h"
+#include "master/memory/zones.h"
 
 #include <algorithm>
 #include <esp_log.h>
@@ -77,6 +81,32 @@ PostDataEntry DevicesPostDataView::Next()
 			return PostDataEntry(Type::ForceAdvertise(tData));
 		}
 		break;
+	case Type::ValueType::Zone:
+		if (Type::Zone::IsValid(tData)) {
+			// Variable length
+			Head += 1 + Type::Zone::Size(tData);
+			return PostDataEntry(Type::Zone(tData));
+		}
+		break;
+	case Type::ValueType::Irk:
+		if (Type::Irk::IsValid(tData)) {
+			Head += 1 + decltype(Type::Irk::Data)::extent;
+			return PostDataEntry(Type::Irk(tData));
+		}
+		break;
+	case Type::ValueType::ScanSchedule:
+		if (Type::ScanSchedule::IsValid(tData)) {
+			Head += 1 + decltype(Type::ScanSchedule::Data)::extent;
+			return PostDataEntry(Type::ScanSchedule(tData));
+		}
+		break;
+	case Type::ValueType::FilterRules:
+		if (Type::FilterRules::IsValid(tData)) {
+			// Variable length
+			Head += 1 + Type::FilterRules::Size(tData);
+			return PostDataEntry(Type::FilterRules(tData));
+		}
+		break;
 	}
 	return PostDataEntry(std::monostate{});
 }
@@ -182,6 +212,108 @@ bool ForceAdvertise::IsValid(std::span<const std::uint8_t> data)
 	return (data.size() >= 6);
 }
 
+Zone::Zone(std::span<const std::uint8_t> data)
+    : Data(data.first(Size(data)))
+{
+}
+
+std::uint8_t Zone::Id() const
+{
+	return Data[0];
+}
+
+std::span<const std::uint8_t> Zone::Definition() const
+{
+	return (Data[1] == 0) ? std::span<const std::uint8_t>() : Data.subspan(1);
+}
+
+bool Zone::IsValid(std::span<const std::uint8_t> data)
+{
+	if ((data.size() < MinSize) || (data[0] >= ::Master::Zone::MaxZones)) {
+		return false;
+	}
+	const std::size_t count = data[1];
+	if (count == 0) {
+		return true;
+	}
+	return (count >= 2) && (count <= ::Master::Zone::MaxVertices)
+	       && (data.size() >= 1 + ::Master::Zone::DefinitionSize(count));
+}
+
+std::size_t Zone::Size(std::span<const std::uint8_t> data)
+{
+	const std::size_t count = data[1];
+	return (count == 0) ? MinSize : (1 + ::Master::Zone::DefinitionSize(count));
+}
+
+Irk::Irk(std::span<const std::uint8_t> data)
+    : Data(data.first<Size>())
+{
+}
+
+std::uint8_t Irk::Id() const
+{
+	return Data[0];
+}
+
+std::span<const std::uint8_t, 22> Irk::Definition() const
+{
+	return Data.subspan<1>();
+}
+
+bool Irk::IsRemove() const
+{
+	const auto key = Data.last<::Master::Irk::KeySize>();
+	return std::all_of(key.begin(), key.end(), [](std::uint8_t b) { return b == 0; });
+}
+
+bool Irk::IsValid(std::span<const std::uint8_t> data)
+{
+	static_assert(Size == 1 + ::Master::Irk::Size);
+	return (data.size() >= Size) && (data[0] < ::Master::Irk::MaxIrks);
+}
+
+ScanSchedule::ScanSchedule(std::span<const std::uint8_t> data)
+    : Data(data.first<Size>())
+{
+}
+
+std::span<const std::uint8_t, 6> ScanSchedule::Mac() const
+{
+	return Data.first<6>();
+}
+
+std::span<const std::uint8_t, 6> ScanSchedule::Schedule() const
+{
+	return Data.last<6>();
+}
+
+bool ScanSchedule::IsValid(std::span<const std::uint8_t> data)
+{
+	return (data.size() >= Size) && Core::ScanSchedule::Parse(data.subspan(6, 6)).has_value();
+}
+
+FilterRules::FilterRules(std::span<const std::uint8_t> data)
+    : Data(data.first(Size(data)))
+{
+}
+
+std::span<const std::uint8_t> FilterRules::Rules() const
+{
+	return Data.subspan(1);
+}
+
+bool FilterRules::IsValid(std::span<const std::uint8_t> data)
+{
+	return (data.size() >= MinSize) && (data.size() >= Size(data))
+	       && Core::FilterRules::IsValid(data.subspan(1, data[0]));
+}
+
+std::size_t FilterRules::Size(std::span<const std::uint8_t> data)
+{
+	return 1 + data[0];
+}
+
 }  // namespace Type
 
 }  // namespace Master::HttpApi
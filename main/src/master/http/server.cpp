@@ -18,9 +18,24 @@ void HttpServer::Init()
 	_impl->Init();
 }
 
-void HttpServer::SetDevicesGetData(std::span<const char> data)
+std::vector<std::uint8_t> & HttpServer::DevicesGetDataBuffer()
 {
-	_impl->SetDevicesGetData(data);
+	return _impl->DevicesGetDataBuffer();
+}
+
+void HttpServer::PublishDevicesGetData()
+{
+	_impl->PublishDevicesGetData();
+}
+
+std::vector<std::uint8_t> & HttpServer::ZoneEventsGetDataBuffer()
+{
+	return _impl->ZoneEventsGetDataBuffer();
+}
+
+void HttpServer::PublishZoneEventsGetData()
+{
+	_impl->PublishZoneEventsGetData();
 }
 
 void HttpServer::SetConfigPostListener(std::function<void(std::span<const char>)> fn)
@@ -28,6 +43,12 @@ void HttpServer::SetConfigPostListener(std::function<void(std::span<const char>)
 	_impl->SetConfigPostListener(fn);
 }
 
+void HttpServer::SetHistoryGetListener(
+    std::function<bool(const Mac &, std::vector<std::uint8_t> &)> fn)
+{
+	_impl->SetHistoryGetListener(fn);
+}
+
 void HttpServer::SwitchMode(WifiOpMode mode)
 {
 	_impl->SwitchMode(mode);
@@ -3,8 +3,11 @@
 #include "core/utility/mac.h"
 #include "core/wrapper/wifi.h"
 #include "master/http/index_page.h"
+#include "master/memory/zones.h"
 
 #include <algorithm>
+#include <cstdlib>
+#include <cstring>
 #include <functional>
 
 #include <esp_eap_client.h>
@@ -92,8 +95,6 @@ namespace Master::Impl
 HttpServer::HttpServer(const WifiConfig & cfg)
     : _cfg(cfg)
 {
-	// the largest data should be from NoProcessingMemory - around 7810B.
-	_rawData.reserve(8192);
 }
 
 HttpServer::~HttpServer()
@@ -128,8 +129,10 @@ esp_err_t HttpServer::GetIndexHandler(httpd_req_t * r)
 
 esp_err_t HttpServer::GetDevicesHandler(httpd_req_t * r)
 {
+	// HTTPd handles requests in a single task - the only reader
+	const auto & data = _devicesData.Read();
 	httpd_resp_set_type(r, "text/plain");
-	httpd_resp_send(r, _rawData.data(), _rawData.size());
+	httpd_resp_send(r, reinterpret_cast<const char *>(data.data()), data.size());
 	return ESP_OK;
 }
 
@@ -144,7 +147,7 @@ esp_err_t HttpServer::PostConfigHandler(httpd_req_t * r)
 
 	std::size_t read = 0;
 	while (read < r->content_len) {
-		int singleRead = httpd_req_recv(r, data.data() + read, r->content_len);
+		int singleRead = httpd_req_recv(r, data.data() + read, r->content_len - read);
 		if (singleRead <= 0) {
 			httpd_resp_send_err(r, HTTPD_500_INTERNAL_SERVER_ERROR, "Failed reading post data");
 			return ESP_FAIL;
@@ -158,11 +161,77 @@ esp_err_t HttpServer::PostConfigHandler(httpd_req_t * r)
 	return ESP_OK;
 }
 
-void HttpServer::SetDevicesGetData(std::span<const char> data)
+esp_err_t HttpServer::GetHistoryHandler(httpd_req_t * r)
 {
-	_rawData.resize(data.size());
-	ESP_LOGD(TAG, "Setting data, length %d", data.size());
-	std::copy(data.begin(), data.end(), _rawData.data());
+	std::array<char, QueryLengthLimit> query;
+	std::array<char, QueryLengthLimit> value;
+	if (httpd_req_get_url_query_str(r, query.data(), query.size()) != ESP_OK
+	    || httpd_query_key_value(query.data(), "mac", value.data(), value.size()) != ESP_OK) {
+		httpd_resp_send_err(r, HTTPD_400_BAD_REQUEST, "Missing mac");
+		return ESP_FAIL;
+	}
+
+	const auto mac = ParseMac(value.data());
+	if (!mac.has_value()) {
+		httpd_resp_send_err(r, HTTPD_400_BAD_REQUEST, "Invalid mac");
+		return ESP_FAIL;
+	}
+
+	if (!_getHistoryListener || !_getHistoryListener(mac.value(), _historyData)) {
+		httpd_resp_send_err(r, HTTPD_404_NOT_FOUND, "No history");
+		return ESP_FAIL;
+	}
+	httpd_resp_set_type(r, "application/octet-stream");
+	httpd_resp_send(r, reinterpret_cast<const char *>(_historyData.data()), _historyData.size());
+	return ESP_OK;
+}
+
+esp_err_t HttpServer::GetZoneEventsHandler(httpd_req_t * r)
+{
+	// Only events newer than `since` are sent
+	std::uint32_t since = 0;
+	std::array<char, QueryLengthLimit> query;
+	std::array<char, QueryLengthLimit> value;
+	if (httpd_req_get_url_query_str(r, query.data(), query.size()) == ESP_OK
+	    && httpd_query_key_value(query.data(), "since", value.data(), value.size()) == ESP_OK) {
+		since = std::strtoul(value.data(), nullptr, 10);
+	}
+
+	// Events are ordered by their sequence number
+	const auto & data = _zoneEventsData.Read();
+	std::size_t offset = 0;
+	for (; offset < data.size(); offset += ZoneEvent::Size) {
+		std::uint32_t seq;
+		std::memcpy(&seq, data.data() + offset + ZoneEvent::SeqIdx, sizeof(seq));
+		if (seq > since) {
+			break;
+		}
+	}
+
+	httpd_resp_set_type(r, "application/octet-stream");
+	httpd_resp_send(r, reinterpret_cast<const char *>(data.data() + offset), data.size() - offset);
+	return ESP_OK;
+}
+
+std::vector<std::uint8_t> & HttpServer::DevicesGetDataBuffer()
+{
+	return _devicesData.WriteBuffer();
+}
+
+void HttpServer::PublishDevicesGetData()
+{
+	ESP_LOGD(TAG, "Publishing data, length %d", _devicesData.WriteBuffer().size());
+	_devicesData.Publish();
+}
+
+std::vector<std::uint8_t> & HttpServer::ZoneEventsGetDataBuffer()
+{
+	return _zoneEventsData.WriteBuffer();
+}
+
+void HttpServer::PublishZoneEventsGetData()
+{
+	_zoneEventsData.Publish();
 }
 
 void HttpServer::SetConfigPostListener(std::function<void(std::span<const char>)> fn)
@@ -170,6 +239,12 @@ void HttpServer::SetConfigPostListener(std::function<void(std::span<const char>)
 	_postConfigListener = fn;
 }
 
+void HttpServer::SetHistoryGetListener(
+    std::function<bool(const Mac &, std::vector<std::uint8_t> &)> fn)
+{
+	_getHistoryListener = fn;
+}
+
 void HttpServer::SwitchMode(WifiOpMode mode)
 {
 	if (_cfg.Mode != mode) {
@@ -319,6 +394,11 @@ void HttpServer::_InitHttp()
 {
 	httpd_config_t cfg = HTTPD_DEFAULT_CONFIG();
 	cfg.lru_purge_enable = true;
+	cfg.stack_size = _cfg.ServerTask.StackSize;
+	cfg.task_priority = _cfg.ServerTask.Priority;
+	if (_cfg.ServerTask.Core >= 0 && _cfg.ServerTask.Core < portNUM_PROCESSORS) {
+		cfg.core_id = _cfg.ServerTask.Core;
+	}
 	ESP_ERROR_CHECK(httpd_start(&_handle, &cfg));
 	assert(_handle != nullptr);
 
@@ -340,10 +420,24 @@ void HttpServer::_InitHttp()
 	    .handler = &HandlerPassthrough<&HttpServer::PostConfigHandler>,
 	    .user_ctx = this,
 	};
+	const httpd_uri_t getHistory{
+	    .uri = HistoryUri.data(),
+	    .method = httpd_method_t::HTTP_GET,
+	    .handler = &HandlerPassthrough<&HttpServer::GetHistoryHandler>,
+	    .user_ctx = this,
+	};
+	const httpd_uri_t getZoneEvents{
+	    .uri = ZoneEventsUri.data(),
+	    .method = httpd_method_t::HTTP_GET,
+	    .handler = &HandlerPassthrough<&HttpServer::GetZoneEventsHandler>,
+	    .user_ctx = this,
+	};
 
 	ESP_ERROR_CHECK(httpd_register_uri_handler(_handle, &getIndex));
 	ESP_ERROR_CHECK(httpd_register_uri_handler(_handle, &getDevices));
 	ESP_ERROR_CHECK(httpd_register_uri_handler(_handle, &postConfig));
+	ESP_ERROR_CHECK(httpd_register_uri_handler(_handle, &getHistory));
+	ESP_ERROR_CHECK(httpd_register_uri_handler(_handle, &getZoneEvents));
 }
 
 }  // namespace Master::Impl
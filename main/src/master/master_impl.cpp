@@ -18,6 +18,7 @@
 #include <freertos/projdefs.h>
 #include <freertos/task.h>
 #include <freertos/timers.h>
+#include <sdkconfig.h>
 
 #include <algorithm>
 #include <cmath>
@@ -33,14 +34,31 @@ constexpr std::uint16_t MasterAppId = 0;
 /// @brief Logger tag
 static const char * TAG = "Master";
 
-static void UpdateScannersTask(void * pvParameters)
+/// @brief How long to wait for the memory task to answer a history request
+constexpr TickType_t HistoryRequestTimeout = pdMS_TO_TICKS(1'000);
+
+/// @brief How often to check, whether some scanner should advertise
+constexpr TickType_t AdvertiseCheckInterval = pdMS_TO_TICKS(10'000);
+
+/// @brief Queued payload kind: the record format (`Core::Compact` version), with this bit set
+/// for read frames (`Core::Frames`)
+constexpr std::uint8_t FramedPayload = 0x80;
+
+/// @brief Connection ids tracked by `_pendingRemovals` (bit per id)
+constexpr std::size_t PendingRemovalBits = std::numeric_limits<std::uint32_t>::digits;
+static_assert(CONFIG_BT_ACL_CONNECTIONS <= PendingRemovalBits,
+              "Every GATTc connection id needs a bit in _pendingRemovals");
+
+static void MemoryTask(void * pvParameters)
 {
-	reinterpret_cast<Master::Impl::App *>(pvParameters)->UpdateScannersLoop();
+	reinterpret_cast<Master::Impl::App *>(pvParameters)->MemoryLoop();
 }
 
-static void UpdateDeviceDataTask(void * pvParameters)
+/// @brief Ticks remaining until a deadline (0 if it already passed)
+static TickType_t TicksUntil(TickType_t now, TickType_t deadline)
 {
-	reinterpret_cast<Master::Impl::App *>(pvParameters)->UpdateDeviceDataLoop();
+	const auto diff = static_cast<std::int32_t>(deadline - now);  // handles overflow
+	return (diff > 0) ? static_cast<TickType_t>(diff) : 0;
 }
 
 }  // namespace
@@ -54,6 +72,7 @@ App::App(const AppConfig & cfg)
     , _memory(_cfg.DeviceMemoryCfg.NoPositionCalculation
                   ? static_cast<IDeviceMemory *>(new NoProcessingMemory(_cfg.DeviceMemoryCfg))
                   : static_cast<IDeviceMemory *>(new DeviceMemory(_cfg.DeviceMemoryCfg)))
+    , _readQueue(_cfg.GattReadQueueDepth)
 {
 }
 
@@ -66,12 +85,20 @@ void App::Init()
 {
 	// Reserve enough space, otherwise BTC will run out of it while allocating it himself for
 	// some reason
-	_tmpSerializedData.reserve(Core::DeviceDataView::Size * DeviceMemory::MaximumDevices);
+	_tmpSerializedData.reserve(
+	    Core::DeviceDataView::Size
+	    * std::min<std::size_t>(_cfg.DeviceMemoryCfg.MaxDevices, Core::DefaultMaxDevices));
+	_decodedRecords.reserve(Core::DeviceDataView::Size * Core::Compact::MaxIds);
 	_tmpScanners.reserve(10);
 
-	// Mutex for DeviceMemory
-	_memMutex = xSemaphoreCreateMutex();
-	assert(_memMutex != nullptr);
+	_scanners.reserve(_cfg.DeviceMemoryCfg.MaxScanners);
+	_readTargets.reserve(_cfg.DeviceMemoryCfg.MaxScanners);
+
+	// Message queue for the memory task
+	_memQueue = xQueueCreate(_cfg.MemoryQueueDepth, sizeof(MemoryMsg));
+	assert(_memQueue != nullptr);
+	_historyQueue = xQueueCreate(1, sizeof(Msg::HistoryReply));
+	assert(_historyQueue != nullptr);
 
 	Bt::EnableBtController();
 	Bt::EnableBluedroid();
@@ -85,24 +112,18 @@ void App::Init()
 		vTaskStartScheduler();
 	}
 
-	constexpr auto StackSize1 = std::max(static_cast<std::uint32_t>(24'576),
-	                                     static_cast<std::uint32_t>(configMINIMAL_STACK_SIZE));
-	// Task for updating scanners
-	auto ret = xTaskCreate(UpdateScannersTask, "Scanners loop", StackSize1, this, tskIDLE_PRIORITY,
-	                       &_updateScannersTask);
-	assert(ret == pdPASS);
-
-	constexpr auto StackSize2 = std::max(static_cast<std::uint32_t>(24'576),
-	                                     static_cast<std::uint32_t>(configMINIMAL_STACK_SIZE));
-	// Task for reading scanner data
-	ret = xTaskCreate(UpdateDeviceDataTask, "Read loop", StackSize2, this, tskIDLE_PRIORITY,
-	                  &_readDevTask);
-	assert(ret == pdPASS);
+	// Task owning the memory
+	const bool created =
+	    Core::CreateTask(MemoryTask, "Memory loop", _cfg.MemoryTaskCfg, this, &_memTask);
+	assert(created);
 
 	// Init http
 	_httpServer.Init();
 	_httpServer.SetConfigPostListener(
 	    [&](std::span<const char> data) { OnHttpServerUpdate(data); });
+	_httpServer.SetHistoryGetListener([&](const Mac & mac, std::vector<std::uint8_t> & output) {
+		return OnHttpHistoryRequest(mac, output);
+	});
 
 	// Scan for scanners
 	_ScanForScanners();
@@ -122,33 +143,58 @@ void App::OnHttpServerUpdate(std::span<const char> data)
 		    // Don't implement auto so we get a compile time error if an implementation is missing
 		    Overload{
 		        [&](const HttpApi::Type::SystemMsg & t) { _ProcessSystemMessage(t.Value()); },
+		        // The NVS cache is owned by the memory task
 		        [&](const HttpApi::Type::RefPathLoss & t) {
-			        Nvs::Cache::Instance().SetRefPathLoss(t.Mac(), t.Value());
+			        _Send(Msg::UpdateCalibration{Mac(t.Mac()), t.Value(), std::nullopt},
+			              BlockTimeInCallback);
 		        },
 		        [&](const HttpApi::Type::EnvFactor & t) {
-			        Nvs::Cache::Instance().SetEnvFactor(t.Mac(), t.Value());
+			        _Send(Msg::UpdateCalibration{Mac(t.Mac()), std::nullopt, t.Value()},
+			              BlockTimeInCallback);
 		        },
 		        [&](const HttpApi::Type::MacName & t) {
-			        Nvs::Cache::Instance().SetMacName(t.Mac(), t.Value());
+			        static_assert(HttpApi::Type::MacName::MaxValueLength
+			                      <= Msg::SetMacName::MaxLength);
+			        Msg::SetMacName msg{Mac(t.Mac()), {},
+			                            static_cast<std::uint8_t>(t.Value().size())};
+			        std::ranges::copy(t.Value(), msg.Name.begin());
+			        _Send(msg, BlockTimeInCallback);
 		        },
 		        [&](const HttpApi::Type::ForceAdvertise & t) {
 			        ESP_LOGI(TAG, "Force Advertise for %s", ToString(t.Mac()).c_str());
-			        if (xSemaphoreTake(_memMutex, BlockTimeInCallback)) {
-				        _memory->VisitScanners([&, m = Mac(t.Mac())](const ScannerInfo & info) {
-					        if (info.Bda == m) {
-						        ESP_LOGI(TAG, "Switching %s to advertising state",
-						                 ToString(m).c_str());
-						        std::uint8_t val = Gatt::StateChar::Advertise;
-						        esp_ble_gattc_write_char(
-						            _gattcApp->GattIf, info.ConnId, info.Service.StateChar, 1, &val,
-						            ESP_GATT_WRITE_TYPE_RSP, ESP_GATT_AUTH_REQ_NONE);
-					        }
-				        });
-				        xSemaphoreGive(_memMutex);
+			        _Send(Msg::ForceAdvertise{Mac(t.Mac())}, BlockTimeInCallback);
+		        },
+		        [&](const HttpApi::Type::Zone & t) {
+			        if (t.Definition().empty()) {
+				        Nvs::EraseZone(t.Id());
 			        }
 			        else {
-				        ESP_LOGW(TAG, "Couldn't take memory mtx (force advertise canceled)");
+				        Nvs::SetZone(t.Id(), t.Definition());
 			        }
+			        _Send(Msg::UpdateZone{t.Id()}, BlockTimeInCallback);
+		        },
+		        [&](const HttpApi::Type::Irk & t) {
+			        if (t.IsRemove()) {
+				        Nvs::EraseIrk(t.Id());
+			        }
+			        else {
+				        Nvs::SetIrk(t.Id(), t.Definition());
+			        }
+			        _Send(Msg::UpdateIrk{t.Id()}, BlockTimeInCallback);
+		        },
+		        [&](const HttpApi::Type::FilterRules & t) {
+			        if (t.Rules().empty()) {
+				        Nvs::EraseFilterRules();
+			        }
+			        else {
+				        Nvs::SetFilterRules(t.Rules());
+			        }
+			        _Send(Msg::UpdateFilterRules{}, BlockTimeInCallback);
+		        },
+		        [&](const HttpApi::Type::ScanSchedule & t) {
+			        Msg::SetScanSchedule msg{Mac(t.Mac()), {}};
+			        std::ranges::copy(t.Schedule(), msg.Value.begin());
+			        _Send(msg, BlockTimeInCallback);
 		        },
 		        [&](std::monostate t) {},
 		    },
@@ -156,29 +202,51 @@ void App::OnHttpServerUpdate(std::span<const char> data)
 	}
 }
 
-void App::GapBleScanResult(const Gap::Ble::Type::ScanResult & p)
+bool App::OnHttpHistoryRequest(const Mac & mac, std::vector<std::uint8_t> & output)
 {
-	const Bt::Device device(p);
-
-	if (xSemaphoreTake(_memMutex, BlockTimeInCallback)) {
-		const bool IsConnectedScanner = _memory->IsConnectedScanner(device);  // Read
-		xSemaphoreGive(_memMutex);
+	const std::uint32_t seq = ++_historySeq;
+	if (!_Send(Msg::GetHistory{mac, seq}, HistoryRequestTimeout)) {
+		return false;
+	}
 
-		if (!IsConnectedScanner && _IsScanner(device)) {
-			// New scanner
-			ESP_LOGI(TAG, "Found scanner (%s)", ToString(device.Bda).c_str());
-			// We have to stop scanning while connecting, BUT we can't
-			// connect before we actually stop scanning (it takes a while).
-			// So we have to move it to GapBleScanStopCmpl().
-			_scannerToConnect = device.Bda;
-			_bleGap.StopScanning();
+	const TickType_t deadline = xTaskGetTickCount() + HistoryRequestTimeout;
+	while (xQueueReceive(_historyQueue, &_httpHistoryReply,
+	                     TicksUntil(xTaskGetTickCount(), deadline))
+	       == pdTRUE) {
+		if (_httpHistoryReply.Seq != seq) {
+			continue;  // Late reply to an older request, which timed out
+		}
+		if (!_httpHistoryReply.Found) {
+			return false;
 		}
-		// ... otherwise it's some device and we don't care
+		_httpHistoryReply.History.Serialize(mac, output);
+		return true;
 	}
-	else {
-		ESP_LOGD(TAG, "Mtx take fail (GapScanRes)");
+	ESP_LOGW(TAG, "History request for %s timed out", ToString(mac).c_str());
+	return false;
+}
+
+void App::GapBleScanResult(const Gap::Ble::Type::ScanResult & p)
+{
+	const Bt::ScanResultView device(p);
+	const Mac bda(device.Bda());
+
+	const bool isConnectedScanner =
+	    std::find_if(_scanners.begin(), _scanners.end(), [&](const ScannerInfo & info) {
+		    return info.Bda == bda;
+	    }) != _scanners.end();
+
+	if (!isConnectedScanner && _IsScanner(device)) {
+		// New scanner
+		ESP_LOGI(TAG, "Found scanner (%s)", ToString(bda).c_str());
+		// We have to stop scanning while connecting, BUT we can't
+		// connect before we actually stop scanning (it takes a while).
+		// So we have to move it to GapBleScanStopCmpl().
+		_scannerToConnect = bda;
+		_bleGap.StopScanning();
 	}
-	ESP_LOGD(TAG, "ScanRes: %s", ToString(device).c_str());
+	// ... otherwise it's some device and we don't care
+	ESP_LOGD(TAG, "ScanRes: %s", ToString(device.ToDevice()).c_str());
 }
 
 void App::GapBleScanStopCmpl(const Gap::Ble::Type::ScanStopCmpl & p)
@@ -237,6 +305,23 @@ void App::GattcOpen(const Gattc::Type::Open & p)
 	esp_ble_gap_update_conn_params(&params);
 }
 
+void App::GattcCfgMtu(const Gattc::Type::CfgMtu & p)
+{
+	if (p.status != ESP_GATT_OK) {
+		ESP_LOGW(TAG, "MTU exchange failed (%d), conn id %d", p.status, p.conn_id);
+		return;
+	}
+	ESP_LOGI(TAG, "MTU %d, conn id %d", p.mtu, p.conn_id);
+	const auto byConnId = [&p](const ScannerInfo & info) { return info.ConnId == p.conn_id; };
+	if (auto it = std::ranges::find_if(_tmpScanners, byConnId); it != _tmpScanners.end()) {
+		it->Mtu = p.mtu;  // Still searching the service
+	}
+	else if (auto it = std::ranges::find_if(_scanners, byConnId); it != _scanners.end()) {
+		it->Mtu = p.mtu;
+		_StartStreaming(*it);
+	}
+}
+
 void App::GattcCancelOpen()
 {
 	// couldn't connect, restart scan
@@ -247,18 +332,19 @@ void App::GattcDisconnect(const Gattc::Type::Disconnect & p)
 {
 	ESP_LOGI(TAG, "Disconnect (%d)", p.reason);
 
-	if (xSemaphoreTake(_memMutex, portMAX_DELAY)) {  // this HAS to be taken
-		_memory->RemoveScanner(p.conn_id);           // Write
-		xSemaphoreGive(_memMutex);
-	}
-	else {
-		ESP_LOGW(TAG, "Mtx take fail (GattcDisconnect), unsynchronized write");
+	std::erase_if(_scanners,
+	              [connId = p.conn_id](const ScannerInfo & info) { return info.ConnId == connId; });
 
-		// We might as well try to do an unsynchronized write. It might fail and restart,
-		// but we don't care at that point.
-		// TODO: Should fix this by trying to mark the scanner as unused in the memory and
-		// deleting it from somewhere else.
-		_memory->RemoveScanner(p.conn_id);
+	// This can't get lost, but blocking the BT stack could deadlock the memory task (it posts
+	// GATT requests); leave it for the memory task to pick up instead
+	if (!_Send(Msg::RemoveScanner{p.conn_id}, BlockTimeInCallback)) {
+		if (p.conn_id >= PendingRemovalBits) {
+			ESP_LOGE(TAG, "Scanner removal lost (connection %d)", p.conn_id);
+			return;
+		}
+		_pendingRemovals.fetch_or(1u << p.conn_id, std::memory_order_release);
+		const MemoryMsg wakeup = Msg::Payloads{};
+		xQueueSend(_memQueue, &wakeup, 0);
 	}
 }
 
@@ -283,33 +369,74 @@ void App::GattcReadChar(const Gattc::Type::ReadChar & p)
 	if (p.value_len == 0) {
 		return;
 	}
+	auto it = std::find_if(_scanners.begin(), _scanners.end(),
+	                       [&p](const ScannerInfo & info) { return info.ConnId == p.conn_id; });
+	std::uint8_t kind = Core::Compact::LegacyVersion;
+	if (it != _scanners.end()) {
+		kind = it->Format | (it->Framed ? FramedPayload : 0);
+	}
+	_QueuePayload(p.conn_id, std::span(p.value, p.value_len), kind);
+}
 
-	// Responses from scanners
-	if ((p.value_len % Core::DeviceDataView::Size) != 0) {
-		if (xSemaphoreTake(_memMutex, BlockTimeInCallback)) {
-			const auto * scanner = _memory->GetScanner(p.conn_id);  // Read
-			xSemaphoreGive(_memMutex);
-
-			ESP_LOGW(TAG, "Received incorrect data size from %s (%d %% %d != 0)",
-			         scanner ? ToString(scanner->Bda).c_str() : "UNKNOWN", p.value_len,
-			         Core::DeviceDataView::Size);
-		}
-		else {
-			ESP_LOGW(TAG, "Received incorrect data size from scanner conn id %d (%d %% %d != 0)",
-			         p.conn_id, p.value_len, Core::DeviceDataView::Size);
-		}
+void App::GattcNotify(const Gattc::Type::Notify & p)
+{
+	auto it = std::find_if(_scanners.begin(), _scanners.end(),
+	                       [&p](const ScannerInfo & info) { return info.ConnId == p.conn_id; });
+	if (it == _scanners.end() || p.handle != it->Service.DevicesChar) {
+		return;
+	}
+	if (p.value_len < Gatt::DevicesStreamHeaderSize) {
+		ESP_LOGW(TAG, "Invalid notification from scanner conn id %d (%d)", p.conn_id,
+		         p.value_len);
 		return;
 	}
 
-	// Assume its an array of devices
-	Core::DeviceDataView::Array data(std::span(p.value, p.value_len));
+	// Records are removed from the scanner once sent, so a gap means lost records
+	const std::uint16_t seq = p.value[0] | (p.value[1] << 8);
+	if (seq != it->NextSeq) {
+		ESP_LOGW(TAG, "Lost %d payloads from scanner conn id %d",
+		         static_cast<std::uint16_t>(seq - it->NextSeq), p.conn_id);
+	}
+	it->NextSeq = seq + 1;
+
+	const std::span data(p.value + Gatt::DevicesStreamHeaderSize,
+	                     p.value_len - Gatt::DevicesStreamHeaderSize);
+	if (!data.empty()) {
+		_QueuePayload(p.conn_id, data, it->Format);
+	}
+}
 
-	if (xSemaphoreTake(_memMutex, BlockTimeInCallback)) {
-		_memory->UpdateDistance(p.conn_id, data);  // Write
-		xSemaphoreGive(_memMutex);
+void App::GattcWriteChar(const Gattc::Type::WriteChar & p)
+{
+	auto it = std::find_if(_scanners.begin(), _scanners.end(),
+	                       [&p](const ScannerInfo & info) { return info.ConnId == p.conn_id; });
+	if (it == _scanners.end() || p.handle != it->Service.DevicesChar || it->Framed) {
+		return;
+	}
+	// Confirmed format change; the Scanner sends the format and frames its reads from now on
+	if (p.status == ESP_GATT_OK) {
+		it->Format =
+		    _cfg.CompactRecords ? Core::Compact::StatsVersion : Core::Compact::LegacyVersion;
+		it->Framed = true;
+		ESP_LOGI(TAG, "Scanner conn id %d sends format %d", p.conn_id, it->Format);
 	}
 	else {
-		ESP_LOGD(TAG, "Mtx take fail (GattcRead)");
+		ESP_LOGI(TAG, "Scanner conn id %d doesn't support formats (%d)", p.conn_id, p.status);
+	}
+}
+
+void App::GattcWriteDescr(const Gattc::Type::WriteDescr & p)
+{
+	if (p.status == ESP_GATT_OK) {
+		return;
+	}
+	auto it = std::find_if(_scanners.begin(), _scanners.end(),
+	                       [&p](const ScannerInfo & info) { return info.ConnId == p.conn_id; });
+	if (it != _scanners.end() && p.handle == it->Service.DevicesCccd) {
+		// It wouldn't be read either; reconnect
+		ESP_LOGW(TAG, "Couldn't subscribe to scanner conn id %d (%d). Disconnecting...",
+		         p.conn_id, p.status);
+		_gattc.Disconnect(MasterAppId, p.conn_id);
 	}
 }
 
@@ -324,8 +451,8 @@ void App::GattcSearchCmpl(const Gattc::Type::SearchCmpl & p)
 	}
 
 	// Get Characteristics from local cache
-	std::uint16_t count = Gatt::ScannerServiceCharCount;
-	esp_gattc_char_elem_t result[Gatt::ScannerServiceCharCount];
+	std::uint16_t count = Gatt::ScannerServiceMaxCharCount;
+	esp_gattc_char_elem_t result[Gatt::ScannerServiceMaxCharCount];
 	esp_gatt_status_t err =
 	    esp_ble_gattc_get_all_char(_gattcApp->GattIf, p.conn_id, sIt->Service.StartHandle,
 	                               sIt->Service.EndHandle, result, &count, 0);
@@ -362,6 +489,12 @@ void App::GattcSearchCmpl(const Gattc::Type::SearchCmpl & p)
 		else if (result[i].uuid == Gatt::TimestampCharacteristicArray) {
 			sIt->Service.TimestampChar = result[i].char_handle;
 		}
+		else if (result[i].uuid == Gatt::ScanCharacteristicArray) {
+			sIt->Service.ScanChar = result[i].char_handle;
+		}
+		else if (result[i].uuid == Gatt::FilterCharacteristicArray) {
+			sIt->Service.FilterChar = result[i].char_handle;
+		}
 		else {
 			ESP_LOGW(TAG, "Unknown characteristic, incompatible Scanner (%s). Disconnecting...",
 			         ToString(result[i].uuid).c_str());
@@ -371,6 +504,18 @@ void App::GattcSearchCmpl(const Gattc::Type::SearchCmpl & p)
 	}
 	ESP_LOGI(TAG, "Saved characteristic handles");
 
+	// Confirmed before any data is sent (GATT requests are sequential); see GattcWriteChar
+	std::uint8_t command[2] = {
+	    Gatt::DevicesControl::SetFormat,
+	    _cfg.CompactRecords ? Core::Compact::StatsVersion : Core::Compact::LegacyVersion};
+	esp_ble_gattc_write_char(_gattcApp->GattIf, p.conn_id, sIt->Service.DevicesChar,
+	                         sizeof(command), command, ESP_GATT_WRITE_TYPE_RSP,
+	                         ESP_GATT_AUTH_REQ_NONE);
+
+	if (_cfg.Transfer != ScannerTransfer::Read && !_SubscribeDevices(*sIt)) {
+		ESP_LOGI(TAG, "Scanner doesn't support notifications, reading it periodically");
+	}
+
 	// Set scanner time right away
 	std::uint32_t timestamp = Core::ToUnix(Core::Clock::now());
 	esp_ble_gattc_write_char(_gattcApp->GattIf, p.conn_id, sIt->Service.TimestampChar, 4,
@@ -378,12 +523,11 @@ void App::GattcSearchCmpl(const Gattc::Type::SearchCmpl & p)
 	                         ESP_GATT_WRITE_TYPE_NO_RSP, ESP_GATT_AUTH_REQ_NONE);
 
 	// Scanner info filled, add it and remove the temporary
-	if (xSemaphoreTake(_memMutex, BlockTimeInCallback)) {
-		_memory->AddScanner(*sIt);  // Write
-		xSemaphoreGive(_memMutex);
+	if (_Send(Msg::AddScanner{*sIt}, BlockTimeInCallback)) {
+		_scanners.push_back(*sIt);
+		_StartStreaming(_scanners.back());
 	}
 	else {
-		ESP_LOGD(TAG, "Mtx take fail (GattcSearchCmpl)");
 		_gattc.Disconnect(MasterAppId, p.conn_id);
 	}
 	_tmpScanners.erase(sIt);
@@ -412,109 +556,130 @@ void App::GattcSearchRes(const Gattc::Type::SearchRes & p)
 	}
 }
 
-void App::UpdateScannersLoop()
+void App::MemoryLoop()
 {
-	// Check in regular intervals, if some scanner is missing an RSSI to another one.
-	// If so, set its State characteristic to "Advertise".
-	constexpr TickType_t Delay = pdMS_TO_TICKS(10'000);
+	const TickType_t start = xTaskGetTickCount();
+	TickType_t nextRead = start + pdMS_TO_TICKS(_cfg.GattReadInterval);
+	TickType_t nextAdvertiseCheck = start + AdvertiseCheckInterval;
+
+	const TickType_t statsInterval = pdMS_TO_TICKS(_cfg.TaskStatsInterval);
+	TickType_t nextStats = start + statsInterval;
+
+	// Zones, IRKs and filter rules are only stored in NVS
+	for (std::uint8_t id = 0; id < Zone::MaxZones; id++) {
+		_LoadZone(id);
+	}
+	for (std::uint8_t id = 0; id < Irk::MaxIrks; id++) {
+		_LoadIrk(id);
+	}
+	_LoadFilterRules();
+
+	MemoryMsg msg;
 	for (;;) {
-		vTaskDelay(Delay);
+		TickType_t now = xTaskGetTickCount();
+		TickType_t wait = std::min(TicksUntil(now, nextRead), TicksUntil(now, nextAdvertiseCheck));
+		if (statsInterval > 0) {
+			wait = std::min(wait, TicksUntil(now, nextStats));
+		}
 
-		// Check if some scanners need to advertise
-		if (!xSemaphoreTake(_memMutex, portMAX_DELAY)) {
-			ESP_LOGD(TAG, "Mtx take fail (UpdateScannersLoop)");
-			continue;
+		const bool received = xQueueReceive(_memQueue, &msg, wait) == pdTRUE;
+		// Before the message - a scanner could have reconnected with the same connection id
+		_ProcessPendingRemovals();
+		if (received) {
+			_Process(msg);
 		}
+		// Payloads may be queued even without a message (if the message queue was full)
+		_ProcessReadQueue();
 
-		const auto advertiseInfo = _memory->GetScannerToAdvertise();  // Read
-		if (advertiseInfo) {
-			const auto connId = advertiseInfo->ConnId;
-			const auto stateChar = advertiseInfo->Service.StateChar;
-			xSemaphoreGive(_memMutex);
-
-			// Force advertising state
-			std::uint8_t val = Gatt::StateChar::Advertise;
-			esp_ble_gattc_write_char(_gattcApp->GattIf, connId, stateChar, 1, &val,
-			                         ESP_GATT_WRITE_TYPE_RSP, ESP_GATT_AUTH_REQ_NONE);
-			ESP_LOGD(TAG, "Scanner %d should advertise", connId);
+		now = xTaskGetTickCount();
+		if (TicksUntil(now, nextRead) == 0) {
+			nextRead = now + _ReadStep();
 		}
-		else {
-			xSemaphoreGive(_memMutex);
+		if (TicksUntil(now, nextAdvertiseCheck) == 0) {
+			nextAdvertiseCheck = now + AdvertiseCheckInterval;
+			_CheckScannerToAdvertise();
+		}
+		if (statsInterval > 0 && TicksUntil(now, nextStats) == 0) {
+			nextStats = now + statsInterval;
+			_taskStats.Report();
 		}
 	}
 }
 
-void App::UpdateDeviceDataLoop()
+void App::_QueuePayload(std::uint16_t connId,
+                        std::span<const std::uint8_t> data,
+                        std::uint8_t format)
 {
-	// Read "Devices" characteristic in regular intervals, to get updated RSSI values.
-	// Each time all the scanners' values are read, update the new positions.
-
-	const TickType_t Delay = pdMS_TO_TICKS(_cfg.GattReadInterval);
-	const TickType_t DelayBetweenReads = pdMS_TO_TICKS(_cfg.DelayBetweenGattReads);
-
-	// Data required to read a characteristic
-	struct ReadCharData
-	{
-		std::uint16_t ConnectionId;
-		std::uint16_t DeviceCharHandle;
-	};
-
-	static std::vector<ReadCharData> readCharData;
-	readCharData.reserve(10);
-
-	for (;;) {
-		// First make a copy of each scanner's connection id and handle
-		if (xSemaphoreTake(_memMutex, portMAX_DELAY)) {
-			readCharData.clear();
-			_memory->VisitScanners([&](const ScannerInfo & info) {
-				readCharData.emplace_back(info.ConnId, info.Service.DevicesChar);
-			});
-			xSemaphoreGive(_memMutex);
-		}
-		else {
-			ESP_LOGD(TAG, "Mtx take fail (UpdateDeviceDataLoop[0])");
-		}
+	// Never block here; just queue it and let the memory task process it
+	if (data.size() > Core::PayloadQueue::MaxPayloadSize) {
+		ESP_LOGW(TAG, "Received too much data from scanner conn id %d (%d)", connId, data.size());
+		return;
+	}
+	if (!_readQueue.Push(connId, data, format)) {
+		ESP_LOGW(TAG, "Read queue full, dropped data from scanner conn id %d (overflows: %lu)",
+		         connId, _readQueue.Overflows());
+		return;
+	}
+	// Just a wakeup; if the message queue is full, the payload gets processed
+	// with the next message anyway
+	const MemoryMsg wakeup = Msg::Payloads{};
+	xQueueSend(_memQueue, &wakeup, 0);
+}
 
-		// Now read data from each scanner; add a small delay between reads
-		for (const auto & data : readCharData) {
-			esp_ble_gattc_read_char(_gattcApp->GattIf, data.ConnectionId, data.DeviceCharHandle,
-			                        ESP_GATT_AUTH_REQ_NONE);
-			vTaskDelay(DelayBetweenReads);
-		}
-		vTaskDelay(Delay);
+bool App::_SubscribeDevices(ScannerInfo & scanner)
+{
+	const esp_bt_uuid_t uuid{.len = ESP_UUID_LEN_16, .uuid = {.uuid16 = Gatt::ClientCharConfig}};
+	esp_gattc_descr_elem_t descr;
+	std::uint16_t count = 1;
+	const esp_gatt_status_t err = esp_ble_gattc_get_descr_by_char_handle(
+	    _gattcApp->GattIf, scanner.ConnId, scanner.Service.DevicesChar, uuid, &descr, &count);
+	if (err != ESP_GATT_OK || count == 0) {
+		return false;
+	}
 
-		if (xSemaphoreTake(_memMutex, portMAX_DELAY)) {
-			// Serialize
-			const std::span<std::uint8_t> rawData = _memory->SerializeOutput();  // Read
-			xSemaphoreGive(_memMutex);
+	esp_ble_gattc_register_for_notify(_gattcApp->GattIf, scanner.Bda.Addr.data(),
+	                                  scanner.Service.DevicesChar);
+	const std::uint16_t bits = _cfg.Transfer == ScannerTransfer::Indicate
+	                               ? Gatt::ClientConfigBits::Indicate
+	                               : Gatt::ClientConfigBits::Notify;
+	std::uint8_t value[2] = {static_cast<std::uint8_t>(bits & 0xFF),
+	                         static_cast<std::uint8_t>(bits >> 8)};
+	esp_ble_gattc_write_char_descr(_gattcApp->GattIf, scanner.ConnId, descr.handle,
+	                               sizeof(value), value, ESP_GATT_WRITE_TYPE_RSP,
+	                               ESP_GATT_AUTH_REQ_NONE);
+
+	scanner.Service.DevicesCccd = descr.handle;
+	scanner.NextSeq = 0;
+	return true;
+}
 
-			// and finally update the HTTP server data
-			_httpServer.SetDevicesGetData(
-			    std::span<char>(reinterpret_cast<char *>(rawData.data()), rawData.size()));
-		}
-		else {
-			ESP_LOGD(TAG, "Mtx take fail (UpdateDeviceDataLoop[1])");
-		}
-		vTaskDelay(DelayBetweenReads / 2);
+void App::_StartStreaming(ScannerInfo & scanner)
+{
+	// The Scanner doesn't stream with a small MTU; keep reading it until it's negotiated
+	if (scanner.Streaming || scanner.Service.DevicesCccd == ESP_GATT_INVALID_HANDLE
+	    || scanner.Mtu < Gatt::DevicesStreamMinMtu) {
+		return;
+	}
+	if (_Send(Msg::StartStreaming{scanner.ConnId}, BlockTimeInCallback)) {
+		scanner.Streaming = true;
 	}
 }
 
-bool App::_IsScanner(const Bt::Device & device)
+bool App::_IsScanner(const Bt::ScanResultView & device)
 {
 	// Only BLE
 	if (!device.IsBle()) {
 		return false;
 	}
 
-	const Bt::BleSpecific & ble = device.GetBle();
-
 	// Only a single record
-	if (ble.EirData.Records.size() != 1) {
+	const Bt::EirView eir = device.Eir();
+	if (!eir.IsSingleRecord()) {
 		return false;
 	}
 
 	// 128b Service ID record
-	const Bt::BleSpecific::Eir::Record & record = ble.EirData.Records.at(0);
+	const Bt::EirView::Record & record = *eir.begin();
 	if (record.Type != esp_ble_adv_data_type::ESP_BLE_AD_TYPE_128SRV_CMPL
 	    || record.Data.size() != Util::UuidByteCount) {
 		return false;
@@ -530,12 +695,7 @@ void App::_ScanForScanners()
 	// setting the params if necessary.
 	static bool InitState = false;
 
-	std::size_t connected = 4;
-	if (xSemaphoreTake(_memMutex, portMAX_DELAY)) {
-		connected = 0;
-		_memory->VisitScanners([&connected](const ScannerInfo & info) { connected++; });
-		xSemaphoreGive(_memMutex);
-	}
+	const std::size_t connected = _scanners.size();
 
 	if (connected >= 4 && InitState) {
 		InitState = false;
@@ -564,6 +724,307 @@ void App::_ScanForScanners()
 	_bleGap.StartScanning();
 }
 
+bool App::_Send(const MemoryMsg & msg, TickType_t timeout)
+{
+	if (xQueueSend(_memQueue, &msg, timeout) != pdTRUE) {
+		ESP_LOGW(TAG, "Memory queue full (message %d dropped)", msg.index());
+		return false;
+	}
+	return true;
+}
+
+void App::_Process(const MemoryMsg & msg)
+{
+	std::visit(Overload{
+	               [&](const Msg::Payloads & m) {},  // processed after each message
+	               [&](const Msg::AddScanner & m) {
+		               _memory->AddScanner(m.Info);
+		               _PushFilterRules(m.Info);
+	               },
+	               [&](const Msg::RemoveScanner & m) { _RemoveScanner(m.ConnId); },
+	               [&](const Msg::UpdateCalibration & m) {
+		               if (m.RefPathLoss.has_value()) {
+			               Nvs::Cache::Instance().SetRefPathLoss(m.Addr.Addr,
+			                                                     m.RefPathLoss.value());
+		               }
+		               if (m.EnvFactor.has_value()) {
+			               Nvs::Cache::Instance().SetEnvFactor(m.Addr.Addr, m.EnvFactor.value());
+		               }
+		               _memory->UpdateCalibration(m.Addr);
+	               },
+	               [&](const Msg::SetMacName & m) {
+		               Nvs::Cache::Instance().SetMacName(m.Addr.Addr,
+		                                                 std::span(m.Name).first(m.Length));
+	               },
+	               [&](const Msg::ResetScanners & m) { _memory->ResetScannerPositions(); },
+	               [&](const Msg::ForceAdvertise & m) {
+		               _memory->VisitScanners([&](const ScannerInfo & info) {
+			               if (info.Bda == m.Addr) {
+				               _ForceAdvertise(info);
+			               }
+		               });
+	               },
+	               [&](const Msg::GetHistory & m) {
+		               _historyReply.Seq = m.Seq;
+		               _historyReply.Found = _memory->GetHistory(m.Addr, _historyReply.History);
+		               xQueueOverwrite(_historyQueue, &_historyReply);
+	               },
+	               [&](const Msg::UpdateZone & m) { _LoadZone(m.Id); },
+	               [&](const Msg::UpdateIrk & m) { _LoadIrk(m.Id); },
+	               [&](const Msg::SetScanSchedule & m) {
+		               _memory->VisitScanners([&](const ScannerInfo & info) {
+			               if (info.Bda == m.Addr) {
+				               _SetScanSchedule(info, m.Value);
+			               }
+		               });
+	               },
+	               [&](const Msg::StartStreaming & m) { _streamers.push_back(m.ConnId); },
+	               [&](const Msg::UpdateFilterRules & m) {
+		               _LoadFilterRules();
+		               _memory->VisitScanners(
+		                   [&](const ScannerInfo & info) { _PushFilterRules(info); });
+	               },
+	           },
+	           msg);
+}
+
+void App::_RemoveScanner(std::uint16_t connId)
+{
+	_memory->RemoveScanner(connId);
+	std::erase_if(_readTargets, [&](const ScannerInfo & info) { return info.ConnId == connId; });
+	std::erase_if(_receivers,
+	              [&](const ScannerReceiver & receiver) { return receiver.ConnId == connId; });
+	std::erase(_streamers, connId);
+}
+
+void App::_ProcessPendingRemovals()
+{
+	std::uint32_t pending = _pendingRemovals.exchange(0, std::memory_order_acquire);
+	for (std::uint16_t connId = 0; pending != 0; connId++, pending >>= 1) {
+		if (pending & 1) {
+			_RemoveScanner(connId);
+		}
+	}
+}
+
+void App::_ProcessReadQueue()
+{
+	for (auto * payload = _readQueue.Front(); payload != nullptr; payload = _readQueue.Front()) {
+		_ProcessReadPayload(*payload);
+		_readQueue.Pop();
+	}
+}
+
+void App::_ProcessReadPayload(Core::PayloadQueue::Payload & payload)
+{
+	// Responses from scanners
+	std::span<std::uint8_t> records = payload.View();
+	std::span<const Core::RssiStats> stats;
+	if ((payload.Kind & FramedPayload) != 0) {
+		records = _ReassembleBatch(payload.Id, records);
+		if (records.empty()) {
+			return;
+		}
+	}
+	if (Core::Compact::IsCompact(payload.Kind & ~FramedPayload)) {
+		records = _DecodeCompact(payload.Id, records);
+		if (records.empty()) {
+			return;
+		}
+		stats = _decodedStats;
+	}
+	if ((records.size() % Core::DeviceDataView::Size) != 0) {
+		const auto * scanner = _memory->GetScanner(payload.Id);
+		ESP_LOGW(TAG, "Received incorrect data size from %s (%d %% %d != 0)",
+		         scanner ? ToString(scanner->Bda).c_str() : "UNKNOWN", records.size(),
+		         Core::DeviceDataView::Size);
+		return;
+	}
+
+	// Assume its an array of devices
+	Core::DeviceDataView::Array data(records);
+	_memory->UpdateDistance(payload.Id, data, stats);
+}
+
+App::ScannerReceiver & App::_Receiver(std::uint16_t connId)
+{
+	auto it = std::find_if(_receivers.begin(), _receivers.end(),
+	                       [connId](const ScannerReceiver & r) { return r.ConnId == connId; });
+	if (it != _receivers.end()) {
+		return *it;
+	}
+	return _receivers.emplace_back(ScannerReceiver{.ConnId = connId});
+}
+
+std::span<std::uint8_t> App::_ReassembleBatch(std::uint16_t connId,
+                                              std::span<const std::uint8_t> frame)
+{
+	const auto * scanner = _memory->GetScanner(connId);
+	if (scanner == nullptr) {
+		return {};
+	}
+
+	using Result = Core::BatchAssembler::Result;
+	Core::BatchAssembler & batches = _Receiver(connId).Batches;
+	const Result result = batches.Add(frame);
+	if (result == Result::Invalid) {
+		return {};
+	}
+	if (result == Result::Incomplete) {
+		// Read the next chunk right away; the whole batch is received in this round
+		esp_ble_gattc_read_char(_gattcApp->GattIf, connId, scanner->Service.DevicesChar,
+		                        ESP_GATT_AUTH_REQ_NONE);
+		return {};
+	}
+
+	// The Scanner keeps sending the batch until it's acknowledged
+	std::uint8_t command[2] = {Gatt::DevicesControl::Ack, batches.Id()};
+	esp_ble_gattc_write_char(_gattcApp->GattIf, connId, scanner->Service.DevicesChar,
+	                         sizeof(command), command, ESP_GATT_WRITE_TYPE_NO_RSP,
+	                         ESP_GATT_AUTH_REQ_NONE);
+	return result == Result::Complete ? batches.Data() : std::span<std::uint8_t>();
+}
+
+std::span<std::uint8_t> App::_DecodeCompact(std::uint16_t connId,
+                                            std::span<const std::uint8_t> payload)
+{
+	std::optional<Core::CompactDecoder> & decoder = _Receiver(connId).Decoder;
+	if (!decoder.has_value()) {
+		decoder.emplace(_cfg.DeviceMemoryCfg.DeviceTableRegion);
+	}
+
+	using Result = Core::CompactDecoder::Result;
+	const Result result = decoder->Decode(payload, _decodedRecords, _decodedStats);
+	if (result == Result::Invalid) {
+		ESP_LOGW(TAG, "Invalid compact payload from scanner conn id %d", connId);
+	}
+	else if (const auto * scanner = _memory->GetScanner(connId);
+	         result == Result::Resync && scanner != nullptr) {
+		// Records decoded so far are still valid
+		ESP_LOGD(TAG, "Resync of scanner conn id %d", connId);
+		std::uint8_t command[2] = {Gatt::DevicesControl::Resync, decoder->ResyncEpoch()};
+		esp_ble_gattc_write_char(_gattcApp->GattIf, connId, scanner->Service.DevicesChar,
+		                         sizeof(command), command, ESP_GATT_WRITE_TYPE_NO_RSP,
+		                         ESP_GATT_AUTH_REQ_NONE);
+	}
+	return _decodedRecords;
+}
+
+TickType_t App::_ReadStep()
+{
+	// Read "Devices" characteristic of each scanner, with a small delay between reads
+	if (_readCursor < _readTargets.size()) {
+		const ScannerInfo & info = _readTargets[_readCursor++];
+		esp_ble_gattc_read_char(_gattcApp->GattIf, info.ConnId, info.Service.DevicesChar,
+		                        ESP_GATT_AUTH_REQ_NONE);
+		return pdMS_TO_TICKS(_cfg.DelayBetweenGattReads);
+	}
+
+	// All scanners were read; serialize directly into the HTTP server buffer
+	if (_memory->SerializeOutput(_httpServer.DevicesGetDataBuffer())) {
+		// and publish it
+		_httpServer.PublishDevicesGetData();
+	}
+	if (_memory->SerializeZoneEvents(_httpServer.ZoneEventsGetDataBuffer())) {
+		_httpServer.PublishZoneEventsGetData();
+	}
+	ESP_LOGD(TAG, "Read queue: %d/%d (max %d), overflows: %lu", _readQueue.Size(),
+	         _readQueue.Capacity(), _readQueue.HighWatermark(), _readQueue.Overflows());
+
+	// Start a new round
+	_readTargets.clear();
+	_memory->VisitScanners([&](const ScannerInfo & info) {
+		if (std::ranges::find(_streamers, info.ConnId) == _streamers.end()) {
+			_readTargets.push_back(info);  // Others send their data on their own
+		}
+	});
+	_readCursor = 0;
+	return pdMS_TO_TICKS(_cfg.GattReadInterval);
+}
+
+void App::_LoadZone(std::uint8_t id)
+{
+	std::optional<Zone> zone = std::nullopt;
+	if (const auto definition = Nvs::GetZone(id); definition.has_value()) {
+		zone = Zone::Parse(definition.value());
+		if (!zone.has_value()) {
+			ESP_LOGW(TAG, "Invalid zone %d definition", id);
+		}
+	}
+	_memory->SetZone(id, zone);
+}
+
+void App::_LoadIrk(std::uint8_t id)
+{
+	std::optional<Irk> irk = std::nullopt;
+	if (const auto definition = Nvs::GetIrk(id); definition.has_value()) {
+		irk = Irk::Parse(definition.value());
+		if (!irk.has_value()) {
+			ESP_LOGW(TAG, "Invalid IRK %d", id);
+		}
+	}
+	_memory->SetIrk(id, irk);
+}
+
+void App::_LoadFilterRules()
+{
+	_filterRules.Clear();
+	if (const auto rules = Nvs::GetFilterRules(); rules.has_value()) {
+		if (!_filterRules.Set(rules.value())) {
+			ESP_LOGW(TAG, "Invalid filter rules");
+		}
+	}
+}
+
+void App::_CheckScannerToAdvertise()
+{
+	const ScannerInfo * info = _memory->GetScannerToAdvertise();
+	if (info) {
+		ESP_LOGD(TAG, "Scanner %d should advertise", info->ConnId);
+		_ForceAdvertise(*info);
+	}
+}
+
+void App::_SetScanSchedule(const ScannerInfo & info,
+                           std::span<const std::uint8_t, Core::ScanSchedule::Size> value)
+{
+	if (info.Service.ScanChar == ESP_GATT_INVALID_HANDLE) {
+		ESP_LOGW(TAG, "%s doesn't support scan schedules", ToString(info.Bda).c_str());
+		return;
+	}
+	ESP_LOGI(TAG, "Setting scan schedule of %s", ToString(info.Bda).c_str());
+	std::array<std::uint8_t, Core::ScanSchedule::Size> copy;
+	std::ranges::copy(value, copy.begin());
+	esp_ble_gattc_write_char(_gattcApp->GattIf, info.ConnId, info.Service.ScanChar, copy.size(),
+	                         copy.data(), ESP_GATT_WRITE_TYPE_RSP, ESP_GATT_AUTH_REQ_NONE);
+}
+
+void App::_PushFilterRules(const ScannerInfo & info)
+{
+	if (info.Service.FilterChar == ESP_GATT_INVALID_HANDLE) {
+		if (!_filterRules.Empty()) {
+			ESP_LOGW(TAG, "%s doesn't support filter rules", ToString(info.Bda).c_str());
+		}
+		return;
+	}
+	ESP_LOGI(TAG, "Setting %d filter rules of %s", _filterRules.Count(),
+	         ToString(info.Bda).c_str());
+	std::array<std::uint8_t, Core::FilterRules::MaxSize> copy;
+	const std::span<const std::uint8_t> rules = _filterRules.Data();
+	std::ranges::copy(rules, copy.begin());
+	esp_ble_gattc_write_char(_gattcApp->GattIf, info.ConnId, info.Service.FilterChar,
+	                         rules.size(), copy.data(), ESP_GATT_WRITE_TYPE_RSP,
+	                         ESP_GATT_AUTH_REQ_NONE);
+}
+
+void App::_ForceAdvertise(const ScannerInfo & info)
+{
+	ESP_LOGI(TAG, "Switching %s to advertising state", ToString(info.Bda).c_str());
+	std::uint8_t val = Gatt::StateChar::Advertise;
+	esp_ble_gattc_write_char(_gattcApp->GattIf, info.ConnId, info.Service.StateChar, 1, &val,
+	                         ESP_GATT_WRITE_TYPE_RSP, ESP_GATT_AUTH_REQ_NONE);
+}
+
 void App::_ProcessSystemMessage(HttpApi::Type::SystemMsg::Operation op)
 {
 	using Op = HttpApi::Type::SystemMsg::Operation;
@@ -575,13 +1036,7 @@ void App::_ProcessSystemMessage(HttpApi::Type::SystemMsg::Operation op)
 		break;
 	case Op::ResetScanners:
 		ESP_LOGI(TAG, "Scanner Reset from HTTP");
-		if (xSemaphoreTake(_memMutex, portMAX_DELAY)) {
-			_memory->ResetScannerPositions();
-			xSemaphoreGive(_memMutex);
-		}
-		else {
-			ESP_LOGE(TAG, "Failed taking memory mutex");
-		}
+		_Send(Msg::ResetScanners{}, portMAX_DELAY);
 		break;
 	case Op::SwitchToAp:
 		ESP_LOGI(TAG, "Switch to AP from HTTP");
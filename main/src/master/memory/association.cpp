@@ -0,0 +1,76 @@
+#include "master/memory/association.h"
+
+#include "core/utility/hash_index.h"
+
+#include <algorithm>
+#include <array>
+
+namespace
+{
+/// @brief AD types
+/// @{
+constexpr std::uint8_t AdFlags = 0x01;
+constexpr std::uint8_t AdTxPower = 0x0A;
+constexpr std::uint8_t AdServiceData16 = 0x16;
+constexpr std::uint8_t AdServiceData32 = 0x20;
+constexpr std::uint8_t AdServiceData128 = 0x21;
+constexpr std::uint8_t AdManufacturerData = 0xFF;
+/// @}
+
+/// @brief Length of the stable prefix of an AD structure's data (the rest is masked out)
+std::size_t StableLength(std::uint8_t type, std::size_t length)
+{
+	switch (type) {
+	case AdServiceData16:
+	case AdManufacturerData:
+		return std::min<std::size_t>(length, 2);  // 16-bit UUID/company ID
+	case AdServiceData32:
+		return std::min<std::size_t>(length, 4);
+	case AdServiceData128:
+		return std::min<std::size_t>(length, 16);
+	default:
+		return length;
+	}
+}
+}  // namespace
+
+namespace Master
+{
+
+bool IsRotatingAddress(const Mac & bda, bool isBle, bool isPublic)
+{
+	// Two most significant bits: 0b11 - static, 0b01 - resolvable, 0b00 - non-resolvable
+	return isBle && !isPublic && ((bda.Addr[0] & 0xC0) != 0xC0);
+}
+
+std::uint32_t AdvFingerprint(esp_ble_evt_type_t eventType, std::span<const std::uint8_t> advData)
+{
+	const std::uint8_t evt = static_cast<std::uint8_t>(eventType);
+	std::uint32_t hash = Core::Fnv1a(std::span(&evt, 1));
+
+	bool specific = false;
+	std::size_t offset = 0;
+	while (offset + 1 < advData.size()) {
+		const std::size_t length = advData[offset];  // type + data
+		if (length == 0 || offset + 1 + length > advData.size()) {
+			break;  // End or malformed
+		}
+		const std::uint8_t type = advData[offset + 1];
+		const auto data = advData.subspan(offset + 2, length - 1);
+
+		// Type and length are hashed even for the masked structures
+		const std::array<std::uint8_t, 2> header{static_cast<std::uint8_t>(length), type};
+		hash = Core::Fnv1a(header, hash);
+		hash = Core::Fnv1a(data.first(StableLength(type, data.size())), hash);
+
+		specific |= (type != AdFlags) && (type != AdTxPower);
+		offset += 1 + length;
+	}
+
+	if (!specific) {
+		return NoFingerprint;
+	}
+	return (hash == NoFingerprint) ? 1 : hash;
+}
+
+}  // namespace Master
@@ -0,0 +1,70 @@
+#include "master/memory/calibration.h"
+
+#include "master/nvs_utils.h"
+#include "math/path_loss/log_distance.h"
+
+#include <esp_log.h>
+
+#include <algorithm>
+
+namespace
+{
+/// @brief Logger tag
+static const char * TAG = "Calib";
+}  // namespace
+
+namespace Master
+{
+
+float Calibration::Distance(std::int8_t rssi) const
+{
+	if (Lut) {
+		return (*Lut)[static_cast<std::size_t>(rssi + 128)];
+	}
+	return PathLoss::LogDistance(rssi, EnvFactor, RefPathLoss);
+}
+
+CalibrationStore::CalibrationStore(std::int8_t defaultRefPathLoss, float defaultEnvFactor)
+    : _defaultRefPathLoss(defaultRefPathLoss)
+    , _defaultEnvFactor(defaultEnvFactor)
+{
+	_luts.reserve(MaxLuts);
+	_GetLut(_defaultRefPathLoss, _defaultEnvFactor);  // Always used
+}
+
+Calibration CalibrationStore::Resolve(const Mac & mac)
+{
+	const auto & v = Nvs::Cache::Instance().GetValues(mac.Addr);
+	const std::int8_t refPathLoss = v.RefPathLoss.value_or(_defaultRefPathLoss);
+	const float envFactor = v.EnvFactor.value_or(_defaultEnvFactor);
+
+	return Calibration{
+	    .RefPathLoss = refPathLoss,
+	    .EnvFactor = envFactor,
+	    .Lut = _GetLut(refPathLoss, envFactor),
+	};
+}
+
+const DistanceLut * CalibrationStore::_GetLut(std::int8_t refPathLoss, float envFactor)
+{
+	auto it = std::find_if(_luts.begin(), _luts.end(), [&](const LutEntry & e) {
+		return (e.RefPathLoss == refPathLoss) && (e.EnvFactor == envFactor);
+	});
+	if (it != _luts.end()) {
+		return &it->Distances;
+	}
+
+	if (_luts.size() >= MaxLuts) {
+		ESP_LOGW(TAG, "Table limit reached (PL: %d, EF: %.2f)", refPathLoss, envFactor);
+		return nullptr;
+	}
+
+	LutEntry & entry = _luts.emplace_back(refPathLoss, envFactor);
+	for (std::size_t i = 0; i < entry.Distances.size(); i++) {
+		const auto rssi = static_cast<std::int8_t>(static_cast<int>(i) - 128);
+		entry.Distances[i] = PathLoss::LogDistance(rssi, envFactor, refPathLoss);
+	}
+	return &entry.Distances;
+}
+
+}  // namespace Master
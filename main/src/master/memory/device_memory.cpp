@@ -2,20 +2,51 @@
 
 #include "core/clock.h"
 #include "core/device_data.h"
-#include "master/nvs_utils.h"
+#include "master/memory/association.h"
 #include "math/minimizer/functions/anchor_distance.h"
 #include "math/minimizer/functions/point_to_anchors.h"
 #include "math/minimizer/gradient_minimizer.h"
-#include "math/path_loss/log_distance.h"
 
 #include <esp_log.h>
 
+#include <algorithm>
+#include <cassert>
 #include <numeric>
 
 namespace
 {
 /// @brief Logger tag
 static const char * TAG = "DevMem";
+
+/// @brief Remove a scanner from a NxN scanner matrix - shift the following rows/columns over
+/// it and shrink the matrix
+/// @param matrix matrix
+/// @param idx scanner index
+template <typename T>
+void RemoveScannerIdx(Math::Matrix<T> & matrix, std::size_t idx)
+{
+	const std::size_t size = matrix.Rows();
+	if (idx >= size) {
+		return;
+	}
+
+	const std::size_t last = size - 1;
+	for (std::size_t i = idx; i < last; i++) {
+		for (std::size_t j = 0; j < size; j++) {
+			matrix(i, j) = matrix(i + 1, j);
+		}
+	}
+	for (std::size_t j = idx; j < last; j++) {
+		for (std::size_t i = 0; i < size; i++) {
+			matrix(i, j) = matrix(i, j + 1);
+		}
+	}
+	for (std::size_t i = 0; i < size; i++) {
+		matrix(last, i) = T{};
+		matrix(i, last) = T{};
+	}
+	matrix.Reshape(last, last);
+}
 }  // namespace
 
 namespace Master
@@ -23,9 +54,24 @@ namespace Master
 
 DeviceMemory::DeviceMemory(const AppConfig::DeviceMemoryConfig & cfg)
     : IDeviceMemory(cfg)
+    , _calibration(cfg.DefaultPathLoss, cfg.DefaultEnvFactor)
+    , _devices(Core::CapsAllocator<DeviceMeasurements>(cfg.DeviceTableRegion))
+    , _deviceIndex(cfg.MaxDevices)
+    , _deviceMacs(cfg.MaxDevices, Core::CapsAllocator<Mac>(Core::MemoryRegion::Internal))
+    , _deviceFingerprints(cfg.MaxDevices,
+                          NoFingerprint,
+                          Core::CapsAllocator<std::uint32_t>(Core::MemoryRegion::Internal))
+    , _macIndex(cfg.MaxDevices)
+    , _fingerprintIndex(cfg.MaxDevices)
+    , _zones(cfg.ZoneEventCapacity)
 {
-	_serializedData.reserve(MaximumDevices * DeviceOut::Size);
+	_devices.reserve(_cfg.MaxDevices);
+	ESP_LOGI(TAG, "Device table: %d devices, %dB (%s)", _cfg.MaxDevices,
+	         _cfg.MaxDevices * sizeof(DeviceMeasurements),
+	         (_cfg.DeviceTableRegion == Core::MemoryRegion::External) ? "PSRAM" : "internal");
 	_scannerRssis.Reserve(_cfg.MaxScanners * _cfg.MaxScanners);
+	_scannerRssiFilters.Reserve(_cfg.MaxScanners * _cfg.MaxScanners);
+	_scannerLinks.Reserve(_cfg.MaxScanners * _cfg.MaxScanners);
 	_scannerDistances.Reserve(_cfg.MaxScanners * _cfg.MaxScanners);
 	_scannerPositions.Reserve(_cfg.MaxScanners * 3);
 }
@@ -42,17 +88,20 @@ void DeviceMemory::AddScanner(const ScannerInfo & scanner)
 		// Already exists; just update
 		sc->Info.ConnId = scanner.ConnId;
 		sc->Info.Service = scanner.Service;
+		sc->ClockOffsetSet = false;  // Timestamp gets written again on connect
 	}
 	else {
 		// New scanner
-		_scanners.push_back(scanner);
+		_scanners.emplace_back(scanner, _calibration.Resolve(scanner.Bda));
 
 		_scannerDistances.Reshape(_scanners.size(), _scanners.size());
 		_scannerRssis.Reshape(_scanners.size(), _scanners.size());
+		_scannerRssiFilters.Reshape(_scanners.size(), _scanners.size());
+		_scannerLinks.Reshape(_scanners.size(), _scanners.size());
 
 		if (auto scDev = _FindDevice(scanner.Bda); scDev != _devices.end()) {
 			// Already found as a device; erase it
-			_devices.erase(scDev);
+			_RemoveDevice(scDev);
 		}
 	}
 	ESP_LOGI(TAG, "%d scanners connected", _scanners.size());
@@ -60,7 +109,8 @@ void DeviceMemory::AddScanner(const ScannerInfo & scanner)
 }
 
 void DeviceMemory::UpdateDistance(const std::uint16_t scannerConnId,
-                                  const Core::DeviceDataView::Array & device)
+                                  const Core::DeviceDataView::Array & device,
+                                  std::span<const Core::RssiStats> stats)
 {
 	if (device.Size == 0) {
 		return;
@@ -69,43 +119,61 @@ void DeviceMemory::UpdateDistance(const std::uint16_t scannerConnId,
 	// Find connection id - we have to iterate through everything
 	for (auto it = _scanners.begin(); it != _scanners.end(); it++) {
 		if (it->Info.ConnId == scannerConnId) {
-			_UpdateDistance(it, device);
+			_UpdateDistance(it, device, stats);
 			break;
 		}
 	}
 }
 
-void DeviceMemory::UpdateDistance(const Mac & scanner, const Core::DeviceDataView::Array & device)
+void DeviceMemory::UpdateDistance(const Mac & scanner,
+                                  const Core::DeviceDataView::Array & device,
+                                  std::span<const Core::RssiStats> stats)
 {
 	if (device.Size == 0) {
 		return;
 	}
 
 	if (auto sc = _FindScanner(scanner); sc != _scanners.end()) {
-		_UpdateDistance(sc, device);
+		_UpdateDistance(sc, device, stats);
 	}
 }
 
-const ScannerInfo * DeviceMemory::GetScannerToAdvertise() const
+const ScannerInfo * DeviceMemory::GetScannerToAdvertise()
 {
-	for (std::size_t i = 0; i < _scanners.size(); i++) {
-		for (std::size_t j = i + 1; j < _scanners.size(); j++) {
-			// Scanner RSSI between i-j/j-i missing?
-			const ScannerInfo * iInfo = &(_scanners.begin() + i)->Info;
-			const ScannerInfo * jInfo = &(_scanners.begin() + j)->Info;
-			if (_scannerRssis(i, j) == 0) {
-				ESP_LOGI(TAG, "%s should advertise; %s doesn't have measurement",
-				         ToString(jInfo->Bda).c_str(), ToString(iInfo->Bda).c_str());
-				return jInfo;
-			}
-			else if (_scannerRssis(j, i) == 0) {
-				ESP_LOGI(TAG, "%s should advertise; %s doesn't have measurement",
-				         ToString(iInfo->Bda).c_str(), ToString(jInfo->Bda).c_str());
-				return iInfo;
+	const std::size_t count = _scanners.size();
+	const Core::TimePoint now = Core::Clock::now();
+
+	// Start at a different scanner each time, so scanners with the same priority take turns
+	std::size_t best = count;
+	float bestPriority = 0.0f;
+	for (std::size_t n = 0; n < count; n++) {
+		const std::size_t adv = (_advertiseCursor + n) % count;
+
+		// An advertising scanner gets measured by all the other ones
+		float priority = 0.0f;
+		for (std::size_t rx = 0; rx < count; rx++) {
+			if (rx != adv) {
+				priority += _scannerLinks(rx, adv).Priority(_cfg.ScannerLinkCfg, now);
 			}
 		}
+		if (priority > bestPriority) {
+			best = adv;
+			bestPriority = priority;
+		}
 	}
-	return nullptr;
+
+	if (best == count) {
+		return nullptr;  // All the links converged
+	}
+	_advertiseCursor = (best + 1) % count;
+	for (std::size_t rx = 0; rx < count; rx++) {
+		if (rx != best) {
+			_scannerLinks(rx, best).Attempt();
+		}
+	}
+	ESP_LOGI(TAG, "%s should advertise (priority %.2f)", ToString(_scanners[best].Info.Bda).c_str(),
+	         bestPriority);
+	return &_scanners[best].Info;
 }
 
 void DeviceMemory::RemoveScanner(std::uint16_t connId)
@@ -118,16 +186,16 @@ void DeviceMemory::RemoveScanner(std::uint16_t connId)
 	}
 }
 
-bool DeviceMemory::IsConnectedScanner(const Bt::Device & dev) const
+bool DeviceMemory::IsConnectedScanner(const Bt::ScanResultView & dev) const
 {
 	// Early simple checks
-	if (!dev.IsBle() || dev.GetBle().AddrType != BLE_ADDR_TYPE_PUBLIC
-	    || dev.GetBle().EirData.Records.size() != 1) {
+	if (!dev.IsBlePublic() || !dev.Eir().IsSingleRecord()) {
 		return false;
 	}
 
+	const Mac bda(dev.Bda());
 	return std::find_if(_scanners.begin(), _scanners.end(),
-	                    [&dev](const ScannerDetail & s) { return s.Info.Bda == dev.Bda; })
+	                    [&bda](const ScannerDetail & s) { return s.Info.Bda == bda; })
 	       != _scanners.end();
 }
 
@@ -194,23 +262,55 @@ void DeviceMemory::_UpdateDevicePositions()
 		}
 	}
 
-	// Distances from point to each scanner
+	// Distances from point to each scanner, and their weights
 	std::vector<float> tmpDist;
 	tmpDist.resize(_scanners.size());
+	std::vector<float> tmpWeights;
+	tmpWeights.resize(_scanners.size());
 
-	for (std::size_t i = 0; i < _devices.size(); i++) {
-		DeviceMeasurements & meas = _devices.at(i);
+	const Core::TimePoint now = Core::Clock::now();
+	for (const auto devIdx : _deviceIndex) {
+		DeviceMeasurements & meas = _devices[devIdx];
+		_RemoveExpiredMeasurements(meas, now);
 		if (meas.Data.size() < _cfg.MinMeasurements) {
+			meas.InvalidatePos();
 			continue;
 		}
 
-		// Save distances
-		for (auto & m : meas.Data) {
-			auto v = Nvs::Cache::Instance().GetValues(meas.Info.Bda.Addr);
-			const auto refPathLoss = v.RefPathLoss.value_or(_cfg.DefaultPathLoss);
-			const auto envFactor = v.EnvFactor.value_or(_cfg.DefaultEnvFactor);
+		// Scanners without a measurement (zero distance) are ignored
+		std::fill(tmpDist.begin(), tmpDist.end(), 0.0);
+		std::fill(tmpWeights.begin(), tmpWeights.end(), 0.0);
 
-			tmpDist.at(m.ScannerIdx) = PathLoss::LogDistance(m.Rssi, envFactor, refPathLoss);
+		// Only fuse measurements made at about the same time as the newest one
+		const Core::TimePoint newest =
+		    std::max_element(meas.Data.begin(), meas.Data.end(),
+		                     [](const MeasurementData & lhs, const MeasurementData & rhs) {
+			                     return lhs.LastUpdate < rhs.LastUpdate;
+		                     })
+		        ->LastUpdate;
+		const auto isInWindow = [&](const MeasurementData & m) {
+			return Core::DeltaMs(m.LastUpdate, newest) <= _cfg.FusionWindow;
+		};
+		meas.UsedMeasurements = std::count_if(meas.Data.begin(), meas.Data.end(), isInWindow);
+		if (meas.UsedMeasurements < _cfg.MinMeasurements) {
+			meas.InvalidatePos();
+			continue;
+		}
+
+		// Save distances; weights relative to the mean confidence, so equally confident
+		// measurements keep the unweighted error
+		float confidenceSum = 0.0f;
+		for (auto & m : meas.Data) {
+			if (!isInWindow(m)) {
+				continue;
+			}
+			tmpDist.at(m.ScannerIdx) = meas.Calib.Distance(m.Rssi);
+			tmpWeights.at(m.ScannerIdx) = m.Confidence;
+			confidenceSum += m.Confidence;
+		}
+		const float meanConfidence = confidenceSum / meas.UsedMeasurements;
+		for (float & weight : tmpWeights) {
+			weight /= meanConfidence;
 		}
 
 		std::span pos = meas.Position;
@@ -218,34 +318,38 @@ void DeviceMemory::_UpdateDevicePositions()
 			pos[i] = _scannerCenter[i];
 		}
 
-		const Math::PointToAnchors fn(_scannerPositions, tmpDist);
+		const Math::PointToAnchors fn(_scannerPositions, tmpDist, tmpWeights);
 		Math::Minimize(fn, pos);
+
+		// Ignored, if there wasn't any new measurement since the last calculation
+		meas.History.Push(newest, meas.Position);
+		_zones.Update(_deviceMacs[devIdx], meas.Zones, meas.Position, newest);
 	}
 }
 
-std::span<std::uint8_t> DeviceMemory::SerializeOutput()
+bool DeviceMemory::SerializeOutput(std::vector<std::uint8_t> & output)
 {
 	_UpdateDevicePositions();
 
 	if (_scannerPositions.Rows() != _scanners.size()) {
-		return _serializedData;  // Probably didn't update yet.
+		return false;  // Probably didn't update yet.
 	}
 
 	// Count how many devices have valid positions
 	const std::size_t validDevices =
-	    std::accumulate(_devices.begin(), _devices.end(), 0,
-	                    [](const std::size_t i, const DeviceMeasurements & dev) {
-		                    return dev.IsInvalidPos() ? i : i + 1;
+	    std::accumulate(_deviceIndex.begin(), _deviceIndex.end(), 0,
+	                    [this](const std::size_t i, const Core::LruIndex::Index devIdx) {
+		                    return _devices[devIdx].IsInvalidPos() ? i : i + 1;
 	                    });
 
-	_serializedData.resize((_scanners.size() + validDevices) * DeviceOut::Size);
+	output.resize((_scanners.size() + validDevices) * DeviceOut::Size);
 
 	// Serialize scanners
 	std::size_t offset = 0;
 	for (std::size_t i = 0; i < _scannerPositions.Rows(); i++) {
 		const auto & scan = _scanners.at(i);
 
-		const std::span<std::uint8_t, DeviceOut::Size> out(_serializedData.begin() + offset,
+		const std::span<std::uint8_t, DeviceOut::Size> out(output.begin() + offset,
 		                                                   DeviceOut::Size);
 		const std::span<const std::uint8_t, 6> bda(scan.Info.Bda.Addr);
 		const std::span<const float, 3> pos(_scannerPositions.Row(i));
@@ -256,34 +360,91 @@ std::span<std::uint8_t> DeviceMemory::SerializeOutput()
 
 	// Serialize devices
 	std::size_t devicesSerialized = 0;
-	for (std::size_t i = 0; i < _devices.size(); i++) {
-		const auto & dev = _devices.at(i);
+	for (const auto devIdx : _deviceIndex) {
+		const auto & dev = _devices[devIdx];
 		if (dev.IsInvalidPos()) {
 			continue;
 		}
 		devicesSerialized++;
 
-		const std::span<std::uint8_t, DeviceOut::Size> out(_serializedData.begin() + offset,
+		const std::span<std::uint8_t, DeviceOut::Size> out(output.begin() + offset,
 		                                                   DeviceOut::Size);
 		const std::span<const std::uint8_t, 6> bda(dev.Info.Bda.Addr);
 		const std::span<const float, 3> pos(dev.Position);
 
-		DeviceOut::Serialize(out, bda, pos, dev.Data.size(), false, dev.Info.IsBle(),
+		DeviceOut::Serialize(out, bda, pos, dev.UsedMeasurements, false, dev.Info.IsBle(),
 		                     dev.Info.IsAddrTypePublic());
 
 		offset += DeviceOut::Size;
 	}
-	ESP_LOGI(TAG, "Serialized %d scanners, %d devices", _scanners.size(), devicesSerialized);
-	return _serializedData;
+	ESP_LOGI(TAG, "Serialized %d scanners, %d devices; %d expired measurements", _scanners.size(),
+	         devicesSerialized, _expiredMeasurements);
+	return true;
+}
+
+bool DeviceMemory::GetHistory(const Mac & mac, Trajectory::Snapshot & snapshot)
+{
+	const auto devIt = _FindDevice(mac);
+	if (devIt == _devices.end()) {
+		return false;
+	}
+	devIt->History.CopyTo(snapshot);
+	return true;
+}
+
+void DeviceMemory::SetZone(std::uint8_t id, const std::optional<Zone> & zone)
+{
+	if (id >= Zone::MaxZones) {
+		return;
+	}
+
+	// A replaced zone is re-evaluated at the last positions, so devices staying inside don't
+	// leave and re-enter it. A removed zone is left; nobody is in a new zone yet - devices
+	// enter it after the next calculation.
+	const Zone::Mask bit = Zone::Mask(1) << id;
+	const Core::TimePoint now = Core::Clock::now();
+	const bool replaced = zone.has_value() && _zones.Has(id);
+	_zones.SetZone(id, zone);
+	for (const auto devIdx : _deviceIndex) {
+		auto & dev = _devices[devIdx];
+		if (!replaced) {
+			_zones.Leave(_deviceMacs[devIdx], dev.Zones, bit, now);
+		}
+		else if (!dev.IsInvalidPos()) {
+			_zones.Update(_deviceMacs[devIdx], dev.Zones, dev.Position, now, bit);
+		}
+	}
+}
+
+bool DeviceMemory::SerializeZoneEvents(std::vector<std::uint8_t> & output)
+{
+	return _zones.SerializeEvents(output);
+}
+
+void DeviceMemory::SetIrk(std::uint8_t id, const std::optional<Irk> & irk)
+{
+	_irks.SetIrk(id, irk);
 }
 
 void DeviceMemory::ResetScannerPositions()
 {
 	_scannerRssis.Fill(0);
+	_scannerRssiFilters.Fill(RssiFilter{});
+	_scannerLinks.Fill(ScannerLink{});
 	_scannerDistances.Fill(0);
 	_scannerPositions.Fill(0.0);
 	_scannerPositionsSet = false;
+
+	// Devices are dropped; they leave their zones
+	const Core::TimePoint now = Core::Clock::now();
+	for (const auto devIdx : _deviceIndex) {
+		auto & dev = _devices[devIdx];
+		_zones.Leave(_deviceMacs[devIdx], dev.Zones, dev.Zones, now);
+	}
 	_devices.clear();
+	_deviceIndex.Clear();
+	_macIndex.Clear();
+	_fingerprintIndex.Clear();
 }
 
 const ScannerInfo * DeviceMemory::GetScanner(std::uint16_t connId) const
@@ -300,6 +461,17 @@ void DeviceMemory::VisitScanners(const std::function<void(const ScannerInfo &)>
 	}
 }
 
+void DeviceMemory::UpdateCalibration(const Mac & mac)
+{
+	if (auto sc = _FindScanner(mac); sc != _scanners.end()) {
+		sc->Calib = _calibration.Resolve(mac);
+		_UpdateScannerDistances(std::distance(_scanners.begin(), sc));
+	}
+	else if (auto dev = _FindDevice(mac); dev != _devices.end()) {
+		dev->Calib = _calibration.Resolve(mac);
+	}
+}
+
 DeviceMemory::ScannerIt DeviceMemory::_FindScanner(const Mac & mac)
 {
 	return std::find_if(_scanners.begin(), _scanners.end(),
@@ -308,69 +480,220 @@ DeviceMemory::ScannerIt DeviceMemory::_FindScanner(const Mac & mac)
 
 DeviceMemory::DeviceIt DeviceMemory::_FindDevice(const Mac & mac)
 {
-	return std::find_if(_devices.begin(), _devices.end(),
-	                    [&mac](const DeviceMeasurements & s) { return s.Info.Bda == mac; });
+	const auto idx = _macIndex.Find(_MacHash(mac), [&](const Core::LruIndex::Index i) {
+		return _deviceMacs[i] == mac;
+	});
+	return (idx == Core::HashIndex::Npos) ? _devices.end() : (_devices.begin() + idx);
 }
 
 void DeviceMemory::_AddDevice(DeviceMeasurements device)
 {
-	if (_devices.size() > MaximumDevices) {
-		auto it =
-		    std::min_element(_devices.begin(), _devices.end(),
-		                     [](const DeviceMeasurements & lhs, const DeviceMeasurements & rhs) {
-			                     return lhs.LastUpdate < rhs.LastUpdate;
-		                     });
-		if (it == _devices.end()) {
-			return;
+	if (_deviceIndex.Full()) {
+		// Replace the least recently updated device
+		_RemoveDevice(_devices.begin() + _deviceIndex.Oldest());
+	}
+
+	const auto idx = _deviceIndex.Acquire();
+	assert(idx <= _devices.size());
+	_deviceMacs[idx] = device.Info.Bda;
+	_macIndex.Insert(_MacHash(device.Info.Bda), idx);
+	const DeviceInfo & info = device.Info;
+	const auto advData = std::span(info.AdvData).first(
+	    std::min<std::size_t>(info.AdvDataSize, info.AdvData.size()));
+	// Resolved devices are stored under their identity address, which doesn't rotate
+	const bool rotating = IsRotatingAddress(info.Bda, info.IsBle(), info.IsAddrTypePublic())
+	                      && !_irks.IsIdentity(info.Bda);
+	_deviceFingerprints[idx] = rotating ? AdvFingerprint(info.EventType, advData) : NoFingerprint;
+	if (_deviceFingerprints[idx] != NoFingerprint) {
+		_fingerprintIndex.Insert(_deviceFingerprints[idx], idx);
+	}
+	if (idx == _devices.size()) {
+		// Slots are acquired in ascending order; never used slot
+		_devices.push_back(std::move(device));
+	}
+	else {
+		_devices[idx] = std::move(device);
+	}
+}
+
+DeviceMemory::DeviceIt DeviceMemory::_AssociateDevice(const Core::DeviceDataView & view,
+                                                      const Core::TimePoint & time)
+{
+	const Mac bda(view.Mac());
+	const bool isBle = view.Flags() & Core::FlagMask::IsBle;
+	const bool isPublic = view.Flags() & Core::FlagMask::IsAddrTypePublic;
+	if (!_cfg.AssociateRandomAddresses || !IsRotatingAddress(bda, isBle, isPublic)) {
+		return _devices.end();
+	}
+
+	const auto advData =
+	    view.AdvData().first(std::min<std::size_t>(view.AdvDataSize(), view.AdvData().size()));
+	const std::uint32_t fingerprint = AdvFingerprint(view.EventType(), advData);
+	if (fingerprint == NoFingerprint) {
+		return _devices.end();
+	}
+
+	// Has to be unique - the predicate never matches, so it visits every candidate
+	auto foundIdx = Core::HashIndex::Npos;
+	bool ambiguous = false;
+	_fingerprintIndex.Find(fingerprint, [&](const Core::LruIndex::Index i) {
+		if (_deviceFingerprints[i] == fingerprint) {
+			ambiguous = ambiguous || (foundIdx != Core::HashIndex::Npos);
+			foundIdx = i;
 		}
-		_devices.erase(it);
+		return false;
+	});
+	if (foundIdx == Core::HashIndex::Npos || ambiguous) {
+		return _devices.end();
 	}
+	const DeviceIt found = _devices.begin() + foundIdx;
+
+	// The old address has to be silent on every scanner for a while before the new one
+	// appears; addresses heard around the same time are 2 devices with the same fingerprint
+	const auto gap = static_cast<std::int64_t>(_cfg.AssociationGap);
+	const bool overlapping =
+	    std::any_of(found->Data.begin(), found->Data.end(), [&](const MeasurementData & m) {
+		    return Core::DeltaMs(m.LastUpdate, time) < gap;
+	    });
+	if (overlapping) {
+		return _devices.end();
+	}
+
+	ESP_LOGD(TAG, "Associated %s -> %s", ToString(found->Info.Bda).c_str(),
+	         ToString(bda).c_str());
+	_macIndex.Erase(_MacHash(found->Info.Bda), foundIdx);
+	_deviceMacs[foundIdx] = bda;
+	_macIndex.Insert(_MacHash(bda), foundIdx);
+	found->Info.Bda = bda;
+	_associatedAddresses++;
+	return found;
+}
+
+void DeviceMemory::_RemoveDevice(DeviceIt devIt)
+{
+	const auto idx = std::distance(_devices.begin(), devIt);
+	_zones.Leave(_deviceMacs[idx], devIt->Zones, devIt->Zones, Core::Clock::now());
+	_macIndex.Erase(_MacHash(_deviceMacs[idx]), idx);
+	if (_deviceFingerprints[idx] != NoFingerprint) {
+		_fingerprintIndex.Erase(_deviceFingerprints[idx], idx);
+	}
+	_deviceIndex.Release(idx);
+	devIt->Data.clear();
+}
 
-	_devices.push_back(std::move(device));
+std::uint32_t DeviceMemory::_MacHash(const Mac & mac)
+{
+	return Core::Fnv1a(mac.Addr);
 }
 
-void DeviceMemory::_UpdateDistance(ScannerIt sIt, const Core::DeviceDataView::Array & devices)
+void DeviceMemory::_UpdateDistance(ScannerIt sIt,
+                                   const Core::DeviceDataView::Array & devices,
+                                   std::span<const Core::RssiStats> stats)
 {
+	const Core::TimePoint now = Core::Clock::now();
+	_UpdateClockOffset(sIt, devices, now);
+
 	for (std::size_t i = 0; i < devices.Size; i++) {
 		const Core::DeviceDataView & view = devices[i];
 		const auto bda = view.Mac();
+		const float confidence =
+		    MeasurementData::RssiConfidence(i < stats.size() ? &stats[i] : nullptr);
 
 		// Check scanners first
 		if (const auto & s1 = _FindScanner(bda); s1 != _scanners.end()) {
 			// It's a scanner
 			_UpdateScanner(sIt, s1, view.Rssi());
+			continue;
+		}
+
+		// Measurement time in Master's clock
+		const Core::TimePoint time =
+		    std::min(Core::FromUnix(view.Timestamp()) + std::chrono::milliseconds(sIt->ClockOffset),
+		             now);
+
+		// Private address of a device with a known IRK -> identity address
+		const bool isBle = view.Flags() & Core::FlagMask::IsBle;
+		const bool isPublic = view.Flags() & Core::FlagMask::IsAddrTypePublic;
+		const std::optional<Mac> identity = _irks.Resolve(bda, isBle, isPublic);
+		const Mac addr = identity.value_or(Mac(bda));
+
+		DeviceIt dev = _FindDevice(addr);
+		if (dev == _devices.end() && !identity.has_value()) {
+			// Maybe a known device with a new address
+			dev = _AssociateDevice(view, time);
 		}
-		else if (const auto & dev = _FindDevice(bda); dev != _devices.end()) {
+
+		if (dev != _devices.end()) {
 			// Found device
-			_UpdateDevice(sIt, dev, view.Rssi());
+			_UpdateDevice(sIt, dev, view.Rssi(), time, confidence);
 		}
 		else {
 			// Not a device nor a scanner -> new device
 			const std::size_t idx = std::distance(_scanners.begin(), sIt);
-			_AddDevice(DeviceMeasurements(view, MeasurementData{idx, view.Rssi()}));
+			const MeasurementData first{idx, view.Rssi(), time, _cfg.RssiFilterCfg, confidence};
+			DeviceMeasurements device(view, first, _calibration.Resolve(addr), _cfg.HistoryLength,
+			                          _devices.get_allocator());
+			device.Info.Bda = addr;
+			_AddDevice(std::move(device));
+		}
+	}
+}
+
+void DeviceMemory::_UpdateClockOffset(ScannerIt sIt,
+                                      const Core::DeviceDataView::Array & devices,
+                                      const Core::TimePoint & now)
+{
+	// The newest record was updated on the Scanner shortly before it was sent
+	std::uint32_t newest = 0;
+	for (std::size_t i = 0; i < devices.Size; i++) {
+		newest = std::max(newest, devices[i].Timestamp());
+	}
+	const std::int64_t offset = Core::DeltaMs(Core::FromUnix(newest), now);
+
+	if (!sIt->ClockOffsetSet || (offset < sIt->ClockOffset)) {
+		// Smallest delay seen so far is the best estimate
+		sIt->ClockOffset = offset;
+		sIt->ClockOffsetSet = true;
+		sIt->ClockOffsetTime = now;
+	}
+	else if (offset > sIt->ClockOffset) {
+		// Follow the clock drift by the time passed, not by the payloads received; the unused
+		// time is kept for the following payloads
+		const std::int64_t allowed = Core::DeltaMs(sIt->ClockOffsetTime, now) / ClockDriftPeriod;
+		const std::int64_t step = std::min(offset - sIt->ClockOffset, allowed);
+		sIt->ClockOffset += step;
+		if (step < allowed) {
+			sIt->ClockOffsetTime = now;  // Caught up
+		}
+		else {
+			sIt->ClockOffsetTime += std::chrono::milliseconds(step * ClockDriftPeriod);
 		}
 	}
 }
 
-void DeviceMemory::_UpdateDevice(ScannerIt sIt, DeviceIt devIt, std::int8_t rssi)
+void DeviceMemory::_UpdateDevice(ScannerIt sIt,
+                                 DeviceIt devIt,
+                                 std::int8_t rssi,
+                                 const Core::TimePoint & time,
+                                 float confidence)
 {
 	// Look up if measurement already exists
-	std::vector<MeasurementData> & devMeas = devIt->Data;
+	DeviceMeasurements::MeasurementVector & devMeas = devIt->Data;
 	const std::size_t sIdx = std::distance(_scanners.begin(), sIt);
 	auto meas = std::find_if(devMeas.begin(), devMeas.end(),
 	                         [sIdx](const MeasurementData & m) { return m.ScannerIdx == sIdx; });
 
 	if (meas != devMeas.end()) {
 		// Measurement exists, update
-		meas->Rssi = (meas->Rssi + rssi) / 2;
-
-		const Core::TimePoint now = Core::Clock::now();
-		meas->LastUpdate = now;
+		meas->Update(rssi, time, _cfg.RssiFilterCfg, confidence);
 	}
 	else {
 		// First measurement
-		devMeas.emplace_back(sIdx, rssi);
+		devMeas.emplace_back(sIdx, rssi, time, _cfg.RssiFilterCfg, confidence);
 	}
+
+	devIt->LastUpdate = Core::Clock::now();
+	_deviceIndex.Touch(std::distance(_devices.begin(), devIt));
 }
 
 void DeviceMemory::_UpdateScanner(ScannerIt sc1, ScannerIt sc2, std::int8_t rssi)
@@ -380,23 +703,16 @@ void DeviceMemory::_UpdateScanner(ScannerIt sc1, ScannerIt sc2, std::int8_t rssi
 
 	_scannerPositionsSet = false;
 
-	// Look up if measurement already exists
-	if (_scannerRssis(sIdx1, sIdx2) != 0) {
-		// Measurement exists, update
-		_scannerRssis(sIdx1, sIdx2) = (_scannerRssis(sIdx1, sIdx2) + rssi) / 2;
-	}
-	else {
-		// First measurement
-		_scannerRssis(sIdx1, sIdx2) = rssi;
-	}
+	const Core::TimePoint now = Core::Clock::now();
+	_scannerLinks(sIdx1, sIdx2).Update(rssi, now);
 
-	const auto & v = Nvs::Cache::Instance().GetValues(_scanners[sIdx1].Info.Bda.Addr);
-	const std::int8_t refPathLoss = v.RefPathLoss.value_or(_cfg.DefaultPathLoss);
-	const float envFactor = v.EnvFactor.value_or(_cfg.DefaultEnvFactor);
+	auto & filter = _scannerRssiFilters(sIdx1, sIdx2);
+	_scannerRssis(sIdx1, sIdx2) = filter.Update(_cfg.RssiFilterCfg, rssi);
+
+	const Calibration & calib = sc1->Calib;
 	const std::int8_t rssiVal = _scannerRssis(sIdx1, sIdx2);
-	const Core::TimePoint now = Core::Clock::now();
 
-	_scannerDistances(sIdx1, sIdx2) = PathLoss::LogDistance(rssiVal, envFactor, refPathLoss);
+	_scannerDistances(sIdx1, sIdx2) = calib.Distance(rssiVal);
 	sc1->LastUpdate = now;
 	if (_scannerRssis(sIdx2, sIdx1) == 0) {  // dist(i, j) == dist(j, i)
 		_scannerRssis(sIdx2, sIdx1) = _scannerRssis(sIdx1, sIdx2);
@@ -406,7 +722,27 @@ void DeviceMemory::_UpdateScanner(ScannerIt sc1, ScannerIt sc2, std::int8_t rssi
 	ESP_LOGI(TAG, "%s found %s: Rssi: %d, Dist: %.2f, RefPathLoss: %d, EnvFactor: %.2f",
 	         ToString(_scanners[sIdx1].Info.Bda.Addr).c_str(),
 	         ToString(_scanners[sIdx2].Info.Bda.Addr).c_str(), rssiVal,
-	         _scannerDistances(sIdx1, sIdx2), refPathLoss, envFactor);
+	         _scannerDistances(sIdx1, sIdx2), calib.RefPathLoss, calib.EnvFactor);
+}
+
+void DeviceMemory::_UpdateScannerDistances(std::size_t sIdx)
+{
+	if (sIdx >= _scannerRssis.Rows()) {
+		return;
+	}
+
+	// Filtered RSSIs are kept, so only the conversion changes. Entries the scanner measured
+	// use its calibration, so do the mirrored ones the other scanner didn't measure itself.
+	const Calibration & calib = _scanners[sIdx].Calib;
+	for (std::size_t i = 0; i < _scannerRssis.Rows(); i++) {
+		if (_scannerRssiFilters(sIdx, i).Value() != 0) {
+			_scannerDistances(sIdx, i) = calib.Distance(_scannerRssis(sIdx, i));
+			if (_scannerRssiFilters(i, sIdx).Value() == 0) {
+				_scannerDistances(i, sIdx) = _scannerDistances(sIdx, i);
+			}
+		}
+	}
+	_scannerPositionsSet = false;
 }
 
 void DeviceMemory::_RemoveScanner(ScannerIt sIt)
@@ -419,20 +755,12 @@ void DeviceMemory::_RemoveScanner(ScannerIt sIt)
 	// Remove device measurements with this index
 	_ResetDeviceMeasurements();
 
-	// Remove from scanner distances - shift and reshape.
-	// Shifts everything towards the empty column/row, which gets created by removing this scanner.
-	const std::size_t size = _scannerDistances.Rows();  // (Symmetric)
-	for (std::size_t i = sIdx + 1; i < size; i++) {
-		for (std::size_t j = 0; j < size; j++) {
-			_scannerDistances(i, j) = _scannerDistances(i - 1, j);
-			_scannerDistances(j, i) = _scannerDistances(j, i - 1);
-
-			_scannerRssis(i, j) = _scannerRssis(i - 1, j);
-			_scannerRssis(j, i) = _scannerRssis(j, i - 1);
-		}
-	}
-	_scannerDistances.Reshape(size - 1, size - 1);
-	_scannerRssis.Reshape(size - 1, size - 1);
+	// Remove from the scanner matrices - the following scanners move to the freed row/column
+	RemoveScannerIdx(_scannerDistances, sIdx);
+	RemoveScannerIdx(_scannerRssis, sIdx);
+	RemoveScannerIdx(_scannerRssiFilters, sIdx);
+	RemoveScannerIdx(_scannerLinks, sIdx);
+	_advertiseCursor = 0;
 
 	_UpdateScannerPositions();
 }
@@ -445,13 +773,26 @@ void DeviceMemory::_ResetDeviceMeasurements()
 	}
 }
 
+void DeviceMemory::_RemoveExpiredMeasurements(DeviceMeasurements & device,
+                                              const Core::TimePoint & now)
+{
+	_expiredMeasurements += std::erase_if(device.Data, [&](const MeasurementData & m) {
+		return (Core::DeltaMs(m.LastUpdate, now) > _cfg.MeasurementFreshness);
+	});
+}
+
 void DeviceMemory::_RemoveStaleDevices()
 {
 	const Core::TimePoint now = Core::Clock::now();  // just calculate it once
 
-	std::erase_if(_devices, [&](const DeviceMeasurements & dev) {
-		return (Core::DeltaMs(dev.LastUpdate, now) > _cfg.DeviceStoreTime);
-	});
+	// Index is ordered by the last update; stop at the first device which isn't stale
+	while (!_deviceIndex.Empty()) {
+		const auto oldest = _deviceIndex.Oldest();
+		if (Core::DeltaMs(_devices[oldest].LastUpdate, now) <= _cfg.DeviceStoreTime) {
+			break;
+		}
+		_RemoveDevice(_devices.begin() + oldest);
+	}
 }
 
 void DeviceMemory::_UpdateScannerCenter()
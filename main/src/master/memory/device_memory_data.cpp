@@ -5,26 +5,62 @@
 namespace Master
 {
 
-MeasurementData::MeasurementData(std::size_t scannerIdx, std::int8_t rssi)
+namespace
+{
+/// @brief Assumed variance of a single RSSI sample [dBm^2]
+constexpr float SingleRssiVariance = 4.0f;
+}  // namespace
+
+MeasurementData::MeasurementData(std::size_t scannerIdx,
+                                 std::int8_t rssi,
+                                 const Core::TimePoint & time,
+                                 const RssiFilterConfig & filterCfg,
+                                 float confidence)
     : ScannerIdx(scannerIdx)
-    , Rssi(rssi)
-    , LastUpdate(Core::Clock::now())
+    , LastUpdate(time)
+    , Confidence(confidence)
+{
+	Rssi = Filter.Update(filterCfg, rssi);
+}
+
+void MeasurementData::Update(std::int8_t rssi,
+                             const Core::TimePoint & time,
+                             const RssiFilterConfig & filterCfg,
+                             float confidence)
 {
+	Rssi = Filter.Update(filterCfg, rssi);
+	LastUpdate = std::max(LastUpdate, time);
+	Confidence = confidence;
+}
+
+float MeasurementData::RssiConfidence(const Core::RssiStats * stats)
+{
+	// A single sample doesn't have a variance
+	if (stats == nullptr || stats->Count < 2) {
+		return 1.0f / (1.0f + SingleRssiVariance);
+	}
+	return 1.0f / (1.0f + stats->VarianceDbm() / stats->Count);
 }
 
 DeviceMeasurements::DeviceMeasurements(const Core::DeviceDataView & data,
-                                       const MeasurementData & firstMeasurement)
+                                       const MeasurementData & firstMeasurement,
+                                       const Calibration & calibration,
+                                       std::size_t historyLength,
+                                       const Core::CapsAllocator<MeasurementData> & allocator)
     : Info({data.Mac(), data.Flags(), data.AdvDataSize(), data.EventType(), {}})
-    , Data({firstMeasurement})
+    , Data({firstMeasurement}, allocator)
     , Position{InvalidPos, InvalidPos, InvalidPos}
     , LastUpdate(Core::Clock::now())
+    , Calib(calibration)
+    , History(historyLength, allocator)
 {
 	std::copy(data.AdvData().begin(), data.AdvData().end(), Info.AdvData.begin());
 }
 
-ScannerDetail::ScannerDetail(const ScannerInfo & info)
+ScannerDetail::ScannerDetail(const ScannerInfo & info, const Calibration & calibration)
     : Info(info)
     , LastUpdate(Core::Clock::now())
+    , Calib(calibration)
 {
 }
 
@@ -0,0 +1,129 @@
+#include "master/memory/irk_resolver.h"
+
+#include <esp_log.h>
+
+#include <algorithm>
+#include <bit>
+
+namespace
+{
+/// @brief Logger tag
+static const char * TAG = "Irk";
+}  // namespace
+
+namespace Master
+{
+
+std::optional<Irk> Irk::Parse(std::span<const std::uint8_t> data)
+{
+	if (data.size() < Size) {
+		return std::nullopt;
+	}
+
+	Irk irk;
+	irk.Identity = Mac(data.first<Mac::Size>());
+	std::copy_n(data.begin() + Mac::Size, KeySize, irk.Value.begin());
+	if (std::all_of(irk.Value.begin(), irk.Value.end(), [](std::uint8_t b) { return b == 0; })) {
+		return std::nullopt;
+	}
+	return irk;
+}
+
+bool IsResolvableAddress(const Mac & bda, bool isBle, bool isPublic)
+{
+	return isBle && !isPublic && ((bda.Addr[0] & 0xC0) == 0x40);
+}
+
+IrkResolver::IrkResolver()
+{
+	for (auto & aes : _aes) {
+		mbedtls_aes_init(&aes);
+	}
+}
+
+IrkResolver::~IrkResolver()
+{
+	for (auto & aes : _aes) {
+		mbedtls_aes_free(&aes);
+	}
+}
+
+void IrkResolver::SetIrk(std::uint8_t id, const std::optional<Irk> & irk)
+{
+	if (id >= Irk::MaxIrks) {
+		return;
+	}
+
+	const std::uint16_t bit = std::uint16_t(1) << id;
+	_used &= ~bit;
+	if (irk.has_value()) {
+		const Irk & value = irk.value();
+		if (mbedtls_aes_setkey_enc(&_aes[id], value.Value.data(), Irk::KeySize * 8) == 0) {
+			_identities[id] = value.Identity;
+			_used |= bit;
+		}
+		else {
+			ESP_LOGW(TAG, "Failed to set key %d", id);
+		}
+	}
+	_cache.fill(CacheEntry{});
+}
+
+std::optional<Mac> IrkResolver::Resolve(const Mac & bda, bool isBle, bool isPublic)
+{
+	if (_used == 0 || !IsResolvableAddress(bda, isBle, isPublic)) {
+		return std::nullopt;
+	}
+
+	// Index by the lowest bits of the hash part
+	CacheEntry & entry = _cache[bda.Addr[Mac::Size - 1] % CacheSize];
+	if (entry.Id == CacheEntry::Empty || entry.Rpa != bda) {
+		entry.Rpa = bda;
+		entry.Id = _Resolve(bda);
+	}
+
+	if (entry.Id == CacheEntry::NoMatch) {
+		return std::nullopt;
+	}
+	return _identities[entry.Id];
+}
+
+bool IrkResolver::IsIdentity(const Mac & bda) const
+{
+	for (std::uint16_t used = _used; used != 0; used &= used - 1) {
+		if (_identities[std::countr_zero(used)] == bda) {
+			return true;
+		}
+	}
+	return false;
+}
+
+std::array<std::uint8_t, 3> IrkResolver::Ah(mbedtls_aes_context & aes,
+                                            std::span<const std::uint8_t, 3> prand)
+{
+	// r' = padding (zeros) || prand; ah = e(k, r') mod 2^24
+	std::array<std::uint8_t, 16> input{};
+	std::copy(prand.begin(), prand.end(), input.end() - prand.size());
+
+	std::array<std::uint8_t, 16> output;
+	mbedtls_aes_crypt_ecb(&aes, MBEDTLS_AES_ENCRYPT, input.data(), output.data());
+	return {output[13], output[14], output[15]};
+}
+
+std::uint8_t IrkResolver::_Resolve(const Mac & rpa)
+{
+	// Address (MSB first): [3B prand][3B hash]
+	const std::span<const std::uint8_t, 3> prand(rpa.Addr.begin(), 3);
+	const std::span<const std::uint8_t, 3> hash(rpa.Addr.begin() + 3, 3);
+
+	for (std::uint16_t used = _used; used != 0; used &= used - 1) {
+		const auto id = std::countr_zero(used);
+		_computations++;
+		if (std::ranges::equal(Ah(_aes[id], prand), hash)) {
+			return id;
+		}
+	}
+	return CacheEntry::NoMatch;
+}
+
+}  // namespace Master
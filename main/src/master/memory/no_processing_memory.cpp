@@ -14,8 +14,12 @@ namespace Master
 {
 NoProcessingMemory::NoProcessingMemory(const AppConfig::DeviceMemoryConfig & cfg)
     : IDeviceMemory(cfg)
+    , _measurements(cfg.MaxDevices,
+                    Core::CapsAllocator<NoProcDeviceMeasurements>(cfg.DeviceTableRegion))
+    , _measurementIndex(cfg.MaxDevices)
+    , _measurementMacs(cfg.MaxDevices, Core::CapsAllocator<Mac>(Core::MemoryRegion::Internal))
+    , _macIndex(cfg.MaxDevices)
 {
-	_serializedData.reserve(MaxSerializedDataSize);
 	_scanners.reserve(_cfg.MaxScanners);
 }
 
@@ -49,10 +53,14 @@ void NoProcessingMemory::RemoveScanner(std::uint16_t connId)
 	_scanners.erase(it);
 
 	// Invalidate any measurements with this scanner
-	for (NoProcDeviceMeasurements & meas : _measurements) {
+	for (auto it = _measurementIndex.begin(); it != _measurementIndex.end();) {
+		const auto mIdx = *it++;  // Advance first; the slot might get released
+		NoProcDeviceMeasurements & meas = _measurements[mIdx];
 		if (meas.Data[sIdx].IsValid()) {
 			meas.Data[sIdx].Invalidate();
-			meas.ValidMeasurements--;
+			if (--meas.ValidMeasurements == 0) {
+				_ReleaseMeasurement(mIdx);
+			}
 		}
 	}
 }
@@ -60,7 +68,7 @@ void NoProcessingMemory::RemoveScanner(std::uint16_t connId)
 const ScannerInfo * NoProcessingMemory::GetScanner(std::uint16_t connId) const
 {
 	auto it = std::find_if(_scanners.begin(), _scanners.end(),
-	                       [connId](const ScannerDetail & s) { return s.Info.ConnId == connId; });
+	                       [connId](const ScannerInfo & s) { return s.ConnId == connId; });
 	return (it == _scanners.end()) ? nullptr : &*it;
 }
 
@@ -69,21 +77,22 @@ void NoProcessingMemory::VisitScanners(const std::function<void(const ScannerInf
 	std::for_each(_scanners.begin(), _scanners.end(), fn);
 }
 
-bool NoProcessingMemory::IsConnectedScanner(const Bt::Device & dev) const
+bool NoProcessingMemory::IsConnectedScanner(const Bt::ScanResultView & dev) const
 {
 	// Early simple checks
-	if (!dev.IsBle() || dev.GetBle().AddrType != BLE_ADDR_TYPE_PUBLIC
-	    || dev.GetBle().EirData.Records.size() != 1) {
+	if (!dev.IsBlePublic() || !dev.Eir().IsSingleRecord()) {
 		return false;
 	}
 
+	const Mac bda(dev.Bda());
 	return std::find_if(_scanners.begin(), _scanners.end(),
-	                    [&dev](const ScannerInfo & s) { return s.Bda == dev.Bda; })
+	                    [&bda](const ScannerInfo & s) { return s.Bda == bda; })
 	       != _scanners.end();
 }
 
 void NoProcessingMemory::UpdateDistance(const std::uint16_t scannerConnId,
-                                        const Core::DeviceDataView::Array & devices)
+                                        const Core::DeviceDataView::Array & devices,
+                                        std::span<const Core::RssiStats> /*stats*/)
 {
 	auto it =
 	    std::find_if(_scanners.begin(), _scanners.end(),
@@ -97,7 +106,8 @@ void NoProcessingMemory::UpdateDistance(const std::uint16_t scannerConnId,
 }
 
 void NoProcessingMemory::UpdateDistance(const Mac & scanner,
-                                        const Core::DeviceDataView::Array & devices)
+                                        const Core::DeviceDataView::Array & devices,
+                                        std::span<const Core::RssiStats> /*stats*/)
 {
 	if (auto it = _FindScanner(scanner); it != _scanners.end()) {
 		_UpdateDistance(it, devices);
@@ -107,37 +117,34 @@ void NoProcessingMemory::UpdateDistance(const Mac & scanner,
 	}
 }
 
-std::span<std::uint8_t> NoProcessingMemory::SerializeOutput()
+bool NoProcessingMemory::SerializeOutput(std::vector<std::uint8_t> & output)
 {
-	// 4B Timestamp, 1B scanner count (N), 1B measurements Count
+	// 4B Timestamp, 1B scanner count (N), 2B measurements Count
 	//             6B
 	// [Scanner] { MAC }
 	///                 6B       N*5B        1B   1B    1B     62B =  71+5*N
 	/// [Measurement] { MAC (Timepoint,RSSI) Flag Len EvtType AdvData }
 
 	constexpr std::size_t SingleScannerSize = 6;
-	// Resize to max, shrink at the end
-	_serializedData.resize(MaxSerializedDataSize);
+	// Only as large as needed; the buffer doesn't grow to the maximum table size
+	output.resize(GetSerializedDataSize(_measurementIndex.Size(), _scanners.size()));
 
-	std::size_t offset = 6;
+	std::size_t offset = 7;
 	// Scanners
 	for (std::size_t i = 0; i < _scanners.size(); i++) {
 		std::copy(_scanners[i].Bda.Addr.begin(), _scanners[i].Bda.Addr.end(),
-		          _serializedData.data() + offset);
+		          output.data() + offset);
 		offset += SingleScannerSize;
 	}
 
 	// Measurements
 	std::size_t serializedMeasurements = 0;
-	for (std::size_t i = 0; i < _measurements.size(); i++) {
-		const auto & m = _measurements.at(i);
-		if (m.ValidMeasurements == 0) {
-			continue;
-		}
+	for (const auto mIdx : _measurementIndex) {
+		const auto & m = _measurements[mIdx];
 		serializedMeasurements++;
 
 		// BDA
-		std::copy(m.Info.Bda.Addr.begin(), m.Info.Bda.Addr.end(), _serializedData.data() + offset);
+		std::copy(m.Info.Bda.Addr.begin(), m.Info.Bda.Addr.end(), output.data() + offset);
 		offset += 6;
 
 		// (timestamp, RSSI)
@@ -146,31 +153,32 @@ std::span<std::uint8_t> NoProcessingMemory::SerializeOutput()
 
 			const auto time = Core::ToUnix(dat.LastUpdate);
 			std::copy_n(reinterpret_cast<const std::uint8_t *>(&time), 4,
-			            _serializedData.data() + offset);
-			_serializedData[offset + 4] = dat.Rssi;
+			            output.data() + offset);
+			output[offset + 4] = dat.Rssi;
 
 			offset += 4 + 1;
 		}
 
 		// Flags
-		_serializedData[offset++] = m.Info.Flags;        // Flags
-		_serializedData[offset++] = m.Info.AdvDataSize;  // AdvDataLen
-		_serializedData[offset++] = m.Info.EventType;    // EventT
+		output[offset++] = m.Info.Flags;        // Flags
+		output[offset++] = m.Info.AdvDataSize;  // AdvDataLen
+		output[offset++] = m.Info.EventType;    // EventT
 
 		// AdvData
-		std::copy(m.Info.AdvData.begin(), m.Info.AdvData.end(), _serializedData.begin() + offset);
+		std::copy(m.Info.AdvData.begin(), m.Info.AdvData.end(), output.begin() + offset);
 		offset += m.Info.AdvData.size();
 	}
 	const std::uint32_t now = Core::ToUnix(Core::Clock::now());
-	std::copy_n(reinterpret_cast<const std::uint8_t *>(&now), 4, _serializedData.data());
-	_serializedData.at(4) = _scanners.size();
-	_serializedData.at(5) = serializedMeasurements;
+	std::copy_n(reinterpret_cast<const std::uint8_t *>(&now), 4, output.data());
+	output.at(4) = _scanners.size();
+	output.at(5) = static_cast<std::uint8_t>(serializedMeasurements & 0xFF);
+	output.at(6) = static_cast<std::uint8_t>(serializedMeasurements >> 8);
 
-	_serializedData.resize(GetSerializedDataSize(serializedMeasurements, _scanners.size()));
+	output.resize(GetSerializedDataSize(serializedMeasurements, _scanners.size()));
 
 	ESP_LOGI(TAG, "Serialized %d scanners, %d measurements", _scanners.size(),
 	         serializedMeasurements);
-	return _serializedData;
+	return true;
 }
 
 NoProcessingMemory::ScannerIt NoProcessingMemory::_FindScanner(const Mac & mac)
@@ -181,10 +189,21 @@ NoProcessingMemory::ScannerIt NoProcessingMemory::_FindScanner(const Mac & mac)
 
 NoProcessingMemory::MeasurementIt NoProcessingMemory::_FindMeasurement(const Mac & mac)
 {
-	return std::find_if(_measurements.begin(), _measurements.end(),
-	                    [&mac](const NoProcDeviceMeasurements & s) {
-		                    return (s.ValidMeasurements > 0) ? (s.Info.Bda == mac) : false;
-	                    });
+	const auto idx = _macIndex.Find(_MacHash(mac), [&](const Core::LruIndex::Index i) {
+		return _measurementMacs[i] == mac;
+	});
+	return (idx == Core::HashIndex::Npos) ? _measurements.end() : (_measurements.begin() + idx);
+}
+
+void NoProcessingMemory::_ReleaseMeasurement(Core::LruIndex::Index mIdx)
+{
+	_macIndex.Erase(_MacHash(_measurementMacs[mIdx]), mIdx);
+	_measurementIndex.Release(mIdx);
+}
+
+std::uint32_t NoProcessingMemory::_MacHash(const Mac & mac)
+{
+	return Core::Fnv1a(mac.Addr);
 }
 
 void NoProcessingMemory::_UpdateDistance(ScannerIt sIt, const Core::DeviceDataView::Array & devices)
@@ -202,13 +221,15 @@ void NoProcessingMemory::_UpdateDistance(ScannerIt sIt, const Core::DeviceDataVi
 			}
 		}
 		else {
-			// New - find the oldest one to swap with
-			it = std::min_element(_measurements.begin(), _measurements.end(),
-			                      [](const NoProcDeviceMeasurements & value,
-			                         const NoProcDeviceMeasurements & smallest) {
-				                      return value.LastUpdate < smallest.LastUpdate;
-			                      });
-			assert(it != _measurements.end());
+			// New - reuse the oldest one, if there are no free slots
+			if (_measurementIndex.Full()) {
+				_ReleaseMeasurement(_measurementIndex.Oldest());
+			}
+			const auto mIdx = _measurementIndex.Acquire();
+			assert(mIdx != Core::LruIndex::Npos);
+			it = _measurements.begin() + mIdx;
+			_measurementMacs[mIdx] = view.Mac();
+			_macIndex.Insert(_MacHash(_measurementMacs[mIdx]), mIdx);
 
 			it->Info.Bda = view.Mac();
 			it->Info.Flags = view.Flags();
@@ -224,6 +245,7 @@ void NoProcessingMemory::_UpdateDistance(ScannerIt sIt, const Core::DeviceDataVi
 		it->Data[sIdx].Rssi = view.Rssi();
 		it->Data[sIdx].LastUpdate = now;
 		it->LastUpdate = now;
+		_measurementIndex.Touch(std::distance(_measurements.begin(), it));
 	}
 }
 
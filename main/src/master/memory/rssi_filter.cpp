@@ -0,0 +1,101 @@
+#include "master/memory/rssi_filter.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace
+{
+
+/// @brief Clamp and round to RSSI
+/// @param v value
+/// @return RSSI
+std::int8_t ToRssi(float v)
+{
+	return static_cast<std::int8_t>(std::clamp(std::lround(v), -128l, 127l));
+}
+
+}  // namespace
+
+namespace Master
+{
+
+std::int8_t RssiFilter::Update(const RssiFilterConfig & cfg, std::int8_t rssi)
+{
+	switch (cfg.FilterType) {
+	case RssiFilterConfig::Type::Ema:
+		_value = _UpdateEma(cfg, rssi);
+		break;
+	case RssiFilterConfig::Type::Median:
+		_value = _UpdateMedian(rssi);
+		break;
+	case RssiFilterConfig::Type::Kalman:
+		_value = _UpdateKalman(cfg, rssi);
+		break;
+	}
+
+	if (_samples < std::numeric_limits<decltype(_samples)>::max()) {
+		_samples++;
+	}
+	return _value;
+}
+
+void RssiFilter::Reset()
+{
+	_state = {};
+	_value = 0;
+	_samples = 0;
+}
+
+std::int8_t RssiFilter::_UpdateEma(const RssiFilterConfig & cfg, std::int8_t rssi)
+{
+	EmaState & s = _state.Ema;
+	const std::int32_t sample = static_cast<std::int32_t>(rssi) * 256;
+	if (_samples == 0) {
+		s.Value = sample;
+		return rssi;
+	}
+
+	// v += alpha * (x - v)
+	const std::int32_t alpha = std::clamp<std::int32_t>(cfg.EmaAlpha, 1, 256);
+	s.Value += (alpha * (sample - s.Value)) / 256;
+
+	// Round to the nearest integer
+	return (s.Value >= 0) ? (s.Value + 128) / 256 : (s.Value - 128) / 256;
+}
+
+std::int8_t RssiFilter::_UpdateMedian(std::int8_t rssi)
+{
+	MedianState & s = _state.Median;
+	s.Samples[s.Head] = rssi;
+	s.Head = (s.Head + 1) % MedianWindow;
+
+	const std::size_t count = std::min<std::size_t>(_samples + 1, MedianWindow);
+	std::array<std::int8_t, MedianWindow> sorted;
+	std::copy_n(s.Samples.begin(), count, sorted.begin());
+
+	const auto mid = sorted.begin() + count / 2;
+	std::nth_element(sorted.begin(), mid, sorted.begin() + count);
+	return *mid;
+}
+
+std::int8_t RssiFilter::_UpdateKalman(const RssiFilterConfig & cfg, std::int8_t rssi)
+{
+	KalmanState & s = _state.Kalman;
+	if (_samples == 0) {
+		s.Estimate = rssi;
+		s.Variance = cfg.KalmanMeasurementNoise;
+		return rssi;
+	}
+
+	// Predict - constant RSSI model
+	s.Variance += cfg.KalmanProcessNoise;
+
+	// Update
+	const float gain = s.Variance / (s.Variance + cfg.KalmanMeasurementNoise);
+	s.Estimate += gain * (rssi - s.Estimate);
+	s.Variance *= (1.0f - gain);
+	return ToRssi(s.Estimate);
+}
+
+}  // namespace Master
@@ -0,0 +1,51 @@
+#include "master/memory/scanner_link.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace Master
+{
+
+void ScannerLink::Update(std::int8_t rssi, const Core::TimePoint & time)
+{
+	if (_samples < std::numeric_limits<std::uint16_t>::max()) {
+		_samples++;
+	}
+
+	// Exact mean/variance for the first few samples, exponentially weighted afterwards
+	const float alpha = 1.0f / std::min(_samples, VarianceWindow);
+	const float diff = rssi - _mean;
+	const float increment = alpha * diff;
+	_mean += increment;
+	_variance = (1.0f - alpha) * (_variance + diff * increment);
+	_lastUpdate = std::max(_lastUpdate, time);
+	_attempts = 0;
+}
+
+void ScannerLink::Attempt()
+{
+	if (_attempts < MaxAttempts) {
+		_attempts++;
+	}
+}
+
+float ScannerLink::Priority(const ScannerLinkConfig & cfg, const Core::TimePoint & now) const
+{
+	if (_samples == 0) {
+		return std::ldexp(MissingPriority, -_attempts);
+	}
+
+	// 1 when the link reaches its maximum age
+	const float age = static_cast<float>(Core::DeltaMs(_lastUpdate, now)) / cfg.MaxAge;
+	const bool converged = (_samples >= cfg.MinSamples) && (_variance <= cfg.ConvergedVariance);
+	if (converged && age < 1.0f) {
+		return 0.0f;
+	}
+
+	const float uncertainty =
+	    (_samples < cfg.MinSamples) ? 1.0f : (_variance / cfg.ConvergedVariance);
+	return std::ldexp(age + uncertainty, -_attempts);
+}
+
+}  // namespace Master
@@ -0,0 +1,102 @@
+#include "master/memory/trajectory.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace
+{
+/// @brief Position [m] to centimeters, saturated to the int16 range
+std::int16_t Quantise(float position)
+{
+	constexpr float Min = std::numeric_limits<std::int16_t>::min();
+	constexpr float Max = std::numeric_limits<std::int16_t>::max();
+	return static_cast<std::int16_t>(std::lround(std::clamp(position * 100.0f, Min, Max)));
+}
+
+/// @brief Write a value in the native byte order (little endian)
+template <typename T>
+std::uint8_t * Write(std::uint8_t * output, const T & value)
+{
+	std::memcpy(output, &value, sizeof(T));
+	return output + sizeof(T);
+}
+}  // namespace
+
+namespace Master
+{
+
+Trajectory::Trajectory(std::size_t length, const Core::CapsAllocator<Sample> & allocator)
+    : _samples(std::min(length, MaxLength), Sample{}, allocator)
+{
+}
+
+void Trajectory::Push(const Core::TimePoint & time, std::span<const float, 3> position)
+{
+	if (_samples.empty()) {
+		return;  // Disabled
+	}
+
+	std::uint16_t delta = 0;
+	if (_count == 0) {
+		_newest = time;
+	}
+	else {
+		const std::int64_t steps = std::chrono::round<TimeStep>(time - _newest).count();
+		if (steps <= 0) {
+			return;  // Not newer
+		}
+		constexpr std::int64_t MaxDelta = std::numeric_limits<std::uint16_t>::max();
+		delta = static_cast<std::uint16_t>(std::min(steps, MaxDelta));
+		// Gaps this long are only stored as the maximum delta
+		_newest = (steps > MaxDelta) ? time : _newest + TimeStep(delta);
+	}
+
+	Sample & sample = _samples[_head];
+	sample.TimeDelta = delta;
+	for (std::size_t i = 0; i < position.size(); i++) {
+		sample.Position[i] = Quantise(position[i]);
+	}
+
+	_head = (_head + 1) % _samples.size();
+	_count = std::min<std::size_t>(_count + 1, _samples.size());
+}
+
+void Trajectory::CopyTo(Snapshot & snapshot) const
+{
+	snapshot.Newest = _newest;
+	snapshot.Count = _count;
+	if (_count == 0) {
+		return;
+	}
+
+	const std::size_t oldest = (_head + _samples.size() - _count) % _samples.size();
+	for (std::size_t i = 0; i < _count; i++) {
+		snapshot.Samples[i] = _samples[(oldest + i) % _samples.size()];
+	}
+}
+
+void Trajectory::Snapshot::Serialize(const Mac & mac, std::vector<std::uint8_t> & output) const
+{
+	output.resize(HeaderSize + Count * SampleSize);
+
+	std::uint8_t * p = std::copy(mac.Addr.begin(), mac.Addr.end(), output.data());
+	Write(p, Count);
+
+	// Only the newest time is stored; the older ones are reconstructed from the deltas
+	std::int64_t time =
+	    std::chrono::duration_cast<std::chrono::milliseconds>(Newest.time_since_epoch()).count();
+	for (std::size_t i = Count; i-- > 0;) {
+		std::uint8_t * out = output.data() + HeaderSize + i * SampleSize;
+		out = Write(out, time);
+		for (const std::int16_t cm : Samples[i].Position) {
+			out = Write(out, cm / 100.0f);
+		}
+		time -= std::chrono::duration_cast<std::chrono::milliseconds>(
+		            TimeStep(Samples[i].TimeDelta))
+		            .count();
+	}
+}
+
+}  // namespace Master
@@ -0,0 +1,245 @@
+#include "master/memory/zones.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+/// @brief Read a float in the native byte order (little endian)
+float ReadFloat(const std::uint8_t * data)
+{
+	float value;
+	std::memcpy(&value, data, sizeof(float));
+	return value;
+}
+}  // namespace
+
+namespace Master
+{
+
+std::optional<Zone> Zone::Parse(std::span<const std::uint8_t> data)
+{
+	if (data.empty()) {
+		return std::nullopt;
+	}
+	const std::size_t count = data[0];
+	if (count < 2 || count > MaxVertices || data.size() < DefinitionSize(count)) {
+		return std::nullopt;
+	}
+
+	for (std::size_t i = 1; i < DefinitionSize(count); i += sizeof(float)) {
+		if (!std::isfinite(ReadFloat(&data[i]))) {
+			return std::nullopt;
+		}
+	}
+
+	Zone zone;
+	const auto [minZ, maxZ] = std::minmax({ReadFloat(&data[1]), ReadFloat(&data[5])});
+	zone.MinZ = minZ;
+	zone.MaxZ = maxZ;
+
+	for (std::size_t i = 0; i < count; i++) {
+		const std::uint8_t * vertex = &data[HeaderSize + i * VertexSize];
+		zone.Vertices[i] = {ReadFloat(vertex), ReadFloat(vertex + sizeof(float))};
+	}
+	zone.VertexCount = count;
+
+	if (count == 2) {
+		// Box corners -> polygon
+		const auto [x0, x1] = std::minmax({zone.Vertices[0][0], zone.Vertices[1][0]});
+		const auto [y0, y1] = std::minmax({zone.Vertices[0][1], zone.Vertices[1][1]});
+		zone.Vertices[0] = {x0, y0};
+		zone.Vertices[1] = {x1, y0};
+		zone.Vertices[2] = {x1, y1};
+		zone.Vertices[3] = {x0, y1};
+		zone.VertexCount = 4;
+	}
+
+	zone.Min = zone.Vertices[0];
+	zone.Max = zone.Vertices[0];
+	for (std::size_t i = 1; i < zone.VertexCount; i++) {
+		for (std::size_t axis = 0; axis < 2; axis++) {
+			zone.Min[axis] = std::min(zone.Min[axis], zone.Vertices[i][axis]);
+			zone.Max[axis] = std::max(zone.Max[axis], zone.Vertices[i][axis]);
+		}
+	}
+	return zone;
+}
+
+bool Zone::Contains(std::span<const float, 3> point) const
+{
+	const float x = point[0];
+	const float y = point[1];
+	if (point[2] < MinZ || point[2] > MaxZ || x < Min[0] || x > Max[0] || y < Min[1]
+	    || y > Max[1]) {
+		return false;
+	}
+
+	// Ray casting (even-odd rule)
+	bool inside = false;
+	for (std::size_t i = 0, j = VertexCount - 1; i < VertexCount; j = i++) {
+		const auto & a = Vertices[i];
+		const auto & b = Vertices[j];
+		if (((a[1] > y) != (b[1] > y))
+		    && (x < (b[0] - a[0]) * (y - a[1]) / (b[1] - a[1]) + a[0])) {
+			inside = !inside;
+		}
+	}
+	return inside;
+}
+
+void ZoneEvent::Serialize(std::span<std::uint8_t, Size> output) const
+{
+	std::memcpy(output.data() + SeqIdx, &Seq, sizeof(Seq));
+	std::memcpy(output.data() + TimestampIdx, &Timestamp, sizeof(Timestamp));
+	std::copy(Bda.Addr.begin(), Bda.Addr.end(), output.data() + BdaIdx);
+	output[ZoneIdIdx] = ZoneId;
+	output[TypeIdx] = static_cast<std::uint8_t>(EventType);
+
+	static_assert(Size == 16);  // Make sure we change this method, if the structure changes
+}
+
+ZoneEngine::ZoneEngine(std::size_t eventCapacity)
+    : _events(std::max<std::size_t>(eventCapacity, 1))
+{
+}
+
+void ZoneEngine::SetZone(std::uint8_t id, const std::optional<Zone> & zone)
+{
+	if (id >= Zone::MaxZones) {
+		return;
+	}
+
+	const Zone::Mask bit = Zone::Mask(1) << id;
+	if (zone.has_value()) {
+		_zones[id] = zone.value();
+		_used |= bit;
+	}
+	else {
+		_used &= ~bit;
+	}
+	_RebuildGrid();
+}
+
+Zone::Mask ZoneEngine::Find(std::span<const float, 3> point) const
+{
+	if (_used == 0) {
+		return 0;
+	}
+
+	std::array<std::size_t, 2> cell;
+	for (std::size_t axis = 0; axis < 2; axis++) {
+		if (!(point[axis] >= _gridMin[axis] && point[axis] <= _gridMax[axis])) {
+			return 0;  // Outside of all zones (or NaN)
+		}
+		cell[axis] = _CellOf(point[axis], axis);
+	}
+
+	Zone::Mask found = 0;
+	for (Zone::Mask candidates = _grid[cell[1] * GridSize + cell[0]]; candidates != 0;
+	     candidates &= candidates - 1) {
+		const auto id = std::countr_zero(candidates);
+		if (_zones[id].Contains(point)) {
+			found |= Zone::Mask(1) << id;
+		}
+	}
+	return found;
+}
+
+void ZoneEngine::Update(const Mac & bda,
+                        Zone::Mask & state,
+                        std::span<const float, 3> point,
+                        const Core::TimePoint & time,
+                        Zone::Mask mask)
+{
+	const Zone::Mask current = Find(point) & mask;
+	Leave(bda, state, mask & ~current, time);
+
+	for (Zone::Mask entered = current & ~state; entered != 0; entered &= entered - 1) {
+		_AddEvent(bda, std::countr_zero(entered), ZoneEvent::Type::Enter, time);
+	}
+	state |= current;
+}
+
+void ZoneEngine::Leave(const Mac & bda,
+                       Zone::Mask & state,
+                       Zone::Mask mask,
+                       const Core::TimePoint & time)
+{
+	for (Zone::Mask left = state & mask; left != 0; left &= left - 1) {
+		_AddEvent(bda, std::countr_zero(left), ZoneEvent::Type::Exit, time);
+	}
+	state &= ~mask;
+}
+
+bool ZoneEngine::SerializeEvents(std::vector<std::uint8_t> & output)
+{
+	if (_serializedSeq == _nextSeq) {
+		return false;
+	}
+	_serializedSeq = _nextSeq;
+
+	output.resize(_eventCount * ZoneEvent::Size);
+
+	const std::size_t oldest = (_eventHead + _events.size() - _eventCount) % _events.size();
+	for (std::size_t i = 0; i < _eventCount; i++) {
+		const std::span<std::uint8_t, ZoneEvent::Size> out(output.begin() + i * ZoneEvent::Size,
+		                                                    ZoneEvent::Size);
+		_events[(oldest + i) % _events.size()].Serialize(out);
+	}
+	return true;
+}
+
+void ZoneEngine::_RebuildGrid()
+{
+	_grid.fill(0);
+	if (_used == 0) {
+		return;
+	}
+
+	// Bounding box of all the zones
+	bool first = true;
+	for (Zone::Mask used = _used; used != 0; used &= used - 1) {
+		const Zone & zone = _zones[std::countr_zero(used)];
+		for (std::size_t axis = 0; axis < 2; axis++) {
+			_gridMin[axis] = first ? zone.Min[axis] : std::min(_gridMin[axis], zone.Min[axis]);
+			_gridMax[axis] = first ? zone.Max[axis] : std::max(_gridMax[axis], zone.Max[axis]);
+		}
+		first = false;
+	}
+	for (std::size_t axis = 0; axis < 2; axis++) {
+		const float size = (_gridMax[axis] - _gridMin[axis]) / GridSize;
+		_cellSize[axis] = (size > 0) ? size : 1.0f;
+	}
+
+	// Mark cells overlapped by the bounding box of each zone
+	for (Zone::Mask used = _used; used != 0; used &= used - 1) {
+		const auto id = std::countr_zero(used);
+		const Zone & zone = _zones[id];
+		for (std::size_t y = _CellOf(zone.Min[1], 1); y <= _CellOf(zone.Max[1], 1); y++) {
+			for (std::size_t x = _CellOf(zone.Min[0], 0); x <= _CellOf(zone.Max[0], 0); x++) {
+				_grid[y * GridSize + x] |= Zone::Mask(1) << id;
+			}
+		}
+	}
+}
+
+std::size_t ZoneEngine::_CellOf(float value, std::size_t axis) const
+{
+	const auto idx = static_cast<std::size_t>((value - _gridMin[axis]) / _cellSize[axis]);
+	return std::min(idx, GridSize - 1);
+}
+
+void ZoneEngine::_AddEvent(const Mac & bda,
+                           std::uint8_t zoneId,
+                           ZoneEvent::Type type,
+                           const Core::TimePoint & time)
+{
+	_events[_eventHead] = ZoneEvent{_nextSeq++, Core::ToUnix(time), bda, zoneId, type};
+	_eventHead = (_eventHead + 1) % _events.size();
+	_eventCount = std::min(_eventCount + 1, _events.size());
+}
+
+}  // namespace Master
@@ -20,8 +20,95 @@ static const char * TAG = "NVS";
 static const char * RefPathLossNamespace = "BtLocPL";
 static const char * EnvFactorNamespace = "BtLocEF";
 static const char * MacNameNamespace = "BtLocMN";
+static const char * ZoneNamespace = "BtLocZN";
+static const char * IrkNamespace = "BtLocIK";
+static const char * FilterNamespace = "BtLocFR";
 /// @}
 
+/// @brief NVS key of the scanner filter rules
+static const std::string FilterKey = "rules";
+
+/// @brief NVS key of a zone
+static std::string ZoneKey(std::uint8_t id)
+{
+	return "zone" + std::to_string(id);
+}
+
+/// @brief NVS key of an IRK
+static std::string IrkKey(std::uint8_t id)
+{
+	return "irk" + std::to_string(id);
+}
+
+/// @brief Store a blob
+/// @param ns namespace
+/// @param key key
+/// @param data data
+/// @param name name of the item for logging
+static void SetBlob(const char * ns,
+                    const std::string & key,
+                    std::span<const std::uint8_t> data,
+                    const char * name)
+{
+	esp_err_t err;
+	if (auto p = nvs::open_nvs_handle(ns, NVS_READWRITE, &err)) {
+		p.get()->set_blob(key.c_str(), data.data(), data.size());
+		p.get()->commit();
+
+		ESP_LOGI(TAG, "%s %s updated (%dB)", name, key.c_str(), data.size());
+	}
+	else {
+		ESP_LOGW(TAG, "Nvs open failed (Set %s): %d", name, err);
+	}
+}
+
+/// @brief Erase a blob
+/// @param ns namespace
+/// @param key key
+/// @param name name of the item for logging
+static void EraseBlob(const char * ns, const std::string & key, const char * name)
+{
+	esp_err_t err;
+	if (auto p = nvs::open_nvs_handle(ns, NVS_READWRITE, &err)) {
+		p.get()->erase_item(key.c_str());
+		p.get()->commit();
+
+		ESP_LOGI(TAG, "%s %s removed", name, key.c_str());
+	}
+	else {
+		ESP_LOGW(TAG, "Nvs open failed (Erase %s): %d", name, err);
+	}
+}
+
+/// @brief Load a blob
+/// @param ns namespace
+/// @param key key
+/// @param name name of the item for logging
+/// @return data or nullopt, if it isn't stored
+static std::optional<std::vector<std::uint8_t>> GetBlob(const char * ns,
+                                                        const std::string & key,
+                                                        const char * name)
+{
+	esp_err_t err;
+
+	std::vector<std::uint8_t> out;
+	if (auto p = nvs::open_nvs_handle(ns, NVS_READWRITE, &err)) {
+		std::size_t size = 0;
+		if (p.get()->get_item_size(nvs::ItemType::BLOB, key.c_str(), size) != ESP_OK) {
+			return std::nullopt;
+		}
+		out.resize(size);
+		if (p.get()->get_blob(key.c_str(), out.data(), size) != ESP_OK) {
+			return std::nullopt;
+		}
+	}
+	else {
+		ESP_LOGW(TAG, "Nvs open failed (Get %s): %d", name, err);
+		return std::nullopt;
+	}
+	return out;
+}
+
 /// @brief Doesn't allow "ridiculous" values for reference path loss, env factor, etc.
 constexpr bool ForceClampValues = true;
 
@@ -93,7 +180,7 @@ void Cache::SetEnvFactor(std::span<const std::uint8_t, 6> key, float envFactor)
 		return std::equal(key.begin(), key.end(), kv.Key.begin());
 	});
 	if (it != _vec.end()) {
-		it->Value.RefPathLoss.emplace(envFactor);
+		it->Value.EnvFactor.emplace(envFactor);
 	}
 }
 
@@ -211,4 +298,49 @@ std::optional<std::string> GetMacName(std::span<const std::uint8_t, 6> mac)
 	return std::optional<std::string>({out.begin(), out.end()});
 }
 
+void SetZone(std::uint8_t id, std::span<const std::uint8_t> definition)
+{
+	SetBlob(ZoneNamespace, ZoneKey(id), definition, "Zone");
+}
+
+void EraseZone(std::uint8_t id)
+{
+	EraseBlob(ZoneNamespace, ZoneKey(id), "Zone");
+}
+
+std::optional<std::vector<std::uint8_t>> GetZone(std::uint8_t id)
+{
+	return GetBlob(ZoneNamespace, ZoneKey(id), "Zone");
+}
+
+void SetIrk(std::uint8_t id, std::span<const std::uint8_t> definition)
+{
+	SetBlob(IrkNamespace, IrkKey(id), definition, "IRK");
+}
+
+void EraseIrk(std::uint8_t id)
+{
+	EraseBlob(IrkNamespace, IrkKey(id), "IRK");
+}
+
+std::optional<std::vector<std::uint8_t>> GetIrk(std::uint8_t id)
+{
+	return GetBlob(IrkNamespace, IrkKey(id), "IRK");
+}
+
+void SetFilterRules(std::span<const std::uint8_t> rules)
+{
+	SetBlob(FilterNamespace, FilterKey, rules, "Filter");
+}
+
+void EraseFilterRules()
+{
+	EraseBlob(FilterNamespace, FilterKey, "Filter");
+}
+
+std::optional<std::vector<std::uint8_t>> GetFilterRules()
+{
+	return GetBlob(FilterNamespace, FilterKey, "Filter");
+}
+
 }  // namespace Master::Nvs
@@ -6,9 +6,11 @@ namespace Math
 {
 
 PointToAnchors::PointToAnchors(const Math::Matrix<float> & anchorMatrix,
-                               std::span<const float> distances)
+                               std::span<const float> distances,
+                               std::span<const float> weights)
     : _anchorMatrix(anchorMatrix)
     , _distances(distances)
+    , _weights(weights)
 {
 }
 
@@ -22,6 +24,10 @@ float PointToAnchors::operator()(std::span<const float> point) const
 
 	float sum = 0.0;
 	for (int i = 0; i < anchorCount; i++) {
+		if (_distances[i] == 0.0) {
+			continue;  // Unknown
+		}
+
 		float error = 0.0;
 
 		// Euclidean distance
@@ -29,7 +35,7 @@ float PointToAnchors::operator()(std::span<const float> point) const
 			const float diff = point[j] - _anchorMatrix(i, j);
 			error += std::pow(diff, 2);
 		}
-		sum += (std::sqrt(error) - _distances[i]);
+		sum += _Weight(i) * (std::sqrt(error) - _distances[i]);
 	}
 	return sum;
 }
@@ -40,12 +46,16 @@ void PointToAnchors::Gradient(std::span<const float> point, std::span<float> gra
 
 	gradient[0] = gradient[1] = gradient[2] = 0.0;
 	for (int i = 0; i < _anchorMatrix.Rows(); i++) {
+		if (_distances[i] == 0.0) {
+			continue;  // Unknown
+		}
+
 		const float dx = point[0] - _anchorMatrix(i, 0);
 		const float dy = point[1] - _anchorMatrix(i, 1);
 		const float dz = point[2] - _anchorMatrix(i, 2);
 		const float rn = std::sqrt(dx * dx + dy * dy + dz * dz);
 
-		const float lhs = 2.0 * (rn - _distances[i]);
+		const float lhs = 2.0 * _Weight(i) * (rn - _distances[i]);
 		gradient[0] += lhs * (dx / rn);
 		gradient[1] += lhs * (dy / rn);
 		gradient[2] += lhs * (dz / rn);
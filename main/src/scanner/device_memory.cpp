@@ -3,6 +3,8 @@
 #include "core/clock.h"
 
 #include <algorithm>
+#include <cassert>
+#include <cmath>
 
 #include <esp_log.h>
 
@@ -17,28 +19,25 @@ namespace Scanner
 
 DeviceMemory::DeviceMemory(const AppConfig::DeviceMemoryConfig & cfg)
     : _cfg(cfg)
+    , _devData(cfg.MemorySizeLimit)
+    , _index(cfg.MemorySizeLimit)
+    , _macIndex(cfg.MemorySizeLimit)
+    , _payloadIndex(cfg.MemorySizeLimit)
 {
-	_devData.reserve(_cfg.MemorySizeLimit);
 }
 
-void DeviceMemory::AddDevice(const Bt::Device & device)
+void DeviceMemory::AddDevice(const ScanRecord & device)
 {
-	if (device.GetRssi() < _cfg.MinRssi) {
+	if (device.Rssi < _cfg.MinRssi) {
 		return;
 	}
-
-	// Remove old devices
-	RemoveStaleDevices();
+	_seen.set(_MacHash(device.Bda.Addr) % SeenBits);
 
 	// Try to find this device
-	const auto it = std::find_if(_devData.begin(), _devData.end(), [&](const DeviceInfo & dev) {
-		return std::equal(device.Bda.Addr.begin(), device.Bda.Addr.end(),
-		                  dev.GetDeviceData().View.Mac().begin());
-	});
-
-	if (it != _devData.end()) {
+	if (const Index idx = _FindDevice(device.Bda.Addr); idx != Core::LruIndex::Npos) {
 		// Found the device, just update it
-		it->Update(device.GetRssi());
+		_devData[idx]->Update(device.Rssi);
+		_index.Touch(idx);
 		return;
 	}
 
@@ -48,138 +47,254 @@ void DeviceMemory::AddDevice(const Bt::Device & device)
 	}
 
 	// Couldn't associate, try to make some space for it
-	if (_devData.size() >= _cfg.MemorySizeLimit) {
-		constexpr std::size_t RssiTolerance = 3;
-
-		// Find a device with the lowest RSSI and random MAC
-		auto min = std::min_element(
-		    _devData.begin(), _devData.end(),
-		    [](const DeviceInfo & value, const DeviceInfo & smallest) {
-			    const auto & vView = value.GetDeviceData().View;
-			    const auto & sView = smallest.GetDeviceData().View;
-			    if (!sView.IsAddrTypePublic()) {
-				    // 'smallest' has random MAC
-				    if (!vView.IsAddrTypePublic()) {
-					    return vView.Rssi() < sView.Rssi();  // ok - both random - compare
-				    }
-				    return false;  // don't swap smallest with public MAC
-			    }  // else 'smallest' has public MAC and we are only looking for random
-			    if (vView.IsAddrTypePublic()) {
-				    return true;  // random MAC - new smallest
-			    }
-			    return false;
-		    });
-
-		const bool minIsPublic = min->GetDeviceData().View.IsAddrTypePublic();
-		const bool minIsCloser =
-		    min->GetDeviceData().View.Rssi() > (device.GetRssi() - RssiTolerance);
-
-		if (device.IsBle() && (device.GetBle().AddrType == BLE_ADDR_TYPE_PUBLIC)) {
-			// Device has a public MAC; prioritize saving it
-			if (minIsPublic && minIsCloser) {
-				return;  // Didn't find any device with random MAC + new device has bigger RSSI
-			}
-		}
-		else {  // Device has a random MAC
-			if (minIsPublic || minIsCloser) {
-				return;
-			}
+	if (_index.Full()) {
+		RemoveStaleDevices();
+	}
+	if (_index.Full()) {
+		const Index replaced = _FindReplaceable(device);
+		if (replaced == Core::LruIndex::Npos) {
+			return;
 		}
-		_devData.erase(min);
+		_RemoveDevice(replaced);
 	}
 
 	// Found some space; create new
-	// Set flags
-	std::uint8_t flags = 0;
-	if (device.IsBle()) {
-		flags |= Core::FlagMask::IsBle;
-		if (device.GetBle().AddrType == BLE_ADDR_TYPE_PUBLIC) {
-			flags |= Core::FlagMask::IsAddrTypePublic;
-		}
-	}
+	_AddDevice(device);
+}
 
-	const std::span<const std::uint8_t, 6> mac(device.Bda.Addr);
-	if (device.IsBle()) {
-		// New BLE device
-		const auto & ble = device.GetBle();
+std::size_t DeviceMemory::SerializeData(std::span<std::uint8_t> out)
+{
+	RemoveStaleDevices();
+
+	const std::size_t size =
+	    Core::Compact::IsCompact(_format) ? _SerializeCompact(out) : _SerializeLegacy(out);
+	ESP_LOGD(TAG, "Serialized %d B; %d devices left to read", size, _index.Size());
+	return size;
+}
 
-		std::span<const std::uint8_t, Bt::BleSpecific::Eir::Size> eir{ble.EirData.Data};
-		_devData.emplace_back(mac, device.GetRssi(), static_cast<Core::FlagMask>(flags),
-		                      ble.EvtType, eir);
+std::size_t DeviceMemory::SeenDevices() const
+{
+	// Expected amount of distinct hashes, which leave this many bits unset
+	const std::size_t unset = std::max<std::size_t>(SeenBits - _seen.count(), 1);
+	return static_cast<std::size_t>(
+	    std::lround(-static_cast<double>(SeenBits) * std::log(double(unset) / SeenBits)));
+}
+
+bool DeviceMemory::SetFormat(std::uint8_t version)
+{
+	if (version != Core::Compact::LegacyVersion && !Core::Compact::IsCompact(version)) {
+		ESP_LOGW(TAG, "Unsupported format %u", version);
+		return false;
 	}
-	else {
-		// New BR/EDR device
-		// const auto & brEdr = device.GetBrEdr();
-		const esp_ble_evt_type_t evt = ESP_BLE_EVT_CONN_ADV;
-		// TODO: Could pass some data?
-		_devData.emplace_back(mac, device.GetRssi(), static_cast<Core::FlagMask>(flags), evt,
-		                      std::span<const std::uint8_t>());
+	_format = version;
+	if (Core::Compact::IsCompact(version)) {
+		_encoder.SetVersion(version);
 	}
+	return true;
 }
 
-void DeviceMemory::SerializeData(std::vector<std::uint8_t> & out)
+void DeviceMemory::Resync(std::uint8_t epoch)
 {
-	RemoveStaleDevices();
-
-	// Read only up to 512B
-	constexpr std::size_t MaxSize = 512;
-	constexpr std::size_t MaxDevices = MaxSize / Core::DeviceDataView::Size;
+	// Requests of older epochs were already handled
+	if (Core::Compact::IsCompact(_format) && epoch == _encoder.Epoch()) {
+		ESP_LOGI(TAG, "Resync of epoch %u", epoch);
+		_encoder.Reset();
+	}
+}
 
-	const std::size_t count = std::min(_devData.size(), MaxDevices);
+std::size_t DeviceMemory::RecordSize() const
+{
+	return Core::Compact::IsCompact(_format)
+	           ? Core::Compact::UpdateSize + Core::Compact::StatsSize(_format)
+	           : Core::DeviceDataView::Size;
+}
+void DeviceMemory::RemoveStaleDevices()
+{
+	// Remove devices not updated for `StaleLimit`; the oldest first
+	const auto now = Core::Clock::now();
+	for (Index idx = _index.Oldest(); idx != Core::LruIndex::Npos; idx = _index.Oldest()) {
+		if (Core::DeltaMs(_devData[idx]->GetLastUpdate(), now) <= _cfg.StaleLimit) {
+			break;
+		}
+		_RemoveDevice(idx);
+	}
+}
 
-	out.clear();
-	out.resize(count * Core::DeviceDataView::Size);
+std::size_t DeviceMemory::_SerializeLegacy(std::span<std::uint8_t> out)
+{
+	const std::size_t count = std::min(_index.Size(), out.size() / Core::DeviceDataView::Size);
 	for (std::size_t i = 0; i < count; i++) {
 		const std::size_t offset = i * Core::DeviceDataView::Size;
 		std::span<std::uint8_t, Core::DeviceDataView::Size> span(out.begin() + offset,
 		                                                         Core::DeviceDataView::Size);
-		_devData.at(i).Serialize(span);
+		// Destructive read; the oldest first
+		const Index idx = _index.Oldest();
+		_devData[idx]->Serialize(span);
+		_RemoveDevice(idx);
+	}
+	return count * Core::DeviceDataView::Size;
+}
+
+std::size_t DeviceMemory::_SerializeCompact(std::span<std::uint8_t> out)
+{
+	// Every payload has to make progress, or the Master would keep missing sequence numbers
+	if (_index.Size() == 0
+	    || out.size() < Core::Compact::HeaderSize + Core::Compact::MaxRecordSize) {
+		return 0;
 	}
-	// Destructive read
-	_devData.erase(_devData.begin(), _devData.begin() + count);
 
-	ESP_LOGI(TAG, "Serialized %d devices; %d left to read", count, _devData.size());
+	std::size_t size = _encoder.Begin(out, Core::ToUnix(Core::Clock::now()));
+	for (Index idx = _index.Oldest(); idx != Core::LruIndex::Npos; idx = _index.Oldest()) {
+		// Destructive read; the oldest first
+		const DeviceInfo & info = *_devData[idx];
+		const std::size_t written =
+		    _encoder.Add(info.GetDeviceData().View, info.Stats(), out.subspan(size));
+		if (written == 0) {
+			break;  // Full
+		}
+		size += written;
+		_RemoveDevice(idx);
+	}
+	return size;
 }
 
-void DeviceMemory::RemoveStaleDevices()
+DeviceMemory::Index DeviceMemory::_FindDevice(std::span<const std::uint8_t, 6> bda) const
 {
-	// Remove devices not updated for `StaleLimit`
-	std::erase_if(_devData,
-	              [limit = _cfg.StaleLimit, now = Core::Clock::now()](const DeviceInfo & dev) {
-		              return Core::DeltaMs(dev.GetLastUpdate(), now) > limit;
-	              });
+	return _macIndex.Find(_MacHash(bda), [&](Index idx) {
+		return std::ranges::equal(bda, _devData[idx]->GetDeviceData().View.Mac());
+	});
 }
 
-bool DeviceMemory::_AssociateDevice(const Bt::Device & device)
+bool DeviceMemory::_AssociateDevice(const ScanRecord & device)
 {
 	if (!_cfg.EnableAssociation) {
 		return false;  // Disabled
 	}
 
 	// Attempt to associate a device with random address to an already existing one
-	if (!device.IsBle()) {
+	if (!device.IsBle) {
 		return false;  // Associate only BLE devices
 	}
 
-	const Bt::BleSpecific & ble = device.GetBle();
-	if (ble.AddrType == esp_ble_addr_type_t::BLE_ADDR_TYPE_PUBLIC) {
+	if (device.AddrType == esp_ble_addr_type_t::BLE_ADDR_TYPE_PUBLIC) {
 		return false;  // Only random address
 	}
 
-	if (ble.AdvDataLen == 0 && ble.ScanRspLen == 0) {
+	if (device.AdvDataLen == 0 && device.ScanRspLen == 0) {
 		return false;  // Can't associate with no adv/scan info
 	}
 
-	for (auto & devInfo : _devData) {
-		const auto & data = devInfo.GetDeviceData();
-		if (data.View.AdvDataSize() == ble.AdvDataLen && data.View.EventType() == ble.EvtType
-		    && std::equal(data.View.AdvData().begin(), data.View.AdvData().end(),
-		                  ble.EirData.Data.begin())) {
-			// Associated with device - delete old device and update new one
-			devInfo.Update(device.Bda.Addr, device.GetRssi());
-			return true;
+	// Stored advertising data is the whole EIR (adv data + scan response)
+	const std::span<const std::uint8_t> eir(device.Eir);
+	const Index idx = _payloadIndex.Find(_PayloadHash(device.EvtType, eir), [&](Index i) {
+		const auto & view = _devData[i]->GetDeviceData().View;
+		return view.EventType() == device.EvtType && std::ranges::equal(view.AdvData(), eir);
+	});
+	if (idx == Core::LruIndex::Npos) {
+		return false;
+	}
+
+	// Associated with device - the device now uses the new address
+	DeviceInfo & info = _devData[idx].value();
+	_macIndex.Erase(_MacHash(info.GetDeviceData().View.Mac()), idx);
+	info.Update(device.Bda.Addr, device.Rssi);
+	_macIndex.Insert(_MacHash(device.Bda.Addr), idx);
+	_index.Touch(idx);
+	return true;
+}
+
+void DeviceMemory::_AddDevice(const ScanRecord & device)
+{
+	const Index idx = _index.Acquire();
+	assert(idx != Core::LruIndex::Npos);
+
+	const std::span<const std::uint8_t, 6> mac(device.Bda.Addr);
+	const auto flags = static_cast<Core::FlagMask>(device.Flags());
+	if (device.IsBle) {
+		// New BLE device
+		_devData[idx].emplace(mac, device.Rssi, flags, device.EvtType, device.Eir);
+	}
+	else {
+		// New BR/EDR device
+		// TODO: Could pass some data?
+		_devData[idx].emplace(mac, device.Rssi, flags, device.EvtType,
+		                      std::span<const std::uint8_t>());
+	}
+
+	const auto & view = _devData[idx]->GetDeviceData().View;
+	_macIndex.Insert(_MacHash(mac), idx);
+	if (_IsAssociable(view)) {
+		_payloadIndex.Insert(_PayloadHash(view.EventType(), view.AdvData()), idx);
+	}
+}
+
+void DeviceMemory::_RemoveDevice(Index idx)
+{
+	const auto & view = _devData[idx]->GetDeviceData().View;
+	_macIndex.Erase(_MacHash(view.Mac()), idx);
+	if (_IsAssociable(view)) {
+		_payloadIndex.Erase(_PayloadHash(view.EventType(), view.AdvData()), idx);
+	}
+	_devData[idx].reset();
+	_index.Release(idx);
+}
+
+DeviceMemory::Index DeviceMemory::_FindReplaceable(const ScanRecord & device) const
+{
+	constexpr std::size_t RssiTolerance = 3;
+
+	// Find a device with the lowest RSSI and random MAC
+	const Index min = *std::min_element(
+	    _index.begin(), _index.end(), [&](const Index value, const Index smallest) {
+		    const auto & vView = _devData[value]->GetDeviceData().View;
+		    const auto & sView = _devData[smallest]->GetDeviceData().View;
+		    if (!sView.IsAddrTypePublic()) {
+			    // 'smallest' has random MAC
+			    if (!vView.IsAddrTypePublic()) {
+				    return vView.Rssi() < sView.Rssi();  // ok - both random - compare
+			    }
+			    return false;  // don't swap smallest with public MAC
+		    }  // else 'smallest' has public MAC and we are only looking for random
+		    if (vView.IsAddrTypePublic()) {
+			    return true;  // random MAC - new smallest
+		    }
+		    return false;
+	    });
+
+	const auto & minView = _devData[min]->GetDeviceData().View;
+	const bool minIsPublic = minView.IsAddrTypePublic();
+	const bool minIsCloser = minView.Rssi() > (device.Rssi - RssiTolerance);
+
+	if (device.IsBlePublic()) {
+		// Device has a public MAC; prioritize saving it
+		if (minIsPublic && minIsCloser) {
+			// Didn't find any device with random MAC + new device has bigger RSSI
+			return Core::LruIndex::Npos;
+		}
+	}
+	else {  // Device has a random MAC
+		if (minIsPublic || minIsCloser) {
+			return Core::LruIndex::Npos;
 		}
 	}
-	return false;
+	return min;
 }
+
+bool DeviceMemory::_IsAssociable(const Core::DeviceDataView & view) const
+{
+	return _cfg.EnableAssociation && view.IsBle() && !view.IsAddrTypePublic();
+}
+
+std::uint32_t DeviceMemory::_MacHash(std::span<const std::uint8_t, 6> bda)
+{
+	return Core::Fnv1a(bda);
+}
+
+std::uint32_t DeviceMemory::_PayloadHash(esp_ble_evt_type_t eventType,
+                                         std::span<const std::uint8_t> advData)
+{
+	const std::uint8_t evt = static_cast<std::uint8_t>(eventType);
+	return Core::Fnv1a(advData, Core::Fnv1a(std::span(&evt, 1)));
+}
+
 }  // namespace Scanner
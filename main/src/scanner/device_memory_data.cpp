@@ -1,6 +1,6 @@
 #include "scanner/device_memory_data.h"
 
-#include <numeric>
+#include <cassert>
 
 namespace Scanner
 {
@@ -21,7 +21,7 @@ void DeviceInfo::Update(std::int8_t rssi)
 {
 	_lastUpdate = Core::Clock::now();
 	_rssi.Add(rssi);
-	_outData.View.Rssi() = _rssi.Average();
+	_outData.View.Rssi() = _rssi.Mean();
 	_outData.View.Timestamp() = Core::ToUnix(_lastUpdate);
 }
 
@@ -48,25 +48,4 @@ const Core::TimePoint & DeviceInfo::GetLastUpdate() const
 	return _lastUpdate;
 }
 
-DeviceInfo::AverageWindow::AverageWindow(std::int8_t rssi)
-{
-	std::fill(Window.begin(), Window.end(), rssi);
-}
-
-void DeviceInfo::AverageWindow::Add(std::int8_t value)
-{
-	Window[Idx] = value;
-	Idx = _NextIdx(Idx);
-}
-
-std::int8_t DeviceInfo::AverageWindow::Average() const
-{
-	return std::accumulate(Window.begin(), Window.end(), static_cast<std::int16_t>(0)) / Size;
-}
-
-std::uint8_t DeviceInfo::AverageWindow::_NextIdx(std::uint8_t idx)
-{
-	return ((idx + 1) == Size) ? 0 : (idx + 1);
-}
-
 }  // namespace Scanner
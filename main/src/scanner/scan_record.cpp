@@ -0,0 +1,46 @@
+#include "scanner/scan_record.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace Scanner
+{
+
+ScanRecord ScanRecord::From(const Bt::ScanResultView & view)
+{
+	ScanRecord record;
+	record.Bda = Mac(view.Bda());
+	record.Rssi = view.Rssi().value_or(std::numeric_limits<std::int8_t>::min());
+	record.IsBle = view.IsBle();
+	if (view.IsBle()) {
+		const Gap::Ble::ScanResult & sr = view.Ble();
+		record.AddrType = sr.ble_addr_type;
+		record.EvtType = sr.ble_evt_type;
+		record.AdvDataLen = sr.adv_data_len;
+		record.ScanRspLen = sr.scan_rsp_len;
+		std::copy_n(sr.ble_adv, EirSize, record.Eir.begin());
+	}
+	else {
+		// Only the RSSI is used
+		record.AddrType = BLE_ADDR_TYPE_PUBLIC;
+		record.EvtType = ESP_BLE_EVT_CONN_ADV;
+		record.AdvDataLen = 0;
+		record.ScanRspLen = 0;
+		record.Eir.fill(0);
+	}
+	return record;
+}
+
+std::uint8_t ScanRecord::Flags() const
+{
+	std::uint8_t flags = 0;
+	if (IsBle) {
+		flags |= Core::FlagMask::IsBle;
+		if (AddrType == BLE_ADDR_TYPE_PUBLIC) {
+			flags |= Core::FlagMask::IsAddrTypePublic;
+		}
+	}
+	return flags;
+}
+
+}  // namespace Scanner
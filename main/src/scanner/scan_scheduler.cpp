@@ -0,0 +1,113 @@
+#include "scanner/scan_scheduler.h"
+
+#include <esp_log.h>
+
+#include <algorithm>
+
+namespace
+{
+/// @brief Logger tag
+static const char * TAG = "ScanSched";
+}  // namespace
+
+namespace Scanner
+{
+
+ScanScheduler::ScanScheduler(const AppConfig & cfg)
+    : _cfg(cfg)
+{
+	const unsigned cycle = _cfg.ScanModePeriodBle + _cfg.ScanModePeriodClassic;
+	_adaptive.BleShare = static_cast<std::uint8_t>(_cfg.ScanModePeriodBle * 100 / cycle);
+}
+
+bool ScanScheduler::Update(const Observation & obs)
+{
+	const AppConfig::ScanScheduleConfig & cfg = _cfg.ScheduleCfg;
+	if (!cfg.Adaptive) {
+		return false;
+	}
+	const Core::ScanSchedule previous = _adaptive;
+
+	// Results per device and second of BLE scanning
+	const float rate = (obs.Devices > 0 && obs.BleTime > 0)
+	                       ? obs.BleResults * 1000.0f / obs.BleTime / obs.Devices
+	                       : 0.0f;
+	int duty = _adaptive.Window * 100 / _adaptive.Interval;
+	if (obs.Drops > 0) {
+		// The worker task can't keep up; free the radio
+		duty = duty * 3 / 4;
+	}
+	else if (obs.Devices == 0) {
+		// Nothing seen yet; keep scanning as much, so devices can show up
+	}
+	else if (rate < cfg.TargetRate) {
+		duty = duty * 5 / 4 + 1;
+	}
+	else if (rate > 2 * cfg.TargetRate) {
+		duty = duty * 4 / 5;
+	}
+	duty = std::clamp<int>(duty, cfg.MinDuty, 100);
+
+	// More devices - shorter interval, so all advertising channels are visited sooner
+	const std::size_t limit = _cfg.DeviceMemoryCfg.MemorySizeLimit;
+	const std::size_t devices = std::min(obs.Devices, limit);
+	_adaptive.Interval = static_cast<std::uint16_t>(
+	    cfg.MaxInterval - (cfg.MaxInterval - cfg.MinInterval) * devices / limit);
+	_adaptive.Window = static_cast<std::uint16_t>(std::max<int>(
+	    Core::ScanSchedule::MinInterval, _adaptive.Interval * duty / 100));
+
+	// BLE/Classic split follows the result rate of each (per second, so a larger share
+	// doesn't feed itself)
+	if (_cfg.Mode == ScanMode::Both && obs.BleTime > 0 && obs.ClassicTime > 0) {
+		const float bleRate = obs.BleResults * 1000.0f / obs.BleTime;
+		const float classicRate = obs.ClassicResults * 1000.0f / obs.ClassicTime;
+		if (bleRate + classicRate > 0.0f) {
+			const int share = static_cast<int>(100 * bleRate / (bleRate + classicRate));
+			const int smoothed = (_adaptive.BleShare + share) / 2;
+			_adaptive.BleShare = static_cast<std::uint8_t>(
+			    std::clamp<int>(smoothed, cfg.MinShare, 100 - cfg.MinShare));
+		}
+	}
+
+	if (_adaptive == previous || _override.has_value()) {
+		return false;
+	}
+	ESP_LOGI(TAG, "Window %u ms / interval %u ms, BLE %u%% (%d devices, %.1f results/s each)",
+	         _adaptive.Window, _adaptive.Interval, _adaptive.BleShare, obs.Devices, rate);
+	return true;
+}
+
+void ScanScheduler::Override(const Core::ScanSchedule & schedule)
+{
+	if (schedule.Source == Core::ScanSchedule::Mode::Fixed) {
+		_override = schedule;
+		ESP_LOGI(TAG, "Overridden: window %u ms / interval %u ms, BLE %u%%", schedule.Window,
+		         schedule.Interval, schedule.BleShare);
+	}
+	else if (_override.has_value()) {
+		_override.reset();
+		ESP_LOGI(TAG, "Adaptive");
+	}
+}
+
+const Core::ScanSchedule & ScanScheduler::Current() const
+{
+	return _override.has_value() ? *_override : _adaptive;
+}
+
+float ScanScheduler::BlePeriod() const
+{
+	if (_cfg.Mode != ScanMode::Both) {
+		return _cfg.ScheduleCfg.Period;
+	}
+	const float cycle = _cfg.ScanModePeriodBle + _cfg.ScanModePeriodClassic;
+	return std::max(1.0f, cycle * Current().BleShare / 100);
+}
+
+float ScanScheduler::ClassicPeriod() const
+{
+	const float cycle = _cfg.ScanModePeriodBle + _cfg.ScanModePeriodClassic;
+	return std::max(1.0f, cycle - BlePeriod());
+}
+
+}  // namespace Scanner
@@ -1,8 +1,8 @@
 #include "scanner/scanner_impl.h"
 
 #include "core/bt_common.h"
+#include "core/task.h"
 #include "core/wrapper/advertisement_data.h"
-#include "core/wrapper/device.h"
 
 #include <esp_gatt_common_api.h>
 #include <esp_log.h>
@@ -20,6 +20,30 @@ static const char * TAG = "Scanner";
 
 constexpr TickType_t BlockTimeInCallbacks = pdMS_TO_TICKS(500);
 
+/// @brief Maximum 'Devices' value read by the Master. Attributes are limited to 512 octets.
+constexpr std::size_t DevicesReadLimit = std::min(
+    512u, ((ESP_GATT_MAX_MTU_SIZE - 1) / Core::DeviceDataView::Size) * Core::DeviceDataView::Size);
+
+/// @brief Whether a scan result is another Scanner (advertises the Scanner service)
+static bool IsScanner(const Bt::ScanResultView & view)
+{
+	const auto record = view.Eir().Find(esp_ble_adv_data_type::ESP_BLE_AD_TYPE_128SRV_CMPL);
+	return record.has_value() && std::ranges::equal(record->Data, Gatt::ScannerServiceArray);
+}
+
+static void WorkerTask(void * pvParameters)
+{
+	reinterpret_cast<Scanner::Impl::App *>(pvParameters)->WorkerLoop();
+}
+
+static void ExpiryTimerCallback(TimerHandle_t xTimer)
+{
+	configASSERT(xTimer);
+
+	auto * app = reinterpret_cast<Scanner::Impl::App *>(pvTimerGetTimerID(xTimer));
+	app->ExpireDevices();
+}
+
 }  // namespace
 
 namespace Scanner::Impl
@@ -30,6 +54,8 @@ App::App(const AppConfig & cfg)
     , _bleGap(this)
     , _btGap(this)
     , _memory(_cfg.DeviceMemoryCfg)
+    , _scanQueue(_cfg.ScanQueueDepth)
+    , _scheduler(_cfg)
 {
 	_serializeVec.reserve(512);
 }
@@ -43,17 +69,13 @@ void App::Init()
 	_memMutex = xSemaphoreCreateMutex();
 	assert(_memMutex != nullptr);
 
-	// BLE
+	// Task owning the memory; has to exist before the first scan result
+	const bool created =
+	    Core::CreateTask(WorkerTask, "Scanner worker", _cfg.WorkerTaskCfg, this, &_workerTask);
+	assert(created);
+
+	// BLE; scan parameters are set before every scan period (@ref ScanScheduler)
 	_bleGap.Init();
-	esp_ble_scan_params_t scanParams{
-	    .scan_type = esp_ble_scan_type_t::BLE_SCAN_TYPE_PASSIVE,
-	    .own_addr_type = esp_ble_addr_type_t::BLE_ADDR_TYPE_PUBLIC,
-	    .scan_filter_policy = esp_ble_scan_filter_t::BLE_SCAN_FILTER_ALLOW_ALL,
-	    .scan_interval = Gap::Ble::ConvertScanInterval(1.0),
-	    .scan_window = Gap::Ble::ConvertScanInterval(0.6),
-	    .scan_duplicate = esp_ble_scan_duplicate_t::BLE_SCAN_DUPLICATE_DISABLE,
-	};
-	_bleGap.SetScanParams(&scanParams);
 	std::vector<std::uint8_t> advData =
 	    Ble::AdvertisementDataBuilder::Builder().SetCompleteUuid128(Gatt::ScannerService).Finish();
 	_bleGap.SetRawAdvertisingData(advData);
@@ -65,6 +87,14 @@ void App::Init()
 		                   Gap::Bt::DiscoveryMode::ESP_BT_NON_DISCOVERABLE);
 	}
 
+	// Periodic removal of stale devices (timers are available after GAP init)
+	_expiryTimerHandle =
+	    xTimerCreateStatic("Expiry Timer", pdMS_TO_TICKS(_cfg.DeviceMemoryCfg.ExpiryInterval),
+	                       pdTRUE, this, ExpiryTimerCallback, &_expiryTimerBuffer);
+	if (_expiryTimerHandle == nullptr || xTimerStart(_expiryTimerHandle, 0) != pdPASS) {
+		ESP_LOGE(TAG, "Failed starting expiry timer");
+	}
+
 	// GATTs
 	_gatts.RegisterApp(ScannerAppId, this);
 	_gatts.SetLocalMtu(std::numeric_limits<std::uint16_t>::max());
@@ -83,13 +113,7 @@ void App::GapBleScanResult(const Gap::Ble::ScanResult & p)
 		return;
 	}
 	// Scan result - Found a device
-	const Bt::Device dev(p);
-	ESP_LOGD(TAG, "%s", ToString(dev).c_str());
-
-	if (xSemaphoreTake(_memMutex, BlockTimeInCallbacks)) {
-		_memory.AddDevice(dev);
-		xSemaphoreGive(_memMutex);
-	}
+	_Enqueue(Bt::ScanResultView(p));
 }
 
 void App::GapBleAdvStopCmpl(const Gap::Ble::Type::AdvStopCmpl & p)
@@ -113,13 +137,7 @@ void App::GapBtDiscRes(const Gap::Bt::DiscRes & p)
 		return;
 	}
 
-	const Bt::Device dev(p);
-	ESP_LOGD(TAG, "%s", ToString(dev).c_str());
-
-	if (xSemaphoreTake(_memMutex, BlockTimeInCallbacks)) {
-		_memory.AddDevice(dev);
-		xSemaphoreGive(_memMutex);
-	}
+	_Enqueue(Bt::ScanResultView(p));
 }
 
 void App::GapBtDiscStateChanged(const Gap::Bt::DiscStateChanged & p)
@@ -148,6 +166,8 @@ void App::GattsConnect(const Gatts::Type::Connect & p)
 	}
 	else {
 		_connStatus = ConnectionStatus::Connected;
+		_connId = p.conn_id;
+		_mtu.store(ESP_GATT_DEF_BLE_MTU_SIZE, std::memory_order_relaxed);
 		_bleGap.StopAdvertising();
 	}
 }
@@ -158,8 +178,28 @@ void App::GattsDisconnect(const Gatts::Type::Disconnect & p)
 	// Disconnected, restart advertising
 	_connStatus = ConnectionStatus::Disconnected;
 	_state = Gatt::StateChar::Advertise;
+
+	// The next Master has to choose the format again; applied by the worker (notified below)
+	_requestedFormat.store(Core::Compact::LegacyVersion, std::memory_order_relaxed);
+	_requestedResync.store(-1, std::memory_order_relaxed);
+	_serializeVec.clear();
+	_framedReads = false;
+	_batch.Clear();
+
+	// Stop streaming; the next Master has to subscribe again
+	_subscription.store(0, std::memory_order_release);
+	_congested.store(false, std::memory_order_relaxed);
+	_awaitingConf.store(false, std::memory_order_relaxed);
+	std::uint8_t cccd[2] = {0, 0};
+	esp_ble_gatts_set_attr_value(_appInfo->GattHandles[Handle::DevicesCccd], sizeof(cccd), cccd);
+	xTaskNotifyGive(_workerTask);
+
 	_bleGap.StopScanning();
 	_btGap.StopDiscovery();
+	_EndScanPeriod();
+	_scheduler.Override(Core::ScanSchedule{});  // Overrides are per connection
+	_filter.Clear();
+	esp_ble_gatts_set_attr_value(_appInfo->GattHandles[Handle::Filter], 0, nullptr);
 	_AdvertiseDefault();
 }
 
@@ -169,42 +209,31 @@ void App::GattsRead(const Gatts::Type::Read & p)
 		return;
 	}
 	// Manually respond to Devices GATT READ - reading is destructive.
-
-	// Attributes are limited to 512 octets.
-	constexpr std::size_t SizeLimit =
-	    std::min(512u, ((ESP_GATT_MAX_MTU_SIZE - 1) / Core::DeviceDataView::Size)
-	                       * Core::DeviceDataView::Size);
 	esp_gatt_rsp_t rsp{};
 	rsp.attr_value.handle = p.handle;
 	rsp.attr_value.auth_req = ESP_GATT_AUTH_REQ_NONE;
 	rsp.attr_value.offset = p.offset;
 
-	if (p.offset != 0) {
-		// Don't update; send the rest of the data
-		if (p.offset < _serializeVec.size()) {
-			const std::size_t bToSend = SizeLimit - p.offset;
-			const std::size_t size = std::min(bToSend, _serializeVec.size() - bToSend);
-			std::copy(_serializeVec.begin() + p.offset, _serializeVec.begin() + size,
-			          rsp.attr_value.value);
-			rsp.attr_value.len = size;
-		}  // else no data
-		esp_ble_gatts_send_response(_appInfo->GattIf, p.conn_id, p.trans_id, ESP_GATT_OK, &rsp);
-		return;
-	}
-
-	// Update
-	_CheckAndUpdateDevicesData();
-
-	if ((_serializeVec.size() == 0) && p.need_rsp) {
-		// No data after update
-		esp_ble_gatts_send_response(_appInfo->GattIf, p.conn_id, p.trans_id, ESP_GATT_OK, &rsp);
-		return;
+	if (p.offset == 0) {
+		// A new value; the rest of a long value is read with increasing offsets
+		if (!_framedReads) {
+			_CheckAndUpdateDevicesData();
+		}
+		else {
+			if (!_batch.Pending()) {
+				_CheckAndUpdateDevicesData();
+			}
+			_batch.NextFrame(_serializeVec);  // Until the Master acknowledges the batch
+		}
 	}
 
-	// Build a response
-	const std::size_t size = std::min(SizeLimit, _serializeVec.size());
-	std::copy_n(_serializeVec.data(), size, rsp.attr_value.value);
-	rsp.attr_value.len = size;
+	// The stack trims the response to the MTU
+	if (p.offset < _serializeVec.size()) {
+		const std::size_t size =
+		    std::min(sizeof(rsp.attr_value.value), _serializeVec.size() - p.offset);
+		std::copy_n(_serializeVec.begin() + p.offset, size, rsp.attr_value.value);
+		rsp.attr_value.len = size;
+	}  // else no data
 	esp_ble_gatts_send_response(_appInfo->GattIf, p.conn_id, p.trans_id, ESP_GATT_OK, &rsp);
 }
 
@@ -233,6 +262,265 @@ void App::GattsWrite(const Gatts::Type::Write & p)
 		tm.tv_sec = value;
 		settimeofday(&tm, nullptr);
 	}
+	else if (p.handle == _appInfo->GattHandles[Handle::DevicesCccd]) {
+		if (p.len != 2) {
+			ESP_LOGI(TAG, "Invalid client configuration length (%d)", p.len);
+			return;
+		}
+		const std::uint16_t value = p.value[0] | (p.value[1] << 8);
+		ESP_LOGI(TAG, "Devices client configuration 0x%04x", value);
+		_subscription.store(value & (Gatt::ClientConfigBits::Notify
+		                             | Gatt::ClientConfigBits::Indicate),
+		                    std::memory_order_release);
+		xTaskNotifyGive(_workerTask);  // Recalculate the wait
+	}
+	else if (p.handle == _appInfo->GattHandles[Handle::Devices]) {
+		const bool valid = _DevicesControl(std::span<const std::uint8_t>(p.value, p.len));
+		if (p.need_rsp) {
+			// Responded by the app
+			esp_gatt_rsp_t rsp{};
+			rsp.attr_value.handle = p.handle;
+			esp_ble_gatts_send_response(_appInfo->GattIf, p.conn_id, p.trans_id,
+			                            valid ? ESP_GATT_OK : ESP_GATT_REQ_NOT_SUPPORTED, &rsp);
+		}
+	}
+	else if (p.handle == _appInfo->GattHandles[Handle::Scan]) {
+		// Applied with the next BLE scan period
+		const auto schedule =
+		    Core::ScanSchedule::Parse(std::span<const std::uint8_t>(p.value, p.len));
+		if (schedule.has_value()) {
+			_scheduler.Override(*schedule);
+		}
+		else {
+			ESP_LOGW(TAG, "Invalid scan schedule (length %d)", p.len);
+		}
+		_PublishSchedule();
+	}
+	else if (p.handle == _appInfo->GattHandles[Handle::Filter]) {
+		// Invalid rules are rejected by keeping the previous ones
+		const std::span<const std::uint8_t> data(p.value, p.len);
+		if (_filter.Set(data)) {
+			ESP_LOGI(TAG, "Filtering by %d rules", _filter.Count());
+		}
+		else {
+			ESP_LOGW(TAG, "Invalid filter rules (length %d)", p.len);
+			esp_ble_gatts_set_attr_value(p.handle, _filter.Data().size(), _filter.Data().data());
+		}
+	}
+}
+
+void App::GattsMtu(const Gatts::Type::Mtu & p)
+{
+	ESP_LOGI(TAG, "MTU %d", p.mtu);
+	_mtu.store(p.mtu, std::memory_order_relaxed);
+	xTaskNotifyGive(_workerTask);  // Recalculate the wait
+}
+
+void App::GattsConf(const Gatts::Type::Conf & p)
+{
+	// Sent notification/confirmed indication
+	if (p.status != ESP_GATT_OK) {
+		ESP_LOGW(TAG, "Devices indication not confirmed (%d)", p.status);
+	}
+	if (_awaitingConf.exchange(false, std::memory_order_relaxed)) {
+		xTaskNotifyGive(_workerTask);  // Send the rest
+	}
+}
+
+void App::GattsCongest(const Gatts::Type::Congest & p)
+{
+	_congested.store(p.congested, std::memory_order_relaxed);
+	if (!p.congested) {
+		xTaskNotifyGive(_workerTask);  // Send the rest
+	}
+}
+
+void App::ExpireDevices()
+{
+	// Runs in the timer task - don't block it; the worker does the work
+	_expireRequested.store(true, std::memory_order_relaxed);
+	xTaskNotifyGive(_workerTask);
+}
+
+void App::WorkerLoop()
+{
+	for (;;) {
+		ulTaskNotifyTake(pdTRUE, _StreamWait());
+
+		if (xSemaphoreTake(_memMutex, portMAX_DELAY)) {
+			_ApplyDevicesRequests();
+			if (_seenResetRequested.exchange(false, std::memory_order_relaxed)) {
+				_memory.ResetSeen();
+			}
+			// Only the records queued so far; don't keep GATT reads waiting
+			for (std::size_t n = _scanQueue.Size(); n > 0; n--) {
+				_memory.AddDevice(*_scanQueue.Front());
+				_scanQueue.Pop();
+			}
+			if (_expireRequested.exchange(false, std::memory_order_relaxed)) {
+				_memory.RemoveStaleDevices();
+				_ReportDrops();
+			}
+			_StreamDevices();
+			_seenDevices.store(_memory.SeenDevices(), std::memory_order_relaxed);
+			xSemaphoreGive(_memMutex);
+		}
+		if (_scanQueue.Size() > 0) {
+			xTaskNotifyGive(_workerTask);  // Some are left
+		}
+	}
+}
+
+void App::_Enqueue(const Bt::ScanResultView & view)
+{
+	// Filter before copying; most weak results would be discarded by the memory anyway
+	const std::optional<std::int8_t> rssi = view.Rssi();
+	if (!rssi.has_value() || rssi.value() < _cfg.DeviceMemoryCfg.MinRssi) {
+		return;
+	}
+	// Other Scanners are needed for the Scanner positions
+	if (!_filter.Matches(view) && !IsScanner(view)) {
+		return;
+	}
+	if (view.IsBle()) {
+		_observed.BleResults++;
+	}
+	else {
+		_observed.ClassicResults++;
+	}
+	if (_scanQueue.Push(ScanRecord::From(view))) {
+		xTaskNotifyGive(_workerTask);
+	}
+}
+
+void App::_ReportDrops()
+{
+	const std::uint32_t drops = _scanQueue.Overflows();
+	if (drops != _reportedDrops) {
+		ESP_LOGW(TAG, "Dropped %lu scan results (total %lu); queue max %d/%d",
+		         drops - _reportedDrops, drops, _scanQueue.HighWatermark(),
+		         _scanQueue.Capacity());
+		_reportedDrops = drops;
+	}
+}
+
+void App::_StreamDevices()
+{
+	const std::uint16_t subscription = _subscription.load(std::memory_order_acquire);
+	if (subscription == 0) {
+		_streamSeq = 0;  // Starts again with the next subscription
+		return;
+	}
+
+	const std::size_t capacity = _StreamCapacity();
+	const auto now = Core::Clock::now();
+	if (capacity == 0
+	    || (Core::DeltaMs(_lastStream, now) < _cfg.StreamInterval
+	        && _memory.Size() * _memory.RecordSize() < capacity)) {
+		return;
+	}
+	_lastStream = now;
+
+	// Indications are confirmed one by one; notifications are sent until the stack is congested
+	const bool indicate = (subscription & Gatt::ClientConfigBits::Indicate) != 0;
+	_streamVec.resize(Gatt::DevicesStreamHeaderSize + capacity);
+	while (!_congested.load(std::memory_order_relaxed)
+	       && !_awaitingConf.load(std::memory_order_relaxed)) {
+		const std::size_t size =
+		    _memory.SerializeData(std::span(_streamVec).subspan(Gatt::DevicesStreamHeaderSize));
+		if (size == 0) {
+			break;
+		}
+		_streamVec[0] = _streamSeq & 0xFF;
+		_streamVec[1] = _streamSeq >> 8;
+		_streamSeq++;  // Even if sending fails, so the Master notices the lost records
+
+		_awaitingConf.store(indicate, std::memory_order_relaxed);
+		const esp_err_t err = esp_ble_gatts_send_indicate(
+		    _appInfo->GattIf, _connId, _appInfo->GattHandles[Handle::Devices],
+		    Gatt::DevicesStreamHeaderSize + size, _streamVec.data(), indicate);
+		if (err != ESP_OK) {
+			ESP_LOGW(TAG, "Couldn't send devices (%d)", err);
+			_awaitingConf.store(false, std::memory_order_relaxed);
+			break;
+		}
+	}
+}
+
+TickType_t App::_StreamWait() const
+{
+	// Woken up when any of these change
+	if (_subscription.load(std::memory_order_relaxed) == 0 || _StreamCapacity() == 0
+	    || _congested.load(std::memory_order_relaxed)
+	    || _awaitingConf.load(std::memory_order_relaxed)) {
+		return portMAX_DELAY;
+	}
+	const auto elapsed = Core::DeltaMs(_lastStream, Core::Clock::now());
+	return elapsed >= _cfg.StreamInterval ? 0 : pdMS_TO_TICKS(_cfg.StreamInterval - elapsed);
+}
+
+std::size_t App::_StreamCapacity() const
+{
+	// ATT_MTU - 3 (opcode + handle)
+	const std::size_t mtu = _mtu.load(std::memory_order_relaxed);
+	if (mtu < Gatt::DevicesStreamMinMtu) {
+		return 0;
+	}
+	return mtu - 3 - Gatt::DevicesStreamHeaderSize;
+}
+
+bool App::_DevicesControl(std::span<const std::uint8_t> data)
+{
+	if (data.size() != 2) {
+		ESP_LOGW(TAG, "Invalid devices command length (%d)", data.size());
+		return false;
+	}
+	// The memory is only changed by the worker/GATT reads (with the mutex held); the rest
+	// is only used by the GATTS callbacks
+	bool valid = true;
+	switch (data[0]) {
+	case Gatt::DevicesControl::SetFormat:
+		valid = data[1] == Core::Compact::LegacyVersion || Core::Compact::IsCompact(data[1]);
+		if (valid) {
+			_requestedFormat.store(data[1], std::memory_order_relaxed);
+			_requestedResync.store(-1, std::memory_order_relaxed);
+			_serializeVec.clear();  // Cached in the previous format/epoch
+			_batch.Clear();
+			_framedReads = true;
+			ESP_LOGI(TAG, "Devices format %u", data[1]);
+		}
+		else {
+			ESP_LOGW(TAG, "Unsupported format %u", data[1]);
+		}
+		break;
+	case Gatt::DevicesControl::Resync:
+		_requestedResync.store(data[1], std::memory_order_relaxed);
+		break;
+	case Gatt::DevicesControl::Ack:
+		if (!_batch.Ack(data[1])) {
+			ESP_LOGD(TAG, "Ack of unknown batch %u", data[1]);
+		}
+		break;
+	default:
+		ESP_LOGW(TAG, "Unknown devices command %u", data[0]);
+		valid = false;
+		break;
+	}
+	xTaskNotifyGive(_workerTask);
+	return valid;
+}
+
+void App::_ApplyDevicesRequests()
+{
+	// Format first - it starts a new epoch, so an older resync doesn't apply anymore
+	if (const std::int16_t format = _requestedFormat.exchange(-1, std::memory_order_relaxed);
+	    format >= 0) {
+		_memory.SetFormat(static_cast<std::uint8_t>(format));
+	}
+	if (const std::int16_t epoch = _requestedResync.exchange(-1, std::memory_order_relaxed);
+	    epoch >= 0) {
+		_memory.Resync(static_cast<std::uint8_t>(epoch));
+	}
 }
 
 void App::_ChangeState(const Gatt::StateChar state)
@@ -244,10 +532,12 @@ void App::_ChangeState(const Gatt::StateChar state)
 		_bleGap.StopAdvertising();
 		_bleGap.StopScanning();
 		_btGap.StopDiscovery();
+		_EndScanPeriod();
 		break;
 	case Gatt::StateChar::Advertise:
 		_bleGap.StopScanning();
 		_btGap.StopDiscovery();
+		_EndScanPeriod();
 		_AdvertiseToBeacons();
 		break;
 	case Gatt::StateChar::Scan:
@@ -292,30 +582,75 @@ void App::_AdvertiseToBeacons()
 
 void App::_ScanForDevices()
 {
-	// Scan forever
-	if (_cfg.Mode == ScanMode::Both) {
-		static bool swap = false;
-		if (!swap) {
-			const float time = static_cast<float>(_cfg.ScanModePeriodBle);
-			_bleGap.StartScanning(time);
-			ESP_LOGI(TAG, "Scanning for devices (BLE)");
-		}
-		else {
-			const float time = static_cast<float>(_cfg.ScanModePeriodClassic);
-			_btGap.StartDiscovery(Gap::Bt::InquiryMode::ESP_BT_INQ_MODE_GENERAL_INQUIRY, time);
-			ESP_LOGI(TAG, "Scanning for devices (Classic)");
-		}
-		swap = !swap;
-	}
-	else if (_cfg.Mode == ScanMode::ClassicOnly) {
+	// Restarted after every period
+	_EndScanPeriod();
+	if (_cfg.Mode == ScanMode::ClassicOnly) {
 		_btGap.StartDiscovery(Gap::Bt::InquiryMode::ESP_BT_INQ_MODE_GENERAL_INQUIRY,
 		                      Gap::Bt::DiscoverForever);
 		ESP_LOGI(TAG, "Scanning for devices (Classic)");
+		return;
+	}
+
+	if (_cfg.Mode == ScanMode::Both && !_bleTurn) {
+		_btGap.StartDiscovery(Gap::Bt::InquiryMode::ESP_BT_INQ_MODE_GENERAL_INQUIRY,
+		                      _scheduler.ClassicPeriod());
+		_scanningBle = false;
+		ESP_LOGI(TAG, "Scanning for devices (Classic)");
 	}
 	else {
-		_bleGap.StartScanning(Gap::Ble::ScanForever);
-		ESP_LOGI(TAG, "Scanning for devices (BLE)");
+		_UpdateSchedule();
+		_bleGap.StartScanning(_scheduler.BlePeriod());
+		_scanningBle = true;
+		ESP_LOGD(TAG, "Scanning for devices (BLE)");
+	}
+	_scanStart = Core::Clock::now();
+	_bleTurn = _cfg.Mode != ScanMode::Both || !_bleTurn;
+}
+
+void App::_EndScanPeriod()
+{
+	if (!_scanningBle.has_value()) {
+		return;
 	}
+	const auto elapsed = static_cast<std::uint32_t>(Core::DeltaMs(_scanStart, Core::Clock::now()));
+	(*_scanningBle ? _observed.BleTime : _observed.ClassicTime) += elapsed;
+	_scanningBle.reset();
+}
+
+void App::_UpdateSchedule()
+{
+	const std::uint32_t drops = _scanQueue.Overflows();
+	// Stored devices can't be used - streamed/read devices are removed from the memory
+	_observed.Devices = _seenDevices.exchange(0, std::memory_order_relaxed);
+	_seenResetRequested.store(true, std::memory_order_relaxed);
+	xTaskNotifyGive(_workerTask);
+	_observed.Drops = drops - _scheduledDrops;
+	_scheduler.Update(_observed);
+	_scheduledDrops = drops;
+	_observed = {};
+	_ApplySchedule();
+}
+
+void App::_ApplySchedule()
+{
+	const Core::ScanSchedule & schedule = _scheduler.Current();
+	esp_ble_scan_params_t scanParams{
+	    .scan_type = esp_ble_scan_type_t::BLE_SCAN_TYPE_PASSIVE,
+	    .own_addr_type = esp_ble_addr_type_t::BLE_ADDR_TYPE_PUBLIC,
+	    .scan_filter_policy = esp_ble_scan_filter_t::BLE_SCAN_FILTER_ALLOW_ALL,
+	    .scan_interval = Gap::Ble::ConvertScanInterval(schedule.Interval / 1000.0f),
+	    .scan_window = Gap::Ble::ConvertScanInterval(schedule.Window / 1000.0f),
+	    .scan_duplicate = esp_ble_scan_duplicate_t::BLE_SCAN_DUPLICATE_DISABLE,
+	};
+	_bleGap.SetScanParams(&scanParams);
+	_PublishSchedule();
+}
+
+void App::_PublishSchedule()
+{
+	std::uint8_t value[Core::ScanSchedule::Size];
+	_scheduler.Current().Serialize(value);
+	esp_ble_gatts_set_attr_value(_appInfo->GattHandles[Handle::Scan], sizeof(value), value);
 }
 
 void App::_CheckAndUpdateDevicesData()
@@ -331,7 +666,16 @@ void App::_CheckAndUpdateDevicesData()
 void App::_UpdateDevicesData()
 {
 	if (xSemaphoreTake(_memMutex, BlockTimeInCallbacks)) {
-		_memory.SerializeData(_serializeVec);
+		_ApplyDevicesRequests();  // The Master may read before the worker gets to them
+		if (_framedReads) {
+			// Kept until the Master acknowledges it
+			_batch.Commit(_memory.SerializeData(_batch.Prepare(_cfg.ReadBatchSize)));
+		}
+		else {
+			// A compact payload has to be read whole
+			_serializeVec.resize(DevicesReadLimit);
+			_serializeVec.resize(_memory.SerializeData(std::span(_serializeVec)));
+		}
 		xSemaphoreGive(_memMutex);
 	}
 }
@@ -69,7 +69,7 @@ def parse_response(response_data: bytes) -> MasterData:
     scanner_list: list[Mac] = []
     measurement_list: list[MeasurementData] = []
 
-    if len(response_data) < 6:
+    if len(response_data) < 7:
         print(f"Incorrect response from Master ({response_data})")
         return MasterData(0, [], [])
 
@@ -77,10 +77,10 @@ def parse_response(response_data: bytes) -> MasterData:
     # Timestamp from when the data was sent - we can (circa) find the real timestamps of measurements with this
     ref_timestamp = int.from_bytes(response_data[0:4], byteorder="little")
     scanner_count = response_data[4]
-    measurement_count = response_data[5]
+    measurement_count = int.from_bytes(response_data[5:7], byteorder="little")
 
     try:
-        offset = 6
+        offset = 7
         # Scanners
         for _ in range(0, scanner_count):
             scanner_list.append(Mac([ int(i) for i in response_data[offset:offset + 6] ]))